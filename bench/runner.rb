@@ -0,0 +1,244 @@
+# -----------------------------------------------------------------------------
+# 
+# Benchmark runner
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+
+require 'rgeo'
+
+
+module RGeo
+  
+  # Benchmarks for the RGeo implementations. Run them with
+  # <tt>rake bench</tt>, or with <tt>ruby -Ilib bench/runner.rb</tt>.
+  # 
+  # Each workload is run against each available factory at each data
+  # size. The following environment variables control a run:
+  # 
+  # [<tt>BENCH_SIZES</tt>]
+  #   Comma-separated numbers of vertices in the test geometries.
+  #   Default is "10,100,1000".
+  # [<tt>BENCH_TIME</tt>]
+  #   Minimum number of seconds to run each measurement. Default is 0.5.
+  # [<tt>BENCH_FACTORIES</tt>]
+  #   Comma-separated factory names to run. Default is all available.
+  # [<tt>BENCH_WORKLOADS</tt>]
+  #   Comma-separated workload names to run. Default is all.
+  # [<tt>BENCH_FORMAT</tt>]
+  #   The output format: "text" (the default) for an aligned table,
+  #   "tsv" for tab-separated values with a header line, or "json" for
+  #   one JSON object per line.
+  # 
+  # Each result reports the factory, workload, size, iterations,
+  # operations per second, and objects allocated per operation. The
+  # allocation count is empty on rubies that do not report it.
+  
+  module Bench  # :nodoc:
+    
+    
+    @workloads = []
+    
+    
+    class << self
+      
+      
+      # Registers a workload. The setup block is called with a factory
+      # and a size, and returns the state passed to the run block on
+      # each iteration. Either block may raise
+      # Error::UnsupportedOperation (or return nil from setup) to skip
+      # the factory.
+      
+      def workload(name_, setup_, &run_)
+        @workloads << [name_.to_s, setup_, run_]
+      end
+      
+      
+      def workloads
+        @workloads
+      end
+      
+      
+      # Returns a hash of the factories to benchmark, by name. Factories
+      # that are not available in this installation are omitted.
+      
+      def factories
+        result_ = {}
+        if Geos.supported?
+          result_['geos'] = Geos.factory
+          result_['geos_zm'] = Geos.factory(:has_z_coordinate => true, :has_m_coordinate => true)
+        end
+        result_['simple_cartesian'] = Cartesian.simple_factory
+        result_['spherical'] = Geographic.spherical_factory
+        result_['simple_mercator'] = Geographic.simple_mercator_factory
+        if CoordSys::Proj4.supported?
+          result_['projected'] = Geographic.projected_factory(:projection_proj4 =>
+            '+proj=merc +lon_0=0 +k=1 +x_0=0 +y_0=0 +a=6378137 +b=6378137 +units=m +no_defs')
+        end
+        result_
+      end
+      
+      
+      # Returns the number of objects allocated so far, or nil if the
+      # interpreter does not report it.
+      
+      def allocated_objects
+        if defined?(::GC.stat)
+          stat_ = ::GC.stat
+          stat_[:total_allocated_objects] || stat_[:total_allocated_object]
+        else
+          nil
+        end
+      end
+      
+      
+      # Runs the run block repeatedly on the given state for at least
+      # min_time seconds. Returns the iteration count, the elapsed time,
+      # and the number of allocated objects (or nil).
+      
+      def measure(run_, state_, min_time_)
+        run_.call(state_)
+        iterations_ = 0
+        batch_ = 1
+        allocated_ = allocated_objects
+        start_ = ::Time.now
+        elapsed_ = 0.0
+        while elapsed_ < min_time_
+          batch_.times{ run_.call(state_) }
+          iterations_ += batch_
+          elapsed_ = ::Time.now - start_
+          batch_ *= 2 if elapsed_ < min_time_ / 10
+        end
+        allocated_ = allocated_objects - allocated_ if allocated_
+        [iterations_, elapsed_, allocated_]
+      end
+      
+      
+      def env_list(name_)
+        value_ = ::ENV[name_]
+        value_ && !value_.empty? ? value_.split(',').map{ |v_| v_.strip } : nil
+      end
+      
+      
+      # Runs the configured benchmarks and writes results to the given
+      # output stream.
+      
+      def run(out_=$stdout)
+        sizes_ = (env_list('BENCH_SIZES') || ['10', '100', '1000']).map{ |s_| s_.to_i }
+        min_time_ = (::ENV['BENCH_TIME'] || 0.5).to_f
+        factory_names_ = env_list('BENCH_FACTORIES')
+        workload_names_ = env_list('BENCH_WORKLOADS')
+        reporter_ = Reporter.new(out_, ::ENV['BENCH_FORMAT'] || 'text')
+        factories.each do |factory_name_, factory_|
+          next if factory_names_ && !factory_names_.include?(factory_name_)
+          @workloads.each do |name_, setup_, run_|
+            next if workload_names_ && !workload_names_.include?(name_)
+            sizes_.each do |size_|
+              begin
+                state_ = setup_.call(factory_, size_)
+                next unless state_
+                iterations_, elapsed_, allocated_ = measure(run_, state_, min_time_)
+              rescue Error::UnsupportedOperation
+                next
+              end
+              reporter_.report(factory_name_, name_, size_, iterations_, iterations_ / elapsed_,
+                allocated_ ? allocated_.to_f / iterations_ : nil)
+            end
+          end
+        end
+        reporter_.finish
+      end
+      
+      
+    end
+    
+    
+    # Writes benchmark results in one of the supported formats.
+    
+    class Reporter
+      
+      COLUMNS = ['factory', 'workload', 'size', 'iterations', 'ops_per_sec', 'allocs_per_op']
+      
+      
+      def initialize(out_, format_)
+        @out = out_
+        @format = format_.to_s
+        unless ['text', 'tsv', 'json'].include?(@format)
+          raise ::ArgumentError, "Unknown benchmark format: #{@format}"
+        end
+        @rows = []
+        @out.puts(COLUMNS.join("\t")) if @format == 'tsv'
+      end
+      
+      
+      def report(*values_)
+        row_ = values_.map{ |v_| v_.kind_of?(::Float) ? (v_ * 100).round / 100.0 : v_ }
+        case @format
+        when 'tsv'
+          @out.puts(row_.map{ |v_| v_.to_s }.join("\t"))
+          @out.flush
+        when 'json'
+          fields_ = []
+          COLUMNS.each_with_index do |c_, i_|
+            v_ = row_[i_]
+            fields_ << "\"#{c_}\":#{v_.kind_of?(::String) ? v_.inspect : v_.nil? ? 'null' : v_}"
+          end
+          @out.puts("{#{fields_.join(',')}}")
+          @out.flush
+        else
+          @rows << row_.map{ |v_| v_.to_s }
+        end
+      end
+      
+      
+      def finish
+        return unless @format == 'text'
+        rows_ = [COLUMNS] + @rows
+        widths_ = (0...COLUMNS.size).map{ |i_| rows_.map{ |r_| r_[i_].size }.max }
+        rows_.each do |r_|
+          @out.puts(r_.each_with_index.map{ |v_, i_| i_ < 2 ? v_.ljust(widths_[i_]) : v_.rjust(widths_[i_]) }.join('  '))
+        end
+      end
+      
+      
+    end
+    
+    
+  end
+  
+end
+
+
+require ::File.expand_path('workloads', ::File.dirname(__FILE__))
+
+::RGeo::Bench.run if $0 == __FILE__
@@ -0,0 +1,125 @@
+# -----------------------------------------------------------------------------
+# 
+# Benchmark workloads
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+
+module RGeo
+  
+  module Bench  # :nodoc:
+    
+    
+    class << self
+      
+      
+      # Returns the points of a regular polygon with the given number of
+      # vertices, centered at (cx_, cy_). The coordinates stay within a
+      # few degrees so they are valid for geographic factories too.
+      
+      def ring_points(factory_, size_, cx_=10.0, cy_=10.0, radius_=5.0)
+        size_ = 3 if size_ < 3
+        points_ = (0...size_).map do |i_|
+          angle_ = ::Math::PI * 2 * i_ / size_
+          factory_.point(cx_ + radius_ * ::Math.cos(angle_), cy_ + radius_ * ::Math.sin(angle_))
+        end
+        points_ << points_.first
+      end
+      
+      
+      def polygon(factory_, size_, cx_=10.0, cy_=10.0)
+        factory_.polygon(factory_.linear_ring(ring_points(factory_, size_, cx_, cy_)))
+      end
+      
+      
+    end
+    
+    
+    workload(:point_create, ::Proc.new{ |f_, n_| [f_, n_] }) do |s_|
+      f_, n_ = s_
+      n_.times{ |i_| f_.point(i_ * 0.001, i_ * 0.002) }
+    end
+    
+    workload(:line_string_create, ::Proc.new{ |f_, n_| [f_, ring_points(f_, n_)] }) do |s_|
+      s_[0].line_string(s_[1])
+    end
+    
+    workload(:wkt_parse, ::Proc.new{ |f_, n_| [f_, polygon(f_, n_).as_text] }) do |s_|
+      s_[0].parse_wkt(s_[1])
+    end
+    
+    workload(:wkb_parse, ::Proc.new{ |f_, n_| [f_, polygon(f_, n_).as_binary] }) do |s_|
+      s_[0].parse_wkb(s_[1])
+    end
+    
+    workload(:wkt_generate, ::Proc.new{ |f_, n_| polygon(f_, n_) }) do |s_|
+      s_.as_text
+    end
+    
+    workload(:contains, ::Proc.new{ |f_, n_| [polygon(f_, n_), f_.point(10.5, 10.5)] }) do |s_|
+      s_[0].contains?(s_[1])
+    end
+    
+    workload(:intersects, ::Proc.new{ |f_, n_| [polygon(f_, n_), polygon(f_, n_, 13.0, 10.0)] }) do |s_|
+      s_[0].intersects?(s_[1])
+    end
+    
+    workload(:buffer, ::Proc.new{ |f_, n_| polygon(f_, n_) }) do |s_|
+      s_.buffer(0.5)
+    end
+    
+    workload(:union, ::Proc.new{ |f_, n_| [polygon(f_, n_), polygon(f_, n_, 13.0, 10.0)] }) do |s_|
+      s_[0].union(s_[1])
+    end
+    
+    # Runs only on factories with a projection.
+    workload(:project, ::Proc.new{ |f_, n_| f_.respond_to?(:project) && f_.projection_factory ? [f_, polygon(f_, n_)] : nil }) do |s_|
+      s_[0].project(s_[1])
+    end
+    
+    # Runs only when Proj4 is available.
+    workload(:proj4_transform, ::Proc.new{ |f_, n_|
+      if CoordSys::Proj4.supported?
+        from_ = CoordSys::Proj4.create('+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs')
+        to_ = CoordSys::Proj4.create('+proj=merc +lon_0=0 +k=1 +x_0=0 +y_0=0 +a=6378137 +b=6378137 +units=m +no_defs')
+        [from_, to_, (0...n_).map{ |i_| [i_ * 0.01, i_ * 0.005] }]
+      end
+    }) do |s_|
+      from_, to_, coords_ = s_
+      coords_.each{ |x_, y_| CoordSys::Proj4.transform_coords(from_, to_, x_, y_) }
+    end
+    
+    
+  end
+  
+end
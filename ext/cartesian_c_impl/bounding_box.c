@@ -0,0 +1,160 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  Bounding box calculations for native Cartesian implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <ruby.h>
+
+#include "bounding_box.h"
+
+RGEO_BEGIN_C
+
+
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+/*
+  Computes the minimum and maximum of each of the dims dimensions over
+  count coordinates, writing them in pairs to bounds. Each dimension is
+  scanned in its own pass so the inner loop is a plain strided min/max
+  the compiler can keep in registers.
+*/
+static void compute_coord_bounds(const double* coords, long count, int dims, double* bounds)
+{
+  int d;
+  long i;
+  long len = count * dims;
+  for (d=0; d<dims; ++d) {
+    double lo = coords[d];
+    double hi = lo;
+    for (i=d+dims; i<len; i+=dims) {
+      double v = coords[i];
+      if (v < lo) lo = v;
+      if (v > hi) hi = v;
+    }
+    bounds[d*2] = lo;
+    bounds[d*2+1] = hi;
+  }
+}
+
+
+// Returns the bounds of the given coordinates, either a packed String
+// or an array of numbers, as an array of the minimum and maximum of each
+// dimension in turn, or nil if there are no coordinates.
+
+static VALUE coordinate_bounds(VALUE coords, int dims)
+{
+  VALUE result = Qnil;
+  VALUE packed = Qnil;
+  const double* buf = NULL;
+  long len = 0;
+  if (TYPE(coords) == T_STRING) {
+    buf = (const double*)RSTRING_PTR(coords);
+    len = RSTRING_LEN(coords) / sizeof(double);
+  }
+  else {
+    Check_Type(coords, T_ARRAY);
+    len = RARRAY_LEN(coords);
+    packed = rb_str_new(NULL, (len == 0 ? 1 : len) * sizeof(double));
+    double* wbuf = (double*)RSTRING_PTR(packed);
+    long i;
+    for (i=0; i<len; ++i) {
+      wbuf[i] = NUM2DBL(rb_ary_entry(coords, i));
+    }
+    buf = wbuf;
+  }
+  long count = len / dims;
+  if (count > 0) {
+    double bounds[8];
+    compute_coord_bounds(buf, count, dims, bounds);
+    result = rb_ary_new2(dims * 2);
+    int i;
+    for (i=0; i<dims*2; ++i) {
+      rb_ary_push(result, rb_float_new(bounds[i]));
+    }
+  }
+  RB_GC_GUARD(coords);
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+static int check_dims(VALUE dims_value)
+{
+  int dims = NUM2INT(dims_value);
+  if (dims <= 0 || dims > 4) {
+    rb_raise(rb_eArgError, "Bad coordinate dimension: %d", dims);
+  }
+  return dims;
+}
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+static VALUE cmethod_coordinate_bounds(VALUE klass, VALUE coords, VALUE dims_value)
+{
+  return coordinate_bounds(coords, check_dims(dims_value));
+}
+
+
+static VALUE cmethod_coordinate_bounds_list(VALUE klass, VALUE coords_list, VALUE dims_value)
+{
+  int dims = check_dims(dims_value);
+  Check_Type(coords_list, T_ARRAY);
+  long len = RARRAY_LEN(coords_list);
+  VALUE result = rb_ary_new2(len);
+  long i;
+  for (i=0; i<len; ++i) {
+    rb_ary_push(result, coordinate_bounds(rb_ary_entry(coords_list, i), dims));
+  }
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_cartesian_bounding_box(VALUE cartesian_module)
+{
+  VALUE bbox_class = rb_define_class_under(cartesian_module, "BoundingBox", rb_cObject);
+  rb_define_singleton_method(bbox_class, "_native_coordinate_bounds", cmethod_coordinate_bounds, 2);
+  rb_define_singleton_method(bbox_class, "_native_coordinate_bounds_list", cmethod_coordinate_bounds_list, 2);
+}
+
+
+RGEO_END_C
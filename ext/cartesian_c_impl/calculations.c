@@ -0,0 +1,266 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  Calculations for native Cartesian implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <stdlib.h>
+#include <ruby.h>
+
+#include "calculations.h"
+
+RGEO_BEGIN_C
+
+
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+// A line segment in the plane. The calculations mirror those of
+// RGeo::Cartesian::Segment, and produce the same results.
+
+typedef struct {
+  double sx;
+  double sy;
+  double ex;
+  double ey;
+  double dx;
+  double dy;
+  double lensq;
+} RGeo_Segment;
+
+
+static void init_segment(RGeo_Segment* seg, const double* s, const double* e)
+{
+  seg->sx = s[0];
+  seg->sy = s[1];
+  seg->ex = e[0];
+  seg->ey = e[1];
+  seg->dx = seg->ex - seg->sx;
+  seg->dy = seg->ey - seg->sy;
+  seg->lensq = seg->dx * seg->dx + seg->dy * seg->dy;
+}
+
+
+static double segment_side(const RGeo_Segment* seg, double px, double py)
+{
+  return (seg->sx - px) * (seg->ey - py) - (seg->sy - py) * (seg->ex - px);
+}
+
+
+static int segment_contains_point(const RGeo_Segment* seg, double px, double py)
+{
+  if (segment_side(seg, px, py) == 0 && seg->lensq != 0) {
+    double t = (seg->dx * (px - seg->sx) + seg->dy * (py - seg->sy)) / seg->lensq;
+    return t >= 0.0 && t <= 1.0;
+  }
+  return 0;
+}
+
+
+static int segments_intersect(const RGeo_Segment* seg1, const RGeo_Segment* seg2)
+{
+  double sx2 = seg2->sx;
+  double sy2 = seg2->sy;
+  if (seg2->lensq == 0) {
+    if (seg1->lensq == 0) {
+      return seg1->sx == sx2 && seg1->sy == sy2;
+    }
+    return segment_contains_point(seg1, sx2, sy2);
+  }
+  else if (seg1->lensq == 0) {
+    return segment_contains_point(seg2, seg1->sx, seg1->sy);
+  }
+  double dx2 = seg2->dx;
+  double dy2 = seg2->dy;
+  double denom = seg1->dx * dy2 - seg1->dy * dx2;
+  if (denom == 0) {
+    // Parallel segments. Make sure they are collinear, then do a 1-D check.
+    if (segment_side(seg1, sx2, sy2) != 0) {
+      return 0;
+    }
+    double ts = (seg1->dx * (sx2 - seg1->sx) + seg1->dy * (sy2 - seg1->sy)) / seg1->lensq;
+    double te = (seg1->dx * (sx2 + dx2 - seg1->sx) + seg1->dy * (sy2 + dy2 - seg1->sy)) / seg1->lensq;
+    if (ts < te) {
+      return te >= 0.0 && ts <= 1.0;
+    }
+    return ts >= 0.0 && te <= 1.0;
+  }
+  double t = (dy2 * (sx2 - seg1->sx) + dx2 * (seg1->sy - sy2)) / denom;
+  if (t < 0.0 || t > 1.0) {
+    return 0;
+  }
+  double t2 = (seg1->dy * (sx2 - seg1->sx) + seg1->dx * (seg1->sy - sy2)) / denom;
+  return t2 >= 0.0 && t2 <= 1.0;
+}
+
+
+// Sweep events: segments ordered by the low end of their x extent.
+
+typedef struct {
+  double min_x;
+  long index;
+} RGeo_SweepEntry;
+
+
+static int compare_sweep_entries(const void* a, const void* b)
+{
+  double x1 = ((const RGeo_SweepEntry*)a)->min_x;
+  double x2 = ((const RGeo_SweepEntry*)b)->min_x;
+  return x1 < x2 ? -1 : (x1 > x2 ? 1 : 0);
+}
+
+
+#define SEG_MIN_X(seg) ((seg)->sx < (seg)->ex ? (seg)->sx : (seg)->ex)
+#define SEG_MAX_X(seg) ((seg)->sx < (seg)->ex ? (seg)->ex : (seg)->sx)
+#define SEG_MIN_Y(seg) ((seg)->sy < (seg)->ey ? (seg)->sy : (seg)->ey)
+#define SEG_MAX_Y(seg) ((seg)->sy < (seg)->ey ? (seg)->ey : (seg)->sy)
+
+
+// Determines whether a line string with the given n points (packed as
+// x/y pairs) is simple. This follows the rules of
+// RGeo::Cartesian::LineStringMethods#is_simple?, but finds candidate
+// pairs of non-adjacent segments by sweeping along the x axis instead of
+// testing every pair.
+
+static int line_string_is_simple(const double* points, long n)
+{
+  long len = n - 1;
+  long i, j, k;
+  int result = 1;
+  if (len <= 0) {
+    return 1;
+  }
+  RGeo_Segment* segs = ALLOC_N(RGeo_Segment, len);
+  for (i=0; i<len; ++i) {
+    init_segment(segs + i, points + i * 2, points + i * 2 + 2);
+    if (segs[i].lensq == 0) {
+      free(segs);
+      return 0;
+    }
+  }
+  if (len == 2) {
+    result = !(points[0] == points[4] && points[1] == points[5]);
+  }
+  else if (len > 2) {
+    for (i=0; i+1<len && result; ++i) {
+      if (segment_contains_point(segs + i, segs[i+1].ex, segs[i+1].ey) ||
+        segment_contains_point(segs + i + 1, segs[i].sx, segs[i].sy))
+      {
+        result = 0;
+      }
+    }
+    if (result) {
+      RGeo_SweepEntry* entries = ALLOC_N(RGeo_SweepEntry, len);
+      long* active = ALLOC_N(long, len);
+      long num_active = 0;
+      int closed = points[0] == points[len*2] && points[1] == points[len*2+1];
+      for (i=0; i<len; ++i) {
+        entries[i].min_x = SEG_MIN_X(segs + i);
+        entries[i].index = i;
+      }
+      qsort(entries, len, sizeof(RGeo_SweepEntry), compare_sweep_entries);
+      for (k=0; k<len && result; ++k) {
+        long cur = entries[k].index;
+        const RGeo_Segment* cur_seg = segs + cur;
+        double cur_min_y = SEG_MIN_Y(cur_seg);
+        double cur_max_y = SEG_MAX_Y(cur_seg);
+        long num_kept = 0;
+        for (j=0; j<num_active; ++j) {
+          long other = active[j];
+          const RGeo_Segment* other_seg = segs + other;
+          if (SEG_MAX_X(other_seg) < entries[k].min_x) {
+            continue;
+          }
+          active[num_kept++] = other;
+          if (SEG_MIN_Y(other_seg) <= cur_max_y && cur_min_y <= SEG_MAX_Y(other_seg)) {
+            long lo = other < cur ? other : cur;
+            long hi = other < cur ? cur : other;
+            if (hi - lo >= 2 && !(lo == 0 && hi == len - 1 && closed) &&
+              segments_intersect(segs + lo, segs + hi))
+            {
+              result = 0;
+              break;
+            }
+          }
+        }
+        if (result) {
+          num_active = num_kept;
+          active[num_active++] = cur;
+        }
+      }
+      free(active);
+      free(entries);
+    }
+  }
+  free(segs);
+  return result;
+}
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+static VALUE cmethod_line_string_simple(VALUE module, VALUE points)
+{
+  Check_Type(points, T_ARRAY);
+  long n = RARRAY_LEN(points);
+  long i;
+  ID x_id = rb_intern("x");
+  ID y_id = rb_intern("y");
+  VALUE packed = rb_str_new(NULL, (n == 0 ? 1 : n) * 2 * sizeof(double));
+  double* buf = (double*)RSTRING_PTR(packed);
+  for (i=0; i<n; ++i) {
+    VALUE point = rb_ary_entry(points, i);
+    buf[i*2] = NUM2DBL(rb_funcall(point, x_id, 0));
+    buf[i*2+1] = NUM2DBL(rb_funcall(point, y_id, 0));
+  }
+  VALUE result = line_string_is_simple(buf, n) ? Qtrue : Qfalse;
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_cartesian_calculations(VALUE cartesian_module)
+{
+  VALUE analysis_module = rb_define_module_under(cartesian_module, "Analysis");
+  rb_define_module_function(analysis_module, "_native_line_string_simple?", cmethod_line_string_simple, 1);
+}
+
+
+RGEO_END_C
@@ -0,0 +1,110 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  Projected window methods for native geographic implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <math.h>
+#include <ruby.h>
+
+#include "coords.h"
+#include "projected_window.h"
+
+RGEO_BEGIN_C
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+/*
+  Takes projected coordinates as a flat array (or String of packed
+  doubles) of x and y values, and returns an array of the indexes of the
+  coordinates that lie within the given window. If width is not nil, the
+  projection wraps, and each x is first normalized into the range that
+  ends at wrap_max, as ProjectedWindow#contains_point? does. A window
+  whose x_max is less than its x_min crosses the seam.
+*/
+static VALUE cmethod_filter_xy(VALUE klass, VALUE coords, VALUE window, VALUE width_value, VALUE wrap_max_value)
+{
+  Check_Type(window, T_ARRAY);
+  double x_min = NUM2DBL(rb_ary_entry(window, 0));
+  double y_min = NUM2DBL(rb_ary_entry(window, 1));
+  double x_max = NUM2DBL(rb_ary_entry(window, 2));
+  double y_max = NUM2DBL(rb_ary_entry(window, 3));
+  int wraps = !NIL_P(width_value);
+  double width = wraps ? NUM2DBL(width_value) : 0.0;
+  double wrap_max = wraps ? NUM2DBL(wrap_max_value) : 0.0;
+  int crosses_seam = x_max < x_min;
+  VALUE packed = rgeo_geographic_packed_coords(coords);
+  const double* buf = (const double*)RSTRING_PTR(packed);
+  long len = RSTRING_LEN(packed) / sizeof(double);
+  long i;
+  long count = len / 2;
+  VALUE result = rb_ary_new();
+  for (i=0; i<count; ++i) {
+    double y = buf[i*2+1];
+    if (y <= y_max && y >= y_min) {
+      double x = buf[i*2];
+      if (wraps) {
+        x = fmod(x, width);
+        if (x < 0.0) {
+          x += width;
+        }
+        if (x >= wrap_max) {
+          x -= width;
+        }
+      }
+      if (crosses_seam ? (x <= x_max || x >= x_min) : (x <= x_max && x >= x_min)) {
+        rb_ary_push(result, LONG2NUM(i));
+      }
+    }
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_geographic_projected_window(VALUE geographic_module)
+{
+  VALUE window_class = rb_define_class_under(geographic_module, "ProjectedWindow", rb_cObject);
+  rb_define_singleton_method(window_class, "_native_filter_xy", cmethod_filter_xy, 4);
+}
+
+
+RGEO_END_C
@@ -0,0 +1,130 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  Simple mercator projection for native geographic implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <math.h>
+#include <ruby.h>
+
+#include "coords.h"
+#include "simple_mercator.h"
+
+RGEO_BEGIN_C
+
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RADIANS_PER_DEGREE (M_PI / 180.0)
+#define DEGREES_PER_RADIAN (180.0 / M_PI)
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+/*
+  Projects a coordinate buffer of dims values per coordinate from
+  longitude and latitude into simple mercator x and y, using the given
+  sphere radius. Any values after the first two in each coordinate are
+  copied unchanged. Returns a String of packed doubles in the same
+  layout, suitable for the GEOS factory's *_from_coordinates methods.
+  The formulas are the same as SimpleMercatorProjector#project.
+*/
+static VALUE cmethod_project(VALUE klass, VALUE coords, VALUE dims_value, VALUE radius_value)
+{
+  int dims = NUM2INT(dims_value);
+  double radius = NUM2DBL(radius_value);
+  if (dims < 2) {
+    rb_raise(rb_eArgError, "Bad coordinate dimension: %d", dims);
+  }
+  VALUE packed = rgeo_geographic_packed_coords(coords);
+  long len = RSTRING_LEN(packed) / sizeof(double);
+  VALUE result = rb_str_new(RSTRING_PTR(packed), len * sizeof(double));
+  double* buf = (double*)RSTRING_PTR(result);
+  long i;
+  for (i=0; i+1<len; i+=dims) {
+    buf[i] = buf[i] * RADIANS_PER_DEGREE * radius;
+    buf[i+1] = log(tan(M_PI / 4.0 + buf[i+1] * RADIANS_PER_DEGREE / 2.0)) * radius;
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+/*
+  The inverse of cmethod_project: converts simple mercator x and y back
+  to longitude and latitude. Returns a flat Array of Floats, since the
+  results are used to build Ruby point objects.
+*/
+static VALUE cmethod_unproject(VALUE klass, VALUE coords, VALUE dims_value, VALUE radius_value)
+{
+  int dims = NUM2INT(dims_value);
+  double radius = NUM2DBL(radius_value);
+  if (dims < 2) {
+    rb_raise(rb_eArgError, "Bad coordinate dimension: %d", dims);
+  }
+  VALUE packed = rgeo_geographic_packed_coords(coords);
+  long len = RSTRING_LEN(packed) / sizeof(double);
+  const double* buf = (const double*)RSTRING_PTR(packed);
+  VALUE result = rb_ary_new2(len);
+  long i;
+  int d;
+  for (i=0; i+1<len; i+=dims) {
+    rb_ary_push(result, rb_float_new(buf[i] / radius * DEGREES_PER_RADIAN));
+    rb_ary_push(result, rb_float_new((2.0 * atan(exp(buf[i+1] / radius)) - M_PI / 2.0) * DEGREES_PER_RADIAN));
+    for (d=2; d<dims && i+d<len; ++d) {
+      rb_ary_push(result, rb_float_new(buf[i+d]));
+    }
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_geographic_simple_mercator(VALUE geographic_module)
+{
+  VALUE projector_class = rb_define_class_under(geographic_module, "SimpleMercatorProjector", rb_cObject);
+  rb_define_singleton_method(projector_class, "_native_project", cmethod_project, 3);
+  rb_define_singleton_method(projector_class, "_native_unproject", cmethod_unproject, 3);
+}
+
+
+RGEO_END_C
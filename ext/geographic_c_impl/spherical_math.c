@@ -0,0 +1,274 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  Spherical math kernel for native Geographic implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <math.h>
+#include <ruby.h>
+
+#include "spherical_math.h"
+
+RGEO_BEGIN_C
+
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RADIANS_PER_DEGREE (M_PI / 180.0)
+
+
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+// Points are represented as unit vectors in a right-handed system where
+// the z-axis goes through the north pole and the x-axis through the
+// prime meridian. These functions mirror RGeo::Geographic::SphericalMath
+// PointXYZ and ArcXYZ, and produce the same results.
+
+
+static void normalize(double* p)
+{
+  double r = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+  p[0] /= r;
+  p[1] /= r;
+  p[2] /= r;
+}
+
+
+static void xyz_from_latlon(double lat, double lon, double* p)
+{
+  double lat_rad = RADIANS_PER_DEGREE * lat;
+  double lon_rad = RADIANS_PER_DEGREE * lon;
+  double r = cos(lat_rad);
+  p[0] = cos(lon_rad) * r;
+  p[1] = sin(lon_rad) * r;
+  p[2] = sin(lat_rad);
+  normalize(p);
+}
+
+
+static double dot(const double* p1, const double* p2)
+{
+  double val = p1[0] * p2[0] + p1[1] * p2[1] + p1[2] * p2[2];
+  if (val > 1.0) {
+    val = 1.0;
+  }
+  else if (val < -1.0) {
+    val = -1.0;
+  }
+  return val;
+}
+
+
+// Computes the normalized axis of the great circle through p1 and p2.
+// Returns 0 if the points are coincident or antipodal.
+
+static int axis(const double* p1, const double* p2, double* result)
+{
+  result[0] = p1[1] * p2[2] - p1[2] * p2[1];
+  result[1] = p1[2] * p2[0] - p1[0] * p2[2];
+  result[2] = p1[0] * p2[1] - p1[1] * p2[0];
+  normalize(result);
+  return !(isnan(result[0]) || isnan(result[1]) || isnan(result[2]));
+}
+
+
+static double dist_between(const double* p1, const double* p2)
+{
+  double x = p1[1] * p2[2] - p1[2] * p2[1];
+  double y = p1[2] * p2[0] - p1[0] * p2[2];
+  double z = p1[0] * p2[1] - p1[1] * p2[0];
+  double r = sqrt(x * x + y * y + z * z);
+  if (r > 1.0) {
+    r = 1.0;
+  }
+  return asin(r);
+}
+
+
+static int points_equal(const double* p1, const double* p2)
+{
+  return p1[0] == p2[0] && p1[1] == p2[1] && p1[2] == p2[2];
+}
+
+
+// Arcs are given by pointers to their start and end points, with the
+// precomputed axis.
+
+static int arc_contains_point(const double* s, const double* e, const double* arc_axis, const double* p)
+{
+  double saxis[3], eaxis[3];
+  if (!axis(s, p, saxis) || !axis(p, e, eaxis)) {
+    return 1;
+  }
+  return dot(p, arc_axis) == 0.0 && dot(saxis, arc_axis) > 0 && dot(eaxis, arc_axis) > 0;
+}
+
+
+static int arcs_intersect(const double* s1, const double* e1, const double* axis1,
+  const double* s2, const double* e2, const double* axis2)
+{
+  double dot1 = dot(axis1, s2);
+  double dot2 = dot(axis1, e2);
+  if ((dot1 >= 0.0 && dot2 <= 0.0) || (dot1 <= 0.0 && dot2 >= 0.0)) {
+    dot1 = dot(axis2, s1);
+    dot2 = dot(axis2, e1);
+    return (dot1 >= 0.0 && dot2 <= 0.0) || (dot1 <= 0.0 && dot2 >= 0.0);
+  }
+  return 0;
+}
+
+
+// Determines whether the line string with the given n points is simple.
+// The axes buffer must have room for n-1 axes. This follows the
+// algorithm of SphericalLineStringMethods#is_simple?.
+
+static int line_string_is_simple(const double* points, double* axes, long n)
+{
+  long len = n - 1;
+  long i, j;
+  for (i=0; i<len; ++i) {
+    if (!axis(points + i * 3, points + (i + 1) * 3, axes + i * 3)) {
+      return 0;
+    }
+  }
+  if (len <= 1) {
+    return 1;
+  }
+  if (len == 2) {
+    return !points_equal(points, points + 6);
+  }
+  for (i=0; i<len; ++i) {
+    const double* s = points + i * 3;
+    const double* e = s + 3;
+    const double* arc_axis = axes + i * 3;
+    if (i + 1 < len && arc_contains_point(s, e, arc_axis, points + (i + 2) * 3)) {
+      return 0;
+    }
+    if (i > 0 && arc_contains_point(s, e, arc_axis, points + (i - 1) * 3)) {
+      return 0;
+    }
+    for (j=i+2; j<len; ++j) {
+      const double* os = points + j * 3;
+      if (!(i == 0 && j == len - 1 && points_equal(s, os + 3)) &&
+        arcs_intersect(s, e, arc_axis, os, os + 3, axes + j * 3))
+      {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+
+// Converts an array of geographic point objects to a packed buffer of
+// unit vectors. The point coordinates are read using the x and y methods.
+
+static VALUE packed_xyz_from_points(VALUE points)
+{
+  long n = RARRAY_LEN(points);
+  long i;
+  ID x_id = rb_intern("x");
+  ID y_id = rb_intern("y");
+  VALUE result = rb_str_new(NULL, (n == 0 ? 1 : n) * 3 * sizeof(double));
+  double* buf = (double*)RSTRING_PTR(result);
+  for (i=0; i<n; ++i) {
+    VALUE point = rb_ary_entry(points, i);
+    xyz_from_latlon(NUM2DBL(rb_funcall(point, y_id, 0)), NUM2DBL(rb_funcall(point, x_id, 0)), buf + i * 3);
+  }
+  return result;
+}
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+static VALUE cmethod_distance(VALUE module, VALUE lat1, VALUE lon1, VALUE lat2, VALUE lon2)
+{
+  double p1[3], p2[3];
+  xyz_from_latlon(rb_num2dbl(lat1), rb_num2dbl(lon1), p1);
+  xyz_from_latlon(rb_num2dbl(lat2), rb_num2dbl(lon2), p2);
+  return rb_float_new(dist_between(p1, p2));
+}
+
+
+static VALUE cmethod_distances(VALUE module, VALUE lat, VALUE lon, VALUE points, VALUE radius)
+{
+  Check_Type(points, T_ARRAY);
+  double p[3];
+  double r = rb_num2dbl(radius);
+  xyz_from_latlon(rb_num2dbl(lat), rb_num2dbl(lon), p);
+  VALUE packed = packed_xyz_from_points(points);
+  const double* buf = (const double*)RSTRING_PTR(packed);
+  long n = RARRAY_LEN(points);
+  long i;
+  VALUE result = rb_ary_new2(n);
+  for (i=0; i<n; ++i) {
+    rb_ary_push(result, rb_float_new(dist_between(p, buf + i * 3) * r));
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+static VALUE cmethod_line_string_simple(VALUE module, VALUE points)
+{
+  Check_Type(points, T_ARRAY);
+  VALUE packed = packed_xyz_from_points(points);
+  VALUE axes = rb_str_new(NULL, RSTRING_LEN(packed));
+  VALUE result = line_string_is_simple((const double*)RSTRING_PTR(packed),
+    (double*)RSTRING_PTR(axes), RARRAY_LEN(points)) ? Qtrue : Qfalse;
+  RB_GC_GUARD(packed);
+  RB_GC_GUARD(axes);
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_geographic_spherical_math(VALUE geographic_module)
+{
+  VALUE spherical_math_module = rb_define_module_under(geographic_module, "SphericalMath");
+  rb_define_module_function(spherical_math_module, "_native_distance", cmethod_distance, 4);
+  rb_define_module_function(spherical_math_module, "_native_distances", cmethod_distances, 4);
+  rb_define_module_function(spherical_math_module, "_native_line_string_simple?", cmethod_line_string_simple, 1);
+}
+
+
+RGEO_END_C
@@ -71,6 +71,14 @@ else
     $libs << ' -lgeos -lgeos_c'
     if have_func('initGEOS_r', 'geos_c.h')
       found_geos_ = true
+      have_func('GEOSPreparedContains_r', 'geos_c.h')
+      have_func('GEOSPreparedDisjoint_r', 'geos_c.h')
+      have_func('GEOSSTRtree_create_r', 'geos_c.h')
+      have_func('GEOSUnaryUnion_r', 'geos_c.h')
+      have_header('pthread.h')
+      have_header('ruby/thread.h')
+      have_func('rb_thread_call_without_gvl', 'ruby/thread.h')
+      have_func('rb_thread_blocking_region')
     else
       $libs.gsub!(' -lgeos -lgeos_c', '')
     end
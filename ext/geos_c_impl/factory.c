@@ -39,8 +39,13 @@
 
 #ifdef RGEO_GEOS_SUPPORTED
 
+#include <math.h>
+#include <time.h>
 #include <ruby.h>
 #include <geos_c.h>
+#ifdef HAVE_RUBY_THREAD_H
+#include <ruby/thread.h>
+#endif
 
 #include "factory.h"
 #include "geometry.h"
@@ -63,35 +68,25 @@ static void message_handler(const char* fmt, ...)
 }
 
 
-// Destroy function for factory data. We destroy any serialization
-// objects that have been created for the factory, and then destroy
-// the GEOS context, before freeing the factory data itself.
+// Destroy function for factory data. The GEOS context and serializers
+// belong to the globals, so there is nothing to release but the data.
 
 static void destroy_factory_func(RGeo_FactoryData* data)
 {
-  GEOSContextHandle_t context = data->geos_context;
-  if (data->wkt_reader) {
-    GEOSWKTReader_destroy_r(context, data->wkt_reader);
-  }
-  if (data->wkb_reader) {
-    GEOSWKBReader_destroy_r(context, data->wkb_reader);
-  }
-  if (data->wkt_writer) {
-    GEOSWKTWriter_destroy_r(context, data->wkt_writer);
+  if (data->stats) {
+    free(data->stats);
   }
-  if (data->wkb_writer) {
-    GEOSWKBWriter_destroy_r(context, data->wkb_writer);
-  }
-  finishGEOS_r(context);
   free(data);
 }
 
 
 // Destroy function for geometry data. We destroy the internal
-// GEOS geometry (if present) before freeing the data itself.
+// GEOS geometry (if present) before freeing the data itself. The
+// prepared geometry refers to the geometry, so it goes first.
 
 static void destroy_geometry_func(RGeo_GeometryData* data)
 {
+  rgeo_release_prepared_geometry(data);
   if (data->geom) {
     GEOSGeom_destroy_r(data->geos_context, data->geom);
   }
@@ -127,6 +122,44 @@ static void mark_geometry_func(RGeo_GeometryData* data)
 }
 
 
+#ifdef RGEO_GEOS_RELEASES_GVL
+
+// State for a call made without the interpreter lock.
+
+typedef struct {
+  GEOSContextHandle_t context;
+  void* (*func)(GEOSContextHandle_t, void*);
+  void* arg;
+  void* result;
+} RGeo_BlockingCall;
+
+
+// Runs a call on its borrowed context. This runs without the
+// interpreter lock, and the context is not shared with any other call.
+
+static void* blocking_call_func(void* data)
+{
+  RGeo_BlockingCall* call = (RGeo_BlockingCall*)data;
+  call->result = call->func(call->context, call->arg);
+  return NULL;
+}
+
+
+#ifndef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+
+// Adapter for the Ruby 1.9 rb_thread_blocking_region API.
+
+static VALUE blocking_region_func(void* data)
+{
+  blocking_call_func(data);
+  return Qnil;
+}
+
+#endif
+
+#endif
+
+
 // Destroy function for globals data. We don't need to destroy any
 // auxiliary data for now...
 
@@ -144,6 +177,329 @@ static void mark_globals_func(RGeo_Globals* data)
 }
 
 
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+// Returns the time in seconds from a monotonic clock, for stats timings.
+
+static double current_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+static void reset_stats(RGeo_FactoryStats* stats)
+{
+  stats->geos_calls = 0;
+  stats->geos_time = 0;
+  stats->conversions = 0;
+  stats->clones = 0;
+  stats->allocations = 0;
+  stats->callbacks = 0;
+}
+
+
+#ifdef RGEO_GEOS_RELEASES_GVL
+
+// Takes an idle context from the blocking context pool, or creates a
+// new one if the pool is empty. Must be called holding the interpreter
+// lock. Returns NULL if a context could not be created.
+
+static GEOSContextHandle_t borrow_blocking_context(RGeo_Globals* globals)
+{
+  if (globals->num_blocking_contexts > 0) {
+    return globals->blocking_contexts[--globals->num_blocking_contexts];
+  }
+  return initGEOS_r(message_handler, message_handler);
+}
+
+
+// Returns a context to the blocking context pool, growing the pool if
+// needed. Must be called holding the interpreter lock.
+
+static void return_blocking_context(RGeo_Globals* globals, GEOSContextHandle_t context)
+{
+  if (globals->num_blocking_contexts == globals->blocking_contexts_capacity) {
+    unsigned int capacity = globals->blocking_contexts_capacity == 0 ? 4 : globals->blocking_contexts_capacity * 2;
+    if (globals->blocking_contexts) {
+      REALLOC_N(globals->blocking_contexts, GEOSContextHandle_t, capacity);
+    }
+    else {
+      globals->blocking_contexts = ALLOC_N(GEOSContextHandle_t, capacity);
+    }
+    globals->blocking_contexts_capacity = capacity;
+  }
+  globals->blocking_contexts[globals->num_blocking_contexts++] = context;
+}
+
+#endif
+
+
+// Builds a copy of the given geometry, with the same structure, whose
+// coordinates are taken in order from the given buffer. The buffer holds
+// in_dims (2 or 3) doubles per coordinate, and *index is advanced past
+// the coordinates used. If coords is NULL, the geometry's own coordinates
+// are used instead. The given geometry may belong to any context.
+// Returns NULL on failure, including if it runs out of coordinates or
+// encounters a coordinate whose x or y is NaN. The x and y coordinates
+// are snapped to the grid given by grid_scale (see rgeo_snap_coordinate).
+
+static GEOSGeometry* copy_with_coords(GEOSContextHandle_t context, const GEOSGeometry* geom,
+  const double* coords, unsigned int in_dims, char has_z, unsigned int* index, unsigned int count, double grid_scale)
+{
+  GEOSGeometry* result = NULL;
+  int type = GEOSGeomTypeId_r(context, geom);
+  int i, n;
+  switch (type) {
+  case GEOS_POINT:
+  case GEOS_LINESTRING:
+  case GEOS_LINEARRING:
+    {
+      const GEOSCoordSequence* coord_seq = GEOSGeom_getCoordSeq_r(context, geom);
+      unsigned int size, j;
+      if (coord_seq && GEOSCoordSeq_getSize_r(context, coord_seq, &size) && *index + size <= count) {
+        if (size == 0) {
+          result = GEOSGeom_clone_r(context, geom);
+        }
+        else {
+          GEOSCoordSequence* ncoord_seq = GEOSCoordSeq_create_r(context, size, has_z ? 3 : 2);
+          if (ncoord_seq) {
+            char good = 1;
+            double own_coord[3];
+            for (j=0; j<size; ++j) {
+              const double* coord = own_coord;
+              if (coords) {
+                coord = coords + (*index + j) * in_dims;
+              }
+              else {
+                GEOSCoordSeq_getX_r(context, coord_seq, j, &own_coord[0]);
+                GEOSCoordSeq_getY_r(context, coord_seq, j, &own_coord[1]);
+                if (in_dims == 3) {
+                  GEOSCoordSeq_getZ_r(context, coord_seq, j, &own_coord[2]);
+                }
+              }
+              if (isnan(coord[0]) || isnan(coord[1])) {
+                good = 0;
+                break;
+              }
+              GEOSCoordSeq_setX_r(context, ncoord_seq, j, rgeo_snap_coordinate(coord[0], grid_scale));
+              GEOSCoordSeq_setY_r(context, ncoord_seq, j, rgeo_snap_coordinate(coord[1], grid_scale));
+              if (has_z) {
+                GEOSCoordSeq_setZ_r(context, ncoord_seq, j, in_dims == 3 ? coord[2] : 0.0);
+              }
+            }
+            if (good) {
+              if (type == GEOS_POINT) {
+                result = GEOSGeom_createPoint_r(context, ncoord_seq);
+              }
+              else if (type == GEOS_LINESTRING) {
+                result = GEOSGeom_createLineString_r(context, ncoord_seq);
+              }
+              else {
+                result = GEOSGeom_createLinearRing_r(context, ncoord_seq);
+              }
+            }
+            if (!result) {
+              GEOSCoordSeq_destroy_r(context, ncoord_seq);
+            }
+          }
+        }
+        *index += size;
+      }
+    }
+    break;
+  case GEOS_POLYGON:
+    {
+      const GEOSGeometry* ring = GEOSGetExteriorRing_r(context, geom);
+      GEOSGeometry* shell = ring ? copy_with_coords(context, ring, coords, in_dims, has_z, index, count, grid_scale) : NULL;
+      if (shell) {
+        n = GEOSGetNumInteriorRings_r(context, geom);
+        GEOSGeometry** holes = ALLOC_N(GEOSGeometry*, n == 0 ? 1 : n);
+        if (holes) {
+          for (i=0; i<n; ++i) {
+            ring = GEOSGetInteriorRingN_r(context, geom, i);
+            holes[i] = ring ? copy_with_coords(context, ring, coords, in_dims, has_z, index, count, grid_scale) : NULL;
+            if (!holes[i]) {
+              break;
+            }
+          }
+          if (i == n) {
+            result = GEOSGeom_createPolygon_r(context, shell, holes, n);
+          }
+          if (!result) {
+            for (--i; i>=0; --i) {
+              GEOSGeom_destroy_r(context, holes[i]);
+            }
+          }
+          free(holes);
+        }
+        if (!result) {
+          GEOSGeom_destroy_r(context, shell);
+        }
+      }
+    }
+    break;
+  case GEOS_MULTIPOINT:
+  case GEOS_MULTILINESTRING:
+  case GEOS_MULTIPOLYGON:
+  case GEOS_GEOMETRYCOLLECTION:
+    {
+      n = GEOSGetNumGeometries_r(context, geom);
+      GEOSGeometry** geoms = ALLOC_N(GEOSGeometry*, n == 0 ? 1 : n);
+      if (geoms) {
+        for (i=0; i<n; ++i) {
+          const GEOSGeometry* elem = GEOSGetGeometryN_r(context, geom, i);
+          geoms[i] = elem ? copy_with_coords(context, elem, coords, in_dims, has_z, index, count, grid_scale) : NULL;
+          if (!geoms[i]) {
+            break;
+          }
+        }
+        if (i == n) {
+          result = GEOSGeom_createCollection_r(context, type, geoms, n);
+        }
+        if (!result) {
+          for (--i; i>=0; --i) {
+            GEOSGeom_destroy_r(context, geoms[i]);
+          }
+        }
+        free(geoms);
+      }
+    }
+    break;
+  }
+  return result;
+}
+
+
+// Interprets a flat coordinate buffer from ruby, which may be either
+// an Array of numbers or a String of packed native doubles, with dims
+// numbers per coordinate. Returns a String of packed doubles, or Qnil
+// if the input is malformed.
+
+static VALUE packed_coords_from_value(VALUE coords, unsigned int dims)
+{
+  VALUE result = Qnil;
+  unsigned int len, i;
+  if (TYPE(coords) == T_STRING) {
+    if (RSTRING_LEN(coords) % (dims * sizeof(double)) == 0) {
+      result = coords;
+    }
+  }
+  else if (TYPE(coords) == T_ARRAY) {
+    len = (unsigned int)RARRAY_LEN(coords);
+    if (len % dims == 0) {
+      for (i=0; i<len; ++i) {
+        if (!rb_obj_is_kind_of(rb_ary_entry(coords, i), rb_cNumeric)) {
+          return Qnil;
+        }
+      }
+      result = rb_str_new(NULL, len * sizeof(double));
+      double* buf = (double*)RSTRING_PTR(result);
+      for (i=0; i<len; ++i) {
+        buf[i] = NUM2DBL(rb_ary_entry(coords, i));
+      }
+    }
+  }
+  return result;
+}
+
+
+// Creates a coordinate sequence from count packed coordinates of dims
+// (2 or 3) doubles each. If close is set, the first coordinate is
+// appended if the sequence is not already closed. The x and y coordinates
+// are snapped to the grid given by grid_scale.
+
+static GEOSCoordSequence* coord_seq_from_packed(GEOSContextHandle_t context, const double* coords, unsigned int count, unsigned int dims, char close, double grid_scale)
+{
+  unsigned int i;
+  if (count > 0 && close) {
+    if (coords[0] == coords[(count-1)*dims] && coords[1] == coords[(count-1)*dims+1]) {
+      close = 0;
+    }
+  }
+  else {
+    close = 0;
+  }
+  GEOSCoordSequence* coord_seq = GEOSCoordSeq_create_r(context, count + close, 3);
+  if (coord_seq) {
+    for (i=0; i<count; ++i) {
+      const double* coord = coords + i * dims;
+      GEOSCoordSeq_setX_r(context, coord_seq, i, rgeo_snap_coordinate(coord[0], grid_scale));
+      GEOSCoordSeq_setY_r(context, coord_seq, i, rgeo_snap_coordinate(coord[1], grid_scale));
+      GEOSCoordSeq_setZ_r(context, coord_seq, i, dims == 3 ? coord[2] : 0);
+    }
+    if (close) {
+      GEOSCoordSeq_setX_r(context, coord_seq, count, rgeo_snap_coordinate(coords[0], grid_scale));
+      GEOSCoordSeq_setY_r(context, coord_seq, count, rgeo_snap_coordinate(coords[1], grid_scale));
+      GEOSCoordSeq_setZ_r(context, coord_seq, count, dims == 3 ? coords[2] : 0);
+    }
+  }
+  return coord_seq;
+}
+
+
+// Creates a line string or linear ring from a flat coordinate buffer.
+// Returns NULL if the input is malformed.
+
+static GEOSGeometry* line_string_from_coords(RGeo_FactoryData* factory_data, VALUE coords, char ring)
+{
+  GEOSGeometry* result = NULL;
+  GEOSContextHandle_t context = factory_data->geos_context;
+  unsigned int dims = (factory_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z_OR_M) ? 3 : 2;
+  VALUE packed = packed_coords_from_value(coords, dims);
+  if (!NIL_P(packed)) {
+    GEOSCoordSequence* coord_seq = coord_seq_from_packed(context, (const double*)RSTRING_PTR(packed),
+      (unsigned int)(RSTRING_LEN(packed) / (dims * sizeof(double))), dims, ring, factory_data->grid_scale);
+    if (coord_seq) {
+      result = ring ? GEOSGeom_createLinearRing_r(context, coord_seq) : GEOSGeom_createLineString_r(context, coord_seq);
+    }
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+// Takes the GEOS geometry out of the given ruby Geometry object,
+// leaving the object uninitialized, and returns it. Also sets *klasses
+// (if klasses is not NULL) as described for
+// rgeo_convert_to_detached_geos_geometry. Returns NULL if given Qnil.
+
+static GEOSGeometry* detach_geos_geometry(VALUE object, VALUE* klasses)
+{
+  GEOSGeometry* geom = NULL;
+  if (klasses) {
+    *klasses = Qnil;
+  }
+  if (!NIL_P(object)) {
+    RGeo_GeometryData* object_data = RGEO_GEOMETRY_DATA_PTR(object);
+    geom = object_data->geom;
+    if (klasses) {
+      *klasses = object_data->klasses;
+      if (NIL_P(*klasses)) {
+        *klasses = CLASS_OF(object);
+      }
+    }
+    rgeo_release_prepared_geometry(object_data);
+    object_data->geom = NULL;
+    object_data->geos_context = NULL;
+    object_data->factory = Qnil;
+    object_data->klasses = Qnil;
+  }
+  return geom;
+}
+
+
+// Returns true if obj must be cast to become a geometry of the given
+// factory, which counts as a conversion in the factory's stats.
+
+static int needs_conversion(VALUE obj, VALUE factory)
+{
+  return !rgeo_is_geos_object(obj) || RGEO_RAW_GEOMETRY_DATA_PTR(obj)->factory != factory;
+}
+
+
 /**** RUBY METHOD DEFINITIONS ****/
 
 
@@ -159,25 +515,59 @@ static VALUE method_factory_buffer_resolution(VALUE self)
 }
 
 
+static VALUE method_factory_grid_size(VALUE self)
+{
+  double grid_scale = RGEO_FACTORY_DATA_PTR(self)->grid_scale;
+  return grid_scale > 0 ? rb_float_new(1.0 / grid_scale) : Qnil;
+}
+
+
 static VALUE method_factory_flags(VALUE self)
 {
   return INT2NUM(RGEO_FACTORY_DATA_PTR(self)->flags);
 }
 
 
+static VALUE method_factory_stats(VALUE self)
+{
+  VALUE result = Qnil;
+  RGeo_FactoryStats* stats = RGEO_FACTORY_DATA_PTR(self)->stats;
+  if (stats) {
+    result = rb_hash_new();
+    rb_hash_aset(result, ID2SYM(rb_intern("geos_calls")), ULONG2NUM(stats->geos_calls));
+    rb_hash_aset(result, ID2SYM(rb_intern("geos_time")), rb_float_new(stats->geos_time));
+    rb_hash_aset(result, ID2SYM(rb_intern("conversions")), ULONG2NUM(stats->conversions));
+    rb_hash_aset(result, ID2SYM(rb_intern("clones")), ULONG2NUM(stats->clones));
+    rb_hash_aset(result, ID2SYM(rb_intern("allocations")), ULONG2NUM(stats->allocations));
+    rb_hash_aset(result, ID2SYM(rb_intern("callbacks")), ULONG2NUM(stats->callbacks));
+  }
+  return result;
+}
+
+
+static VALUE method_factory_reset_stats(VALUE self)
+{
+  RGeo_FactoryStats* stats = RGEO_FACTORY_DATA_PTR(self)->stats;
+  if (stats) {
+    reset_stats(stats);
+  }
+  return Qnil;
+}
+
+
 static VALUE method_factory_parse_wkt(VALUE self, VALUE str)
 {
   Check_Type(str, T_STRING);
   RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
   GEOSContextHandle_t self_context = self_data->geos_context;
-  GEOSWKTReader* wkt_reader = self_data->wkt_reader;
+  GEOSWKTReader* wkt_reader = self_data->globals->wkt_reader;
   if (!wkt_reader) {
     wkt_reader = GEOSWKTReader_create_r(self_context);
-    self_data->wkt_reader = wkt_reader;
+    self_data->globals->wkt_reader = wkt_reader;
   }
   VALUE result = Qnil;
   if (wkt_reader) {
-    GEOSGeometry* geom = GEOSWKTReader_read_r(self_context, wkt_reader, RSTRING_PTR(str));
+    GEOSGeometry* geom = rgeo_snap_geos_geometry(self_data, GEOSWKTReader_read_r(self_context, wkt_reader, RSTRING_PTR(str)));
     if (geom) {
       result = rgeo_wrap_geos_geometry(self, geom, Qnil);
     }
@@ -186,52 +576,187 @@ static VALUE method_factory_parse_wkt(VALUE self, VALUE str)
 }
 
 
-static VALUE method_factory_parse_wkb(VALUE self, VALUE str)
+// Reads the given WKB using the shared GEOS WKB reader, and wraps the
+// result using the given klass (see rgeo_wrap_geos_geometry).
+
+static VALUE read_wkb(VALUE self, VALUE str, VALUE klass)
 {
   Check_Type(str, T_STRING);
   RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
   GEOSContextHandle_t self_context = self_data->geos_context;
-  GEOSWKBReader* wkb_reader = self_data->wkb_reader;
+  GEOSWKBReader* wkb_reader = self_data->globals->wkb_reader;
   if (!wkb_reader) {
     wkb_reader = GEOSWKBReader_create_r(self_context);
-    self_data->wkb_reader = wkb_reader;
+    self_data->globals->wkb_reader = wkb_reader;
   }
   VALUE result = Qnil;
   if (wkb_reader) {
-    GEOSGeometry* geom = GEOSWKBReader_read_r(self_context, wkb_reader, (unsigned char*)RSTRING_PTR(str), (size_t)RSTRING_LEN(str));
+    GEOSGeometry* geom = rgeo_snap_geos_geometry(self_data,
+      GEOSWKBReader_read_r(self_context, wkb_reader, (unsigned char*)RSTRING_PTR(str), (size_t)RSTRING_LEN(str)));
     if (geom) {
-      result = rgeo_wrap_geos_geometry(self, geom, Qnil);
+      result = rgeo_wrap_geos_geometry(self, geom, klass);
     }
   }
   return result;
 }
 
 
+static VALUE method_factory_parse_wkb(VALUE self, VALUE str)
+{
+  return read_wkb(self, str, Qnil);
+}
+
+
+static VALUE method_factory_unmarshal_wkb(VALUE self, VALUE str, VALUE klass)
+{
+  return read_wkb(self, str, klass);
+}
+
+
+static VALUE method_factory_copy_with_packed_coordinates(VALUE self, VALUE template, VALUE packed, VALUE has_z)
+{
+  VALUE result = Qnil;
+  const GEOSGeometry* template_geom = rgeo_get_geos_geometry_safe(template);
+  if (template_geom && TYPE(packed) == T_STRING) {
+    RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
+    unsigned int in_dims = RTEST(has_z) ? 3 : 2;
+    unsigned int count = (unsigned int)(RSTRING_LEN(packed) / (in_dims * sizeof(double)));
+    unsigned int index = 0;
+    GEOSGeometry* geom = copy_with_coords(self_data->geos_context, template_geom, (const double*)RSTRING_PTR(packed),
+      in_dims, (self_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z_OR_M) != 0, &index, count, self_data->grid_scale);
+    if (geom) {
+      VALUE klasses = RGEO_GEOMETRY_DATA_PTR(template)->klasses;
+      result = rgeo_wrap_geos_geometry(self, geom, NIL_P(klasses) ? CLASS_OF(template) : klasses);
+    }
+  }
+  return result;
+}
+
+
+static VALUE method_factory_line_string_from_coords(VALUE self, VALUE coords)
+{
+  VALUE result = Qnil;
+  RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
+  GEOSGeometry* geom = line_string_from_coords(self_data, coords, 0);
+  if (geom) {
+    result = rgeo_wrap_geos_geometry(self, geom, self_data->globals->geos_line_string);
+  }
+  return result;
+}
+
+
+static VALUE method_factory_linear_ring_from_coords(VALUE self, VALUE coords)
+{
+  VALUE result = Qnil;
+  RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
+  GEOSGeometry* geom = line_string_from_coords(self_data, coords, 1);
+  if (geom) {
+    result = rgeo_wrap_geos_geometry(self, geom, self_data->globals->geos_linear_ring);
+  }
+  return result;
+}
+
+
+static VALUE method_factory_polygon_from_coords(VALUE self, VALUE exterior, VALUE interior_array)
+{
+  Check_Type(interior_array, T_ARRAY);
+  RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
+  GEOSContextHandle_t context = self_data->geos_context;
+  GEOSGeometry* exterior_geom = line_string_from_coords(self_data, exterior, 1);
+  if (exterior_geom) {
+    unsigned int len = (unsigned int)RARRAY_LEN(interior_array);
+    GEOSGeometry** interior_geoms = ALLOC_N(GEOSGeometry*, len == 0 ? 1 : len);
+    if (interior_geoms) {
+      unsigned int actual_len = 0;
+      unsigned int i;
+      for (i=0; i<len; ++i) {
+        GEOSGeometry* interior_geom = line_string_from_coords(self_data, rb_ary_entry(interior_array, i), 1);
+        if (!interior_geom) {
+          break;
+        }
+        interior_geoms[actual_len++] = interior_geom;
+      }
+      if (len == actual_len) {
+        GEOSGeometry* polygon = GEOSGeom_createPolygon_r(context, exterior_geom, interior_geoms, actual_len);
+        if (polygon) {
+          free(interior_geoms);
+          return rgeo_wrap_geos_geometry(self, polygon, self_data->globals->geos_polygon);
+        }
+      }
+      for (i=0; i<actual_len; ++i) {
+        GEOSGeom_destroy_r(context, interior_geoms[i]);
+      }
+      free(interior_geoms);
+    }
+    GEOSGeom_destroy_r(context, exterior_geom);
+  }
+  return Qnil;
+}
+
+
+static VALUE method_factory_multi_point_from_coords(VALUE self, VALUE coords)
+{
+  VALUE result = Qnil;
+  RGeo_FactoryData* self_data = RGEO_FACTORY_DATA_PTR(self);
+  GEOSContextHandle_t context = self_data->geos_context;
+  unsigned int dims = (self_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z_OR_M) ? 3 : 2;
+  VALUE packed = packed_coords_from_value(coords, dims);
+  if (!NIL_P(packed)) {
+    const double* buf = (const double*)RSTRING_PTR(packed);
+    unsigned int count = (unsigned int)(RSTRING_LEN(packed) / (dims * sizeof(double)));
+    GEOSGeometry** geoms = ALLOC_N(GEOSGeometry*, count == 0 ? 1 : count);
+    if (geoms) {
+      unsigned int i, j;
+      for (i=0; i<count; ++i) {
+        GEOSCoordSequence* coord_seq = coord_seq_from_packed(context, buf + i * dims, 1, dims, 0, self_data->grid_scale);
+        geoms[i] = coord_seq ? GEOSGeom_createPoint_r(context, coord_seq) : NULL;
+        if (!geoms[i]) {
+          break;
+        }
+      }
+      GEOSGeometry* collection = NULL;
+      if (i == count) {
+        collection = GEOSGeom_createCollection_r(context, GEOS_MULTIPOINT, geoms, count);
+      }
+      if (collection) {
+        result = rgeo_wrap_geos_geometry(self, collection, self_data->globals->geos_multi_point);
+      }
+      else {
+        for (j=0; j<i; ++j) {
+          GEOSGeom_destroy_r(context, geoms[j]);
+        }
+      }
+      free(geoms);
+    }
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
 static VALUE cmethod_factory_create(VALUE klass, VALUE flags, VALUE srid, VALUE buffer_resolution,
-  VALUE wkt_generator, VALUE wkb_generator)
+  VALUE wkt_generator, VALUE wkb_generator, VALUE wkt_native_flags, VALUE wkb_native_flags, VALUE grid_size)
 {
   VALUE result = Qnil;
   RGeo_FactoryData* data = ALLOC(RGeo_FactoryData);
   if (data) {
-    GEOSContextHandle_t context = initGEOS_r(message_handler, message_handler);
-    if (context) {
-      VALUE wrapped_globals = rb_const_get_at(klass, rb_intern("INTERNAL_CGLOBALS"));
-      data->globals = (RGeo_Globals*)DATA_PTR(wrapped_globals);
-      data->geos_context = context;
-      data->flags = NUM2INT(flags);
-      data->srid = NUM2INT(srid);
-      data->buffer_resolution = NUM2INT(buffer_resolution);
-      data->wkt_reader = NULL;
-      data->wkb_reader = NULL;
-      data->wkt_writer = NULL;
-      data->wkb_writer = NULL;
-      data->wkrep_wkt_generator = wkt_generator;
-      data->wkrep_wkb_generator = wkb_generator;
-      result = Data_Wrap_Struct(klass, mark_factory_func, destroy_factory_func, data);
-    }
-    else {
-      free(data);
+    VALUE wrapped_globals = rb_const_get_at(klass, rb_intern("INTERNAL_CGLOBALS"));
+    data->globals = (RGeo_Globals*)DATA_PTR(wrapped_globals);
+    data->geos_context = data->globals->geos_context;
+    data->flags = NUM2INT(flags);
+    data->srid = NUM2INT(srid);
+    data->buffer_resolution = NUM2INT(buffer_resolution);
+    data->grid_scale = NIL_P(grid_size) ? 0 : 1.0 / rb_num2dbl(grid_size);
+    data->wkrep_wkt_generator = wkt_generator;
+    data->wkrep_wkb_generator = wkb_generator;
+    data->wkt_native_flags = NIL_P(wkt_generator) ? 0 : NUM2INT(wkt_native_flags);
+    data->wkb_native_flags = NIL_P(wkb_generator) ? 0 : NUM2INT(wkb_native_flags);
+    data->stats = NULL;
+    if (data->flags & RGEO_FACTORYFLAGS_COLLECT_STATS) {
+      data->stats = ALLOC(RGeo_FactoryStats);
+      reset_stats(data->stats);
     }
+    result = Data_Wrap_Struct(klass, mark_factory_func, destroy_factory_func, data);
   }
   return result;
 }
@@ -243,6 +768,17 @@ static VALUE cmethod_factory_create(VALUE klass, VALUE flags, VALUE srid, VALUE
 RGeo_Globals* rgeo_init_geos_factory()
 {
   RGeo_Globals* globals = ALLOC(RGeo_Globals);
+  globals->geos_context = initGEOS_r(message_handler, message_handler);
+  globals->wkt_reader = NULL;
+  globals->wkb_reader = NULL;
+  globals->wkt_writer = NULL;
+  globals->wkb_writer = NULL;
+  globals->wkb_native_writer = NULL;
+#ifdef RGEO_GEOS_RELEASES_GVL
+  globals->blocking_contexts = NULL;
+  globals->num_blocking_contexts = 0;
+  globals->blocking_contexts_capacity = 0;
+#endif
   VALUE rgeo_module = rb_define_module("RGeo");
   globals->geos_module = rb_define_module_under(rgeo_module, "Geos");
   globals->feature_module = rb_define_module_under(rgeo_module, "Feature");
@@ -251,10 +787,19 @@ RGeo_Globals* rgeo_init_geos_factory()
   VALUE geos_factory_class = rb_const_get_at(globals->geos_module, rb_intern("Factory"));
   rb_define_method(geos_factory_class, "_parse_wkt_impl", method_factory_parse_wkt, 1);
   rb_define_method(geos_factory_class, "_parse_wkb_impl", method_factory_parse_wkb, 1);
+  rb_define_method(geos_factory_class, "_unmarshal_wkb", method_factory_unmarshal_wkb, 2);
   rb_define_method(geos_factory_class, "_srid", method_factory_srid, 0);
   rb_define_method(geos_factory_class, "_buffer_resolution", method_factory_buffer_resolution, 0);
+  rb_define_method(geos_factory_class, "_grid_size", method_factory_grid_size, 0);
   rb_define_method(geos_factory_class, "_flags", method_factory_flags, 0);
-  rb_define_module_function(geos_factory_class, "_create", cmethod_factory_create, 5);
+  rb_define_method(geos_factory_class, "_stats", method_factory_stats, 0);
+  rb_define_method(geos_factory_class, "_reset_stats", method_factory_reset_stats, 0);
+  rb_define_method(geos_factory_class, "_copy_with_packed_coordinates", method_factory_copy_with_packed_coordinates, 3);
+  rb_define_method(geos_factory_class, "_line_string_from_coords", method_factory_line_string_from_coords, 1);
+  rb_define_method(geos_factory_class, "_linear_ring_from_coords", method_factory_linear_ring_from_coords, 1);
+  rb_define_method(geos_factory_class, "_polygon_from_coords", method_factory_polygon_from_coords, 2);
+  rb_define_method(geos_factory_class, "_multi_point_from_coords", method_factory_multi_point_from_coords, 1);
+  rb_define_module_function(geos_factory_class, "_create", cmethod_factory_create, 8);
   
   // Wrap the globals in a Ruby object and store it off so we have access
   // to it later. Each factory instance will reference it internally.
@@ -326,7 +871,13 @@ VALUE rgeo_wrap_geos_geometry(VALUE factory, GEOSGeometry* geom, VALUE klass)
       data->geos_context = factory_context;
       data->factory = factory;
       data->klasses = klasses;
+      data->prep = factory_data && (factory_data->flags & RGEO_FACTORYFLAGS_PREPARE_HEURISTIC) ?
+        (const GEOSPreparedGeometry*)2 : NULL;
+      data->adopted = 0;
       result = Data_Wrap_Struct(klass, mark_geometry_func, destroy_geometry_func, data);
+      if (factory_data) {
+        RGEO_FACTORY_COUNT(factory_data, allocations);
+      }
     }
   }
   return result;
@@ -337,8 +888,10 @@ VALUE rgeo_wrap_geos_geometry_clone(VALUE factory, const GEOSGeometry* geom, VAL
 {
   VALUE result = Qnil;
   if (geom) {
-    GEOSGeometry* clone_geom = GEOSGeom_clone_r(RGEO_FACTORY_DATA_PTR(factory)->geos_context, geom);
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    GEOSGeometry* clone_geom = GEOSGeom_clone_r(factory_data->geos_context, geom);
     if (clone_geom) {
+      RGEO_FACTORY_COUNT(factory_data, clones);
       result = rgeo_wrap_geos_geometry(factory, clone_geom, klass);
     }
   }
@@ -346,15 +899,26 @@ VALUE rgeo_wrap_geos_geometry_clone(VALUE factory, const GEOSGeometry* geom, VAL
 }
 
 
-const GEOSGeometry* rgeo_convert_to_geos_geometry(VALUE factory, VALUE obj, VALUE type)
+VALUE rgeo_convert_to_geos_object(VALUE factory, VALUE obj, VALUE type)
 {
   VALUE object;
-  if (NIL_P(type) && RGEO_GEOMETRY_DATA_PTR(obj)->factory == factory) {
+  if (NIL_P(type) && rgeo_is_geos_object(obj) && RGEO_GEOMETRY_DATA_PTR(obj)->factory == factory) {
     object = obj;
   }
   else {
-    object = rb_funcall(RGEO_FACTORY_DATA_PTR(factory)->globals->feature_module, rb_intern("cast"), 3, obj, factory, type);
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    if (needs_conversion(obj, factory)) {
+      RGEO_FACTORY_COUNT(factory_data, conversions);
+    }
+    object = rb_funcall(factory_data->globals->feature_module, rb_intern("cast"), 3, obj, factory, type);
   }
+  return object;
+}
+
+
+const GEOSGeometry* rgeo_convert_to_geos_geometry(VALUE factory, VALUE obj, VALUE type)
+{
+  VALUE object = rgeo_convert_to_geos_object(factory, obj, type);
   const GEOSGeometry* geom = NULL;
   if (!NIL_P(object)) {
     geom = RGEO_GEOMETRY_DATA_PTR(object)->geom;
@@ -363,31 +927,162 @@ const GEOSGeometry* rgeo_convert_to_geos_geometry(VALUE factory, VALUE obj, VALU
 }
 
 
+void* rgeo_call_geos_without_gvl(RGeo_FactoryData* factory_data, void* (*func)(GEOSContextHandle_t, void*), void* arg)
+{
+  RGeo_FactoryStats* stats = factory_data->stats;
+  double start_time = stats ? current_time() : 0;
+  void* result;
+#ifdef RGEO_GEOS_RELEASES_GVL
+  GEOSContextHandle_t context = borrow_blocking_context(factory_data->globals);
+  if (context) {
+    RGeo_BlockingCall call;
+    call.context = context;
+    call.func = func;
+    call.arg = arg;
+    call.result = NULL;
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+    rb_thread_call_without_gvl(blocking_call_func, &call, NULL, NULL);
+#else
+    rb_thread_blocking_region(blocking_region_func, &call, NULL, NULL);
+#endif
+    return_blocking_context(factory_data->globals, context);
+    result = call.result;
+  }
+  else {
+    result = func(factory_data->geos_context, arg);
+  }
+#else
+  result = func(factory_data->geos_context, arg);
+#endif
+  if (stats) {
+    ++stats->geos_calls;
+    stats->geos_time += current_time() - start_time;
+  }
+  return result;
+}
+
+
+const GEOSGeometry* rgeo_isolate_geos_geometry(RGeo_FactoryData* factory_data, const GEOSGeometry* geom)
+{
+#ifdef RGEO_GEOS_RELEASES_GVL
+  return geom ? GEOSGeom_clone_r(factory_data->geos_context, geom) : NULL;
+#else
+  return geom;
+#endif
+}
+
+
+void rgeo_release_isolated_geos_geometry(RGeo_FactoryData* factory_data, const GEOSGeometry* geom)
+{
+#ifdef RGEO_GEOS_RELEASES_GVL
+  if (geom) {
+    GEOSGeom_destroy_r(factory_data->geos_context, (GEOSGeometry*)geom);
+  }
+#endif
+}
+
+
+GEOSGeometry* rgeo_snap_geos_geometry(RGeo_FactoryData* factory_data, GEOSGeometry* geom)
+{
+  GEOSGeometry* result = geom;
+  if (geom && factory_data->grid_scale > 0) {
+    GEOSContextHandle_t context = factory_data->geos_context;
+    unsigned int dims = (factory_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z_OR_M) ? 3 : 2;
+    unsigned int index = 0;
+    int count = GEOSGetNumCoordinates_r(context, geom);
+    result = count < 0 ? NULL :
+      copy_with_coords(context, geom, NULL, dims, dims == 3, &index, (unsigned int)count, factory_data->grid_scale);
+    GEOSGeom_destroy_r(context, geom);
+  }
+  return result;
+}
+
+
 GEOSGeometry* rgeo_convert_to_detached_geos_geometry(VALUE obj, VALUE factory, VALUE type, VALUE* klasses)
 {
-  if (klasses) {
-    *klasses = Qnil;
+  RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+  VALUE object;
+  if (needs_conversion(obj, factory)) {
+    RGEO_FACTORY_COUNT(factory_data, conversions);
   }
-  VALUE object = rb_funcall(RGEO_FACTORY_DATA_PTR(factory)->globals->feature_module, rb_intern("cast"), 5, obj, factory, type, ID2SYM(rb_intern("force_new")), ID2SYM(rb_intern("keep_subtype")));
-  GEOSGeometry* geom = NULL;
-  if (!NIL_P(object)) {
-    RGeo_GeometryData* object_data = RGEO_GEOMETRY_DATA_PTR(object);
-    geom = object_data->geom;
-    if (klasses) {
-      *klasses = object_data->klasses;
-      if (NIL_P(*klasses)) {
-        *klasses = CLASS_OF(object);
-      }
-    }
-    object_data->geom = NULL;
-    object_data->geos_context = NULL;
-    object_data->factory = Qnil;
-    object_data->klasses = Qnil;
+  object = rb_funcall(factory_data->globals->feature_module, rb_intern("cast"), 5, obj, factory, type, ID2SYM(rb_intern("force_new")), ID2SYM(rb_intern("keep_subtype")));
+  return detach_geos_geometry(object, klasses);
+}
+
+
+VALUE rgeo_convert_to_adoptable_geos_object(VALUE obj, VALUE factory, VALUE type)
+{
+  RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+  VALUE object;
+  if (needs_conversion(obj, factory)) {
+    RGEO_FACTORY_COUNT(factory_data, conversions);
+  }
+  object = rb_funcall(factory_data->globals->feature_module, rb_intern("cast"), 4, obj, factory, type, ID2SYM(rb_intern("keep_subtype")));
+  if (!rgeo_is_geos_object(object) || !RGEO_GEOMETRY_DATA_PTR(object)->geom) {
+    object = Qnil;
   }
+  return object;
+}
+
+
+GEOSGeometry* rgeo_adopt_geos_geometry(VALUE object, VALUE* klasses)
+{
+  GEOSGeometry* geom = detach_geos_geometry(object, klasses);
+  RGEO_RAW_GEOMETRY_DATA_PTR(object)->adopted = 1;
   return geom;
 }
 
 
+const GEOSPreparedGeometry* rgeo_request_prepared_geometry(RGeo_GeometryData* object_data)
+{
+  const GEOSPreparedGeometry* prep = object_data->prep;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+  if (prep == (const GEOSPreparedGeometry*)1) {
+    prep = NULL;
+    if (object_data->geom) {
+      prep = GEOSPrepare_r(object_data->geos_context, object_data->geom);
+    }
+    object_data->prep = prep;
+  }
+  else if (prep == (const GEOSPreparedGeometry*)2) {
+    object_data->prep = (const GEOSPreparedGeometry*)1;
+    prep = NULL;
+  }
+#else
+  prep = NULL;
+#endif
+  return prep;
+}
+
+
+void rgeo_release_prepared_geometry(RGeo_GeometryData* object_data)
+{
+  const GEOSPreparedGeometry* prep = object_data->prep;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+  if (prep && prep != (const GEOSPreparedGeometry*)1 && prep != (const GEOSPreparedGeometry*)2) {
+    GEOSPreparedGeom_destroy_r(object_data->geos_context, prep);
+  }
+#endif
+  object_data->prep = NULL;
+}
+
+
+double rgeo_snap_coordinate(double value, double grid_scale)
+{
+  return grid_scale > 0 ? floor(value * grid_scale + 0.5) / grid_scale : value;
+}
+
+
+RGeo_GeometryData* rgeo_geometry_data_ptr(VALUE geometry)
+{
+  RGeo_GeometryData* data = RGEO_RAW_GEOMETRY_DATA_PTR(geometry);
+  if (data->adopted) {
+    rb_raise(rb_path2class("RGeo::Error::InvalidGeometry"), "The geometry was adopted by a collection");
+  }
+  return data;
+}
+
+
 char rgeo_is_geos_object(VALUE obj)
 {
   return (TYPE(obj) == T_DATA && RDATA(obj)->dfree == (RUBY_DATA_FUNC)destroy_geometry_func) ? 1 : 0;
@@ -44,12 +44,49 @@
 RGEO_BEGIN_C
 
 
+// Ruby 1.8 does not provide RB_GC_GUARD.
+#ifndef RB_GC_GUARD
+#define RB_GC_GUARD(v) (*(volatile VALUE*)&(v))
+#endif
+
+
 /*
   Per-interpreter globals.
   Most of these are cached references to commonly used classes and modules
   so we don't have to do a lot of constant lookups.
+  
+  The globals also own the GEOS state shared by all factories. The
+  geos_context is used for every call made while holding the ruby
+  interpreter lock; since only one thread can hold the lock at a time,
+  it is never used concurrently. The readers and writers belong to that
+  context and are created lazily. The wkb_native_writer's output
+  dimension and byte order are set by each caller; wkb_writer keeps the
+  GEOS defaults. The shared context outlives every factory and
+  geometry, so it is never finished.
+  
+  Calls made without the interpreter lock (see rgeo_call_geos_without_gvl)
+  each borrow a context of their own from the blocking_contexts pool,
+  which holds num_blocking_contexts idle contexts in an array of size
+  blocking_contexts_capacity. The pool is only touched while holding the
+  interpreter lock, so it needs no mutex, and it grows to the number of
+  concurrent blocking calls. No geometry owned by a ruby object crosses
+  into such a call: each call works on copies made for it with
+  rgeo_isolate_geos_geometry, and on nothing else that another thread
+  can reach. Two blocking calls on the same ruby geometry therefore
+  never share any GEOS state, and need no per-geometry lock either.
 */
 typedef struct {
+  GEOSContextHandle_t geos_context;
+  GEOSWKTReader* wkt_reader;
+  GEOSWKBReader* wkb_reader;
+  GEOSWKTWriter* wkt_writer;
+  GEOSWKBWriter* wkb_writer;
+  GEOSWKBWriter* wkb_native_writer;
+#ifdef RGEO_GEOS_RELEASES_GVL
+  GEOSContextHandle_t* blocking_contexts;
+  unsigned int num_blocking_contexts;
+  unsigned int blocking_contexts_capacity;
+#endif
   VALUE feature_module;
   VALUE feature_geometry;
   VALUE feature_point;
@@ -75,31 +112,85 @@ typedef struct {
 } RGeo_Globals;
 
 
+/*
+  Instrumentation counters for a factory. The geos_calls and geos_time
+  (in seconds) cover GEOS operations dispatched by
+  rgeo_call_geos_without_gvl, such as overlays, buffers, relate and
+  simplification. The conversions count casts of geometries into the
+  factory, clones counts GEOS geometries copied for wrapping,
+  allocations counts wrapped geometry objects created, and callbacks
+  counts calls into ruby WKRep generators. The counters are only
+  updated while holding the ruby interpreter lock.
+*/
+typedef struct {
+  unsigned long geos_calls;
+  double geos_time;
+  unsigned long conversions;
+  unsigned long clones;
+  unsigned long allocations;
+  unsigned long callbacks;
+} RGeo_FactoryStats;
+
+
 /*
   Wrapped structure for Factory objects.
-  A factory encapsulates the GEOS context, and GEOS serializer settings.
-  It also stores the SRID for all geometries created by this factory,
-  and the resolution for buffers created for this factory's geometries.
-  Finally, it provides easy access to the globals.
+  A factory encapsulates the GEOS serializer settings. It also stores the
+  SRID for all geometries created by this factory, and the resolution for
+  buffers created for this factory's geometries. Finally, it provides
+  easy access to the globals.
+  
+  The geos_context is a copy of the shared context in the globals; the
+  factory does not own it. Factories are therefore cheap to create, and
+  all GEOS readers and writers are shared through the globals.
+  
+  The grid_scale is the reciprocal of the factory's grid size, or 0 if
+  coordinates are not snapped to a grid. See rgeo_snap_coordinate.
+  
+  The wkt_native_flags and wkb_native_flags fields describe the
+  configuration of the WKRep generators, if it is one that can be
+  produced natively without calling back into ruby. They are 0 if the
+  generator must be called. See the RGEO_WKTNATIVE_* and
+  RGEO_WKBNATIVE_* flags.
+  
+  The stats are allocated only if the factory was created with the
+  RGEO_FACTORYFLAGS_COLLECT_STATS flag, and are NULL otherwise.
 */
 typedef struct {
   RGeo_Globals* globals;
   GEOSContextHandle_t geos_context;
-  GEOSWKTReader* wkt_reader;
-  GEOSWKBReader* wkb_reader;
-  GEOSWKTWriter* wkt_writer;
-  GEOSWKBWriter* wkb_writer;
   VALUE wkrep_wkt_generator;
   VALUE wkrep_wkb_generator;
+  int wkt_native_flags;
+  int wkb_native_flags;
   int flags;
   int srid;
   int buffer_resolution;
+  double grid_scale;
+  RGeo_FactoryStats* stats;
 } RGeo_FactoryData;
 
 #define RGEO_FACTORYFLAGS_LENIENT_MULTIPOLYGON 1
 #define RGEO_FACTORYFLAGS_SUPPORTS_Z 2
 #define RGEO_FACTORYFLAGS_SUPPORTS_M 4
 #define RGEO_FACTORYFLAGS_SUPPORTS_Z_OR_M 6
+#define RGEO_FACTORYFLAGS_PREPARE_HEURISTIC 8
+#define RGEO_FACTORYFLAGS_COLLECT_STATS 16
+
+#define RGEO_WKTNATIVE_ENABLED 1
+#define RGEO_WKTNATIVE_WKT11_STRICT 2
+#define RGEO_WKTNATIVE_EWKT 4
+#define RGEO_WKTNATIVE_EWKT_SRID 8
+#define RGEO_WKTNATIVE_WKT12 16
+#define RGEO_WKTNATIVE_SQUARE_BRACKETS 32
+#define RGEO_WKTNATIVE_UPPER 64
+#define RGEO_WKTNATIVE_LOWER 128
+
+#define RGEO_WKBNATIVE_ENABLED 1
+#define RGEO_WKBNATIVE_LITTLE_ENDIAN 2
+#define RGEO_WKBNATIVE_HEX 4
+#define RGEO_WKBNATIVE_EWKB 8
+#define RGEO_WKBNATIVE_EWKB_SRID 16
+#define RGEO_WKBNATIVE_WKB12 32
 
 
 /*
@@ -121,21 +212,50 @@ typedef struct {
   factory data. However, one use case is in the destroy_geometry_func
   in factory.c, and Rubinius 1.1.1 seems to crash when you try to
   evaluate a DATA_PTR from that function, so we copy the context handle
-  here so the destroy_geometry_func can get to it.
+  here so the destroy_geometry_func can get to it. It is always the
+  shared context from the globals, so it remains valid even if the
+  factory is collected first.
+  
+  The prep field holds a GEOS prepared geometry built from geom, which
+  speeds up repeated predicate evaluations with this geometry as the
+  receiver. It is built lazily and owned by this structure. Besides a
+  real handle, it can hold one of two small sentinel values: 1 means
+  the geometry has been used once as a predicate receiver and should be
+  prepared on the next use (the "prepare heuristic"), and 2 means the
+  geometry is a candidate for the heuristic but has not been used yet.
+  A value of NULL means preparation happens only when explicitly
+  requested. Use rgeo_request_prepared_geometry to get a usable handle.
+  
+  The adopted flag is set once the geometry has been taken over by a
+  collection (see rgeo_adopt_geos_geometry). An adopted object has no
+  geom, like an uninitialized one, but RGEO_GEOMETRY_DATA_PTR raises
+  for it, so that no method silently works on a geometry it gave away.
 */
 typedef struct {
   GEOSGeometry* geom;
   GEOSContextHandle_t geos_context;
   VALUE factory;
   VALUE klasses;
+  const GEOSPreparedGeometry* prep;
+  char adopted;
 } RGeo_GeometryData;
 
 
 // Returns the RGeo_FactoryData* given a ruby Factory object
 #define RGEO_FACTORY_DATA_PTR(factory) ((RGeo_FactoryData*)DATA_PTR(factory))
 
-// Returns the RGeo_GeometryData* given a ruby Geometry object
-#define RGEO_GEOMETRY_DATA_PTR(geometry) ((RGeo_GeometryData*)DATA_PTR(geometry))
+// Returns the RGeo_GeometryData* given a ruby Geometry object. Raises
+// RGeo::Error::InvalidGeometry if the object's geometry was adopted.
+#define RGEO_GEOMETRY_DATA_PTR(geometry) (rgeo_geometry_data_ptr(geometry))
+
+// Returns the RGeo_GeometryData* given a ruby Geometry object, even if
+// its geometry was adopted
+#define RGEO_RAW_GEOMETRY_DATA_PTR(geometry) ((RGeo_GeometryData*)DATA_PTR(geometry))
+
+// Increments the given stats counter of a RGeo_FactoryData*, if the
+// factory collects stats
+#define RGEO_FACTORY_COUNT(factory_data, counter) \
+  do { if ((factory_data)->stats) { ++(factory_data)->stats->counter; } } while (0)
 
 
 /*
@@ -174,6 +294,53 @@ VALUE rgeo_wrap_geos_geometry_clone(VALUE factory, const GEOSGeometry* geom, VAL
 */
 const GEOSGeometry* rgeo_convert_to_geos_geometry(VALUE factory, VALUE obj, VALUE type);
 
+/*
+  Same as rgeo_convert_to_geos_geometry except that it returns the ruby
+  object holding the GEOS geometry rather than the geometry itself, or
+  Qnil if the conversion failed. This is either the given object or the
+  result of casting it. Use this when you need to keep a cast object
+  alive (e.g. with RB_GC_GUARD) while using its GEOS geometry, such as
+  across a call to rgeo_call_geos_without_gvl.
+*/
+VALUE rgeo_convert_to_geos_object(VALUE factory, VALUE obj, VALUE type);
+
+/*
+  Calls the given function with the given argument, passing it a GEOS
+  context it may use for the duration of the call. If supported, the
+  call is made with the ruby interpreter lock released, so other ruby
+  threads can run in the mean time, using a context borrowed from the
+  blocking context pool. Otherwise, it is made normally with the shared
+  context. Returns the function's return value.
+  
+  The function runs without the interpreter lock, so it must not call
+  any ruby API functions, and it must not rely on ruby objects that are
+  not otherwise kept alive by the caller. It may call GEOS functions
+  using the context it is given. Generally, you should gather all your
+  inputs before making this call, and wrap any GEOS results afterward.
+  Any GEOS geometry passed in the argument should come from
+  rgeo_isolate_geos_geometry rather than being borrowed from a ruby
+  object, since other threads may read, detach, or destroy the geometry
+  of a ruby object while the call runs.
+*/
+void* rgeo_call_geos_without_gvl(RGeo_FactoryData* factory_data, void* (*func)(GEOSContextHandle_t, void*), void* arg);
+
+/*
+  Returns a GEOS geometry that a call made with rgeo_call_geos_without_gvl
+  may use as an input, given a geometry owned by a ruby object of the
+  given factory. When calls are made without the interpreter lock, this
+  is a clone private to the call. Otherwise, it is the given geometry.
+  Returns NULL if the given geometry is NULL or could not be cloned.
+  Release the result with rgeo_release_isolated_geos_geometry once the
+  call has returned.
+*/
+const GEOSGeometry* rgeo_isolate_geos_geometry(RGeo_FactoryData* factory_data, const GEOSGeometry* geom);
+
+/*
+  Releases a geometry returned by rgeo_isolate_geos_geometry. Does
+  nothing if given NULL.
+*/
+void rgeo_release_isolated_geos_geometry(RGeo_FactoryData* factory_data, const GEOSGeometry* geom);
+
 /*
   Gets a GEOS geometry for a given ruby Geometry object. You must provide
   a GEOS factory for the geometry; the object is cast to that factory if
@@ -192,6 +359,65 @@ const GEOSGeometry* rgeo_convert_to_geos_geometry(VALUE factory, VALUE obj, VALU
 */
 GEOSGeometry* rgeo_convert_to_detached_geos_geometry(VALUE obj, VALUE factory, VALUE type, VALUE* klasses);
 
+/*
+  Casts the given object to a GEOS geometry of the given factory, and
+  optionally to a type, for use with rgeo_adopt_geos_geometry. Unlike
+  rgeo_convert_to_detached_geos_geometry, this does not copy an object
+  that is already of the desired factory and type; it returns the object
+  itself. Returns Qnil if the conversion failed or the result is
+  uninitialized. Raises RGeo::Error::InvalidGeometry if the object's
+  geometry was already adopted.
+*/
+VALUE rgeo_convert_to_adoptable_geos_object(VALUE obj, VALUE factory, VALUE type);
+
+/*
+  Takes over the GEOS geometry of the given ruby object, which should
+  come from rgeo_convert_to_adoptable_geos_object. Ownership moves to the
+  caller, and the object is marked as adopted; any later use of it raises
+  RGeo::Error::InvalidGeometry, and initialized? returns false. The
+  klasses parameter works as for rgeo_convert_to_detached_geos_geometry.
+  
+  Nothing else may hold on to the geometry: call this only once the
+  geometry is certain to be used, and only once per object.
+*/
+GEOSGeometry* rgeo_adopt_geos_geometry(VALUE object, VALUE* klasses);
+
+/*
+  Returns a prepared version of the given geometry's GEOS geometry, for
+  use by the GEOSPrepared predicates. Depending on the state of the prep
+  field described above, this may build and cache the prepared geometry,
+  or it may just advance the prepare heuristic and return NULL, in which
+  case you should fall back to the ordinary (non-prepared) predicate.
+  The returned handle is owned by the geometry data.
+*/
+const GEOSPreparedGeometry* rgeo_request_prepared_geometry(RGeo_GeometryData* object_data);
+
+/*
+  Destroys the prepared geometry (if any) held by the given geometry
+  data, and resets the prep field to NULL. Call this before detaching or
+  replacing the underlying GEOS geometry.
+*/
+void rgeo_release_prepared_geometry(RGeo_GeometryData* object_data);
+
+/*
+  Returns a copy of the given geometry whose x and y coordinates are
+  snapped to the factory's grid (see rgeo_snap_coordinate), and destroys
+  the original. Returns the geometry itself if the factory has no grid,
+  and NULL if the copy fails. This is used on geometries that did not
+  come from coordinates, such as those read by the GEOS WKT and WKB
+  readers.
+*/
+GEOSGeometry* rgeo_snap_geos_geometry(RGeo_FactoryData* factory_data, GEOSGeometry* geom);
+
+/*
+  Snaps a coordinate value to a grid whose spacing is the reciprocal of
+  the given grid_scale, rounding halves up. Returns the value unchanged
+  if grid_scale is 0. Factories snap the x and y coordinates of every
+  geometry they build from coordinates, parse, or cast from another
+  factory this way.
+*/
+double rgeo_snap_coordinate(double value, double grid_scale);
+
 /*
   Returns 1 if the given ruby object is a GEOS Geometry implementation,
   or 0 if not.
@@ -204,6 +430,11 @@ char rgeo_is_geos_object(VALUE obj);
 */
 const GEOSGeometry* rgeo_get_geos_geometry_safe(VALUE obj);
 
+/*
+  Implements RGEO_GEOMETRY_DATA_PTR.
+*/
+RGeo_GeometryData* rgeo_geometry_data_ptr(VALUE geometry);
+
 /*
   Compares the coordinate sequences for two given GEOS geometries.
   The two given geometries MUST be of types backed directly by
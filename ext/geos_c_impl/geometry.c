@@ -39,7 +39,10 @@
 
 #ifdef RGEO_GEOS_SUPPORTED
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <ruby.h>
 #include <geos_c.h>
 
@@ -101,12 +104,1030 @@ static int compute_dimension(GEOSContextHandle_t context, const GEOSGeometry* ge
 }
 
 
+// Copies the coordinates of the given geometry, in order, into buf,
+// using dims (2 or 3) doubles per coordinate. Rings of a polygon are
+// visited exterior ring first, and collections are visited depth first.
+// Writes at most count coordinates, and returns the number written.
+
+static unsigned int copy_coords(GEOSContextHandle_t context, const GEOSGeometry* geom, double* buf, unsigned int dims, unsigned int count)
+{
+  unsigned int written = 0;
+  int i, n;
+  switch (GEOSGeomTypeId_r(context, geom)) {
+  case GEOS_POINT:
+  case GEOS_LINESTRING:
+  case GEOS_LINEARRING:
+    {
+      const GEOSCoordSequence* coord_seq = GEOSGeom_getCoordSeq_r(context, geom);
+      unsigned int size, j;
+      if (coord_seq && GEOSCoordSeq_getSize_r(context, coord_seq, &size)) {
+        for (j=0; j<size && written<count; ++j, ++written) {
+          double* coord = buf + written * dims;
+          GEOSCoordSeq_getX_r(context, coord_seq, j, coord);
+          GEOSCoordSeq_getY_r(context, coord_seq, j, coord + 1);
+          if (dims == 3) {
+            GEOSCoordSeq_getZ_r(context, coord_seq, j, coord + 2);
+          }
+        }
+      }
+    }
+    break;
+  case GEOS_POLYGON:
+    {
+      const GEOSGeometry* ring = GEOSGetExteriorRing_r(context, geom);
+      if (ring) {
+        written += copy_coords(context, ring, buf, dims, count);
+      }
+      n = GEOSGetNumInteriorRings_r(context, geom);
+      for (i=0; i<n; ++i) {
+        ring = GEOSGetInteriorRingN_r(context, geom, i);
+        if (ring) {
+          written += copy_coords(context, ring, buf + written * dims, dims, count - written);
+        }
+      }
+    }
+    break;
+  case GEOS_MULTIPOINT:
+  case GEOS_MULTILINESTRING:
+  case GEOS_MULTIPOLYGON:
+  case GEOS_GEOMETRYCOLLECTION:
+    n = GEOSGetNumGeometries_r(context, geom);
+    for (i=0; i<n; ++i) {
+      const GEOSGeometry* elem = GEOSGetGeometryN_r(context, geom, i);
+      if (elem) {
+        written += copy_coords(context, elem, buf + written * dims, dims, count - written);
+      }
+    }
+    break;
+  }
+  return written;
+}
+
+
+// Returns the coordinates of the given geometry as a String of packed
+// doubles, with dims (2 or 3) doubles per coordinate. See copy_coords.
+
+static VALUE packed_coords_for(RGeo_GeometryData* data, unsigned int dims)
+{
+  VALUE result = Qnil;
+  GEOSContextHandle_t context = data->geos_context;
+  int count = GEOSGetNumCoordinates_r(context, data->geom);
+  if (count >= 0) {
+    result = rb_str_new(NULL, count * dims * sizeof(double));
+    count = copy_coords(context, data->geom, (double*)RSTRING_PTR(result), dims, count);
+    if ((long)(count * dims * sizeof(double)) != RSTRING_LEN(result)) {
+      result = rb_str_resize(result, count * dims * sizeof(double));
+    }
+  }
+  return result;
+}
+
+
+// Returns the number of coordinate values per point for the geometry's
+// factory: 3 if it has a Z or M coordinate, otherwise 2.
+
+static unsigned int factory_coord_dims(RGeo_GeometryData* data)
+{
+  return (RGEO_FACTORY_DATA_PTR(data->factory)->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z_OR_M) ? 3 : 2;
+}
+
+
+// Returns the coordinate bounds of the geometry as an array of the
+// minimum and maximum of each of the factory's coordinate dimensions in
+// turn, or nil if the geometry has no coordinates. This scans the packed
+// coordinates directly without creating any point objects.
+
+static VALUE coord_bounds_for(RGeo_GeometryData* data)
+{
+  VALUE result = Qnil;
+  unsigned int dims = factory_coord_dims(data);
+  VALUE packed = packed_coords_for(data, dims);
+  if (!NIL_P(packed)) {
+    long len = RSTRING_LEN(packed) / sizeof(double);
+    const double* buf = (const double*)RSTRING_PTR(packed);
+    if (len >= (long)dims) {
+      unsigned int d;
+      long i;
+      result = rb_ary_new2(dims * 2);
+      for (d=0; d<dims; ++d) {
+        double lo = buf[d];
+        double hi = lo;
+        for (i=d+dims; i<len; i+=dims) {
+          double v = buf[i];
+          if (v < lo) lo = v;
+          if (v > hi) hi = v;
+        }
+        rb_ary_push(result, rb_float_new(lo));
+        rb_ary_push(result, rb_float_new(hi));
+      }
+    }
+  }
+  RB_GC_GUARD(packed);
+  return result;
+}
+
+
+// State for the native WKT writer. This writer walks the GEOS
+// coordinate sequences directly, but produces the same output as
+// RGeo::WKRep::WKTGenerator configured with the given native flags.
+
+typedef struct {
+  GEOSContextHandle_t context;
+  VALUE str;
+  int flags;
+  int support_z;
+  int support_m;
+  int srid;
+  const char* begin_bracket;
+  const char* end_bracket;
+} RGeo_WKTWriterState;
+
+
+// Appends the given value formatted the same way as Float#to_s: the
+// shortest digit string that reads back as the same value, in fixed
+// notation unless the exponent is large or small, and with at least one
+// digit after the decimal point.
+
+static void wkt_append_double(VALUE str, double val)
+{
+  char buf[32];
+  char digits[20];
+  char out[40];
+  char* ptr;
+  char* optr;
+  int prec, decpt, ndigits, i;
+  if (isnan(val)) {
+    rb_str_buf_cat2(str, "NaN");
+    return;
+  }
+  if (isinf(val)) {
+    rb_str_buf_cat2(str, val < 0 ? "-Infinity" : "Infinity");
+    return;
+  }
+  if (val == 0.0) {
+    rb_str_buf_cat2(str, signbit(val) ? "-0.0" : "0.0");
+    return;
+  }
+  for (prec=0; prec<17; ++prec) {
+    snprintf(buf, sizeof(buf), "%.*e", prec, val);
+    if (strtod(buf, NULL) == val) {
+      break;
+    }
+  }
+  ptr = buf;
+  optr = out;
+  if (*ptr == '-') {
+    *optr++ = '-';
+    ++ptr;
+  }
+  ndigits = 0;
+  for (; *ptr && *ptr != 'e'; ++ptr) {
+    if (*ptr != '.') {
+      digits[ndigits++] = *ptr;
+    }
+  }
+  decpt = atoi(ptr + 1) + 1;
+  while (ndigits > 1 && digits[ndigits-1] == '0') {
+    --ndigits;
+  }
+  if (decpt > 0 && (decpt < ndigits || decpt <= 15)) {
+    for (i=0; i<decpt; ++i) {
+      *optr++ = i < ndigits ? digits[i] : '0';
+    }
+    *optr++ = '.';
+    if (ndigits > decpt) {
+      for (i=decpt; i<ndigits; ++i) {
+        *optr++ = digits[i];
+      }
+    }
+    else {
+      *optr++ = '0';
+    }
+    *optr = 0;
+  }
+  else if (decpt <= 0 && decpt > -4) {
+    *optr++ = '0';
+    *optr++ = '.';
+    for (i=0; i<-decpt; ++i) {
+      *optr++ = '0';
+    }
+    for (i=0; i<ndigits; ++i) {
+      *optr++ = digits[i];
+    }
+    *optr = 0;
+  }
+  else {
+    *optr++ = digits[0];
+    *optr++ = '.';
+    if (ndigits > 1) {
+      for (i=1; i<ndigits; ++i) {
+        *optr++ = digits[i];
+      }
+    }
+    else {
+      *optr++ = '0';
+    }
+    snprintf(optr, sizeof(out) - (optr - out), "e%+03d", decpt - 1);
+  }
+  rb_str_buf_cat2(str, out);
+}
+
+
+static void wkt_append_coords(RGeo_WKTWriterState* state, const GEOSCoordSequence* coord_seq, unsigned int i)
+{
+  double val;
+  GEOSCoordSeq_getX_r(state->context, coord_seq, i, &val);
+  wkt_append_double(state->str, val);
+  rb_str_buf_cat(state->str, " ", 1);
+  GEOSCoordSeq_getY_r(state->context, coord_seq, i, &val);
+  wkt_append_double(state->str, val);
+  if (state->support_z || state->support_m) {
+    GEOSCoordSeq_getZ_r(state->context, coord_seq, i, &val);
+    rb_str_buf_cat(state->str, " ", 1);
+    wkt_append_double(state->str, val);
+  }
+}
+
+
+// Appends a point body. Returns 0 if the point is empty, since the
+// generator's output for an empty point cannot be reproduced.
+
+static int wkt_append_point(RGeo_WKTWriterState* state, const GEOSGeometry* geom)
+{
+  unsigned int size;
+  const GEOSCoordSequence* coord_seq = GEOSGeom_getCoordSeq_r(state->context, geom);
+  if (!coord_seq || !GEOSCoordSeq_getSize_r(state->context, coord_seq, &size) || size == 0) {
+    return 0;
+  }
+  rb_str_buf_cat2(state->str, state->begin_bracket);
+  wkt_append_coords(state, coord_seq, 0);
+  rb_str_buf_cat2(state->str, state->end_bracket);
+  return 1;
+}
+
+
+static int wkt_append_line_string(RGeo_WKTWriterState* state, const GEOSGeometry* geom)
+{
+  unsigned int size, i;
+  const GEOSCoordSequence* coord_seq = GEOSGeom_getCoordSeq_r(state->context, geom);
+  if (!coord_seq || !GEOSCoordSeq_getSize_r(state->context, coord_seq, &size)) {
+    return 0;
+  }
+  if (size == 0) {
+    rb_str_buf_cat2(state->str, "EMPTY");
+  }
+  else {
+    rb_str_buf_cat2(state->str, state->begin_bracket);
+    for (i=0; i<size; ++i) {
+      if (i > 0) {
+        rb_str_buf_cat(state->str, ", ", 2);
+      }
+      wkt_append_coords(state, coord_seq, i);
+    }
+    rb_str_buf_cat2(state->str, state->end_bracket);
+  }
+  return 1;
+}
+
+
+static int wkt_append_polygon(RGeo_WKTWriterState* state, const GEOSGeometry* geom)
+{
+  int i, n;
+  if (GEOSisEmpty_r(state->context, geom)) {
+    rb_str_buf_cat2(state->str, "EMPTY");
+    return 1;
+  }
+  const GEOSGeometry* ring = GEOSGetExteriorRing_r(state->context, geom);
+  if (!ring) {
+    return 0;
+  }
+  rb_str_buf_cat2(state->str, state->begin_bracket);
+  if (!wkt_append_line_string(state, ring)) {
+    return 0;
+  }
+  n = GEOSGetNumInteriorRings_r(state->context, geom);
+  for (i=0; i<n; ++i) {
+    ring = GEOSGetInteriorRingN_r(state->context, geom, i);
+    rb_str_buf_cat(state->str, ", ", 2);
+    if (!ring || !wkt_append_line_string(state, ring)) {
+      return 0;
+    }
+  }
+  rb_str_buf_cat2(state->str, state->end_bracket);
+  return 1;
+}
+
+
+// Appends a tagged feature. The ruby object is needed to determine the
+// tag, and to obtain geometry collection elements. Returns 0 if the
+// geometry cannot be written natively.
+
+static int wkt_append_feature(RGeo_WKTWriterState* state, VALUE obj, const GEOSGeometry* geom, int toplevel)
+{
+  int i, n, type_id;
+  char buf[32];
+  VALUE tag = rb_funcall(rb_funcall(obj, rb_intern("geometry_type"), 0), rb_intern("type_name"), 0);
+  if (state->flags & RGEO_WKTNATIVE_EWKT) {
+    if (toplevel && (state->flags & RGEO_WKTNATIVE_EWKT_SRID)) {
+      snprintf(buf, sizeof(buf), "SRID=%d;", state->srid);
+      rb_str_buf_cat2(state->str, buf);
+    }
+    rb_str_append(state->str, tag);
+    if (state->support_m && !state->support_z) {
+      rb_str_buf_cat(state->str, "M", 1);
+    }
+  }
+  else {
+    rb_str_append(state->str, tag);
+    if (state->flags & RGEO_WKTNATIVE_WKT12) {
+      if (state->support_z) {
+        rb_str_buf_cat2(state->str, state->support_m ? " ZM" : " Z");
+      }
+      else if (state->support_m) {
+        rb_str_buf_cat2(state->str, " M");
+      }
+    }
+  }
+  rb_str_buf_cat(state->str, " ", 1);
+  type_id = GEOSGeomTypeId_r(state->context, geom);
+  switch (type_id) {
+  case GEOS_POINT:
+    return wkt_append_point(state, geom);
+  case GEOS_LINESTRING:
+  case GEOS_LINEARRING:
+    return wkt_append_line_string(state, geom);
+  case GEOS_POLYGON:
+    return wkt_append_polygon(state, geom);
+  case GEOS_MULTIPOINT:
+  case GEOS_MULTILINESTRING:
+  case GEOS_MULTIPOLYGON:
+  case GEOS_GEOMETRYCOLLECTION:
+    if (GEOSisEmpty_r(state->context, geom)) {
+      rb_str_buf_cat2(state->str, "EMPTY");
+      return 1;
+    }
+    rb_str_buf_cat2(state->str, state->begin_bracket);
+    n = GEOSGetNumGeometries_r(state->context, geom);
+    for (i=0; i<n; ++i) {
+      const GEOSGeometry* elem = GEOSGetGeometryN_r(state->context, geom, i);
+      int success = 0;
+      if (i > 0) {
+        rb_str_buf_cat(state->str, ", ", 2);
+      }
+      if (elem) {
+        switch (type_id) {
+        case GEOS_MULTIPOINT:
+          success = wkt_append_point(state, elem);
+          break;
+        case GEOS_MULTILINESTRING:
+          success = wkt_append_line_string(state, elem);
+          break;
+        case GEOS_MULTIPOLYGON:
+          success = wkt_append_polygon(state, elem);
+          break;
+        default:
+          {
+            VALUE elem_obj = rb_funcall(obj, rb_intern("geometry_n"), 1, INT2NUM(i));
+            const GEOSGeometry* elem_geom = rgeo_get_geos_geometry_safe(elem_obj);
+            success = elem_geom && wkt_append_feature(state, elem_obj, elem_geom, 0);
+          }
+          break;
+        }
+      }
+      if (!success) {
+        return 0;
+      }
+    }
+    rb_str_buf_cat2(state->str, state->end_bracket);
+    return 1;
+  }
+  return 0;
+}
+
+
+// Generates WKT natively, or returns Qnil if the geometry cannot be
+// written natively.
+
+static VALUE generate_wkt_natively(VALUE self, RGeo_FactoryData* factory_data, const GEOSGeometry* geom)
+{
+  RGeo_WKTWriterState state;
+  int flags = factory_data->wkt_native_flags;
+  state.context = factory_data->geos_context;
+  state.str = rb_str_buf_new(64);
+  state.flags = flags;
+  state.support_z = 0;
+  state.support_m = 0;
+  if (!(flags & RGEO_WKTNATIVE_WKT11_STRICT)) {
+    state.support_z = (factory_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z) != 0;
+    state.support_m = (factory_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_M) != 0;
+  }
+  state.srid = factory_data->srid;
+  state.begin_bracket = (flags & RGEO_WKTNATIVE_SQUARE_BRACKETS) ? "[" : "(";
+  state.end_bracket = (flags & RGEO_WKTNATIVE_SQUARE_BRACKETS) ? "]" : ")";
+  VALUE result = Qnil;
+  if (wkt_append_feature(&state, self, geom, 1)) {
+    result = state.str;
+    if (flags & RGEO_WKTNATIVE_UPPER) {
+      result = rb_funcall(result, rb_intern("upcase"), 0);
+    }
+    else if (flags & RGEO_WKTNATIVE_LOWER) {
+      result = rb_funcall(result, rb_intern("downcase"), 0);
+    }
+  }
+  return result;
+}
+
+
+// Returns the shared native GEOS WKB writer, configured for the given
+// output dimension and byte order (1 for little endian), creating it if
+// necessary. Returns NULL if the writer could not be created.
+
+static GEOSWKBWriter* native_wkb_writer(RGeo_Globals* globals, GEOSContextHandle_t context, int dims, int byte_order)
+{
+  GEOSWKBWriter* wkb_writer = globals->wkb_native_writer;
+  if (!wkb_writer) {
+    wkb_writer = GEOSWKBWriter_create_r(context);
+    if (wkb_writer) {
+      GEOSWKBWriter_setIncludeSRID_r(context, wkb_writer, 0);
+      globals->wkb_native_writer = wkb_writer;
+    }
+  }
+  if (wkb_writer) {
+    GEOSWKBWriter_setOutputDimension_r(context, wkb_writer, dims);
+    GEOSWKBWriter_setByteOrder_r(context, wkb_writer, byte_order);
+  }
+  return wkb_writer;
+}
+
+
+static unsigned int wkb_get_uint(const unsigned char* ptr, int little_endian)
+{
+  if (little_endian) {
+    return ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | ((unsigned int)ptr[3] << 24);
+  }
+  return ((unsigned int)ptr[0] << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3];
+}
+
+
+static void wkb_put_uint(unsigned char* ptr, unsigned int value, int little_endian)
+{
+  int i;
+  for (i=0; i<4; ++i) {
+    ptr[little_endian ? i : 3 - i] = (value >> (i * 8)) & 0xff;
+  }
+}
+
+
+// Skips a point count and the given number of points of the GEOS WKB at
+// buf[*pos]. Returns 0 if the data is truncated.
+
+static int wkb_skip_points(const unsigned char* buf, size_t size, size_t* pos, int little_endian, unsigned int dims)
+{
+  unsigned int count;
+  if (*pos + 4 > size) {
+    return 0;
+  }
+  count = wkb_get_uint(buf + *pos, little_endian);
+  *pos += 4;
+  if (count > (size - *pos) / (dims * sizeof(double))) {
+    return 0;
+  }
+  *pos += count * dims * sizeof(double);
+  return 1;
+}
+
+
+// Rewrites in place the type codes of the GEOS WKB feature at buf[*pos]
+// and of all its elements, adding the given offset and OR-ing in the
+// given mask, and advances *pos past the feature. GEOS writes only the
+// base type code plus its own Z flag, which is checked against the
+// expected dims. Returns 0 if the data is not as expected.
+
+static int wkb_rewrite_type_codes(unsigned char* buf, size_t size, size_t* pos, int little_endian,
+  unsigned int dims, unsigned int offset, unsigned int mask)
+{
+  unsigned int type_code, count, i;
+  if (*pos + 5 > size || buf[*pos] != (little_endian ? 1 : 0)) {
+    return 0;
+  }
+  type_code = wkb_get_uint(buf + *pos + 1, little_endian);
+  if ((type_code & 0x7fffffff) < 1 || (type_code & 0x7fffffff) > 7 || ((type_code & 0x80000000) != 0) != (dims == 3)) {
+    return 0;
+  }
+  type_code &= 0x7fffffff;
+  wkb_put_uint(buf + *pos + 1, (type_code + offset) | mask, little_endian);
+  *pos += 5;
+  switch (type_code) {
+  case 1:
+    if (*pos + dims * sizeof(double) > size) {
+      return 0;
+    }
+    *pos += dims * sizeof(double);
+    return 1;
+  case 2:
+    return wkb_skip_points(buf, size, pos, little_endian, dims);
+  case 3:
+    if (*pos + 4 > size) {
+      return 0;
+    }
+    count = wkb_get_uint(buf + *pos, little_endian);
+    *pos += 4;
+    for (i=0; i<count; ++i) {
+      if (!wkb_skip_points(buf, size, pos, little_endian, dims)) {
+        return 0;
+      }
+    }
+    return 1;
+  default:
+    if (*pos + 4 > size) {
+      return 0;
+    }
+    count = wkb_get_uint(buf + *pos, little_endian);
+    *pos += 4;
+    for (i=0; i<count; ++i) {
+      if (!wkb_rewrite_type_codes(buf, size, pos, little_endian, dims, offset, mask)) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+}
+
+
+// Generates WKB using the shared native GEOS WKB writer, configured to
+// match the factory's WKRep generator. GEOS writes only plain type codes
+// (with its own Z flag) and no SRID, so for EWKB and WKB12 output the
+// type codes are rewritten to the generator's format, and the EWKB SRID
+// is inserted after the top-level type code. Returns Qnil if the writer
+// fails or its output is not as expected.
+
+static VALUE generate_wkb_natively(RGeo_FactoryData* factory_data, const GEOSGeometry* geom)
+{
+  static const char hex_digits[] = "0123456789abcdef";
+  VALUE result = Qnil;
+  int flags = factory_data->wkb_native_flags;
+  int little_endian = (flags & RGEO_WKBNATIVE_LITTLE_ENDIAN) != 0;
+  int has_z = (factory_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_Z) != 0;
+  int has_m = (factory_data->flags & RGEO_FACTORYFLAGS_SUPPORTS_M) != 0;
+  unsigned int dims = 2;
+  unsigned int offset = 0;
+  unsigned int mask = 0;
+  int emit_srid = (flags & RGEO_WKBNATIVE_EWKB_SRID) != 0;
+  GEOSContextHandle_t context = factory_data->geos_context;
+  if (flags & RGEO_WKBNATIVE_EWKB) {
+    if (has_z) {
+      mask |= 0x80000000;
+    }
+    if (has_m) {
+      mask |= 0x40000000;
+    }
+  }
+  else if (flags & RGEO_WKBNATIVE_WKB12) {
+    if (has_z) {
+      offset += 1000;
+    }
+    if (has_m) {
+      offset += 2000;
+    }
+  }
+  if (mask || offset) {
+    dims = 3;
+  }
+  GEOSWKBWriter* wkb_writer = native_wkb_writer(factory_data->globals, context, dims, little_endian);
+  if (wkb_writer) {
+    size_t size, i, pos = 0;
+    unsigned char* str = GEOSWKBWriter_write_r(context, wkb_writer, geom, &size);
+    if (str) {
+      if (size >= 5 && (!(mask || offset || emit_srid) ||
+        (wkb_rewrite_type_codes(str, size, &pos, little_endian, dims, offset, mask) && pos == size))) {
+        unsigned char header[9];
+        size_t header_size = emit_srid ? 9 : 5;
+        memcpy(header, str, 5);
+        if (emit_srid) {
+          wkb_put_uint(header + 1, wkb_get_uint(str + 1, little_endian) | 0x20000000, little_endian);
+          wkb_put_uint(header + 5, (unsigned int)GEOSGetSRID_r(context, geom), little_endian);
+        }
+        if (flags & RGEO_WKBNATIVE_HEX) {
+          result = rb_str_new(NULL, (header_size + size - 5) * 2);
+          char* ptr = RSTRING_PTR(result);
+          for (i=0; i<header_size + size - 5; ++i) {
+            unsigned char byte = i < header_size ? header[i] : str[i - header_size + 5];
+            ptr[i*2] = hex_digits[byte >> 4];
+            ptr[i*2+1] = hex_digits[byte & 0xf];
+          }
+        }
+        else {
+          result = rb_str_new((char*)header, header_size);
+          rb_str_cat(result, (char*)str + 5, size - 5);
+        }
+      }
+      GEOSFree_r(context, str);
+    }
+  }
+  return result;
+}
+
+
+// Arguments and results for GEOS operations that are run with the
+// interpreter lock released. See rgeo_call_geos_without_gvl.
+
+typedef struct {
+  const GEOSGeometry* geom1;
+  const GEOSGeometry* geom2;
+  double distance;
+  int resolution;
+  const char* pattern;
+  char result;
+} RGeo_GeosOperation;
+
+
+static void* buffer_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSBuffer_r(context, op->geom1, op->distance, op->resolution);
+}
+
+
+static void* simplify_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSSimplify_r(context, op->geom1, op->distance);
+}
+
+
+static void* topology_preserve_simplify_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSTopologyPreserveSimplify_r(context, op->geom1, op->distance);
+}
+
+
+static void* intersection_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSIntersection_r(context, op->geom1, op->geom2);
+}
+
+
+static void* union_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSUnion_r(context, op->geom1, op->geom2);
+}
+
+
+static void* difference_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSDifference_r(context, op->geom1, op->geom2);
+}
+
+
+static void* sym_difference_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  return GEOSSymDifference_r(context, op->geom1, op->geom2);
+}
+
+
+static void* relate_pattern_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosOperation* op = (RGeo_GeosOperation*)arg;
+  op->result = GEOSRelatePattern_r(context, op->geom1, op->geom2, op->pattern);
+  return NULL;
+}
+
+
+// Runs a binary overlay operation on self and rhs without the interpreter
+// lock, and wraps the result. The operation works on isolated copies of
+// both inputs, since other threads may use the originals meanwhile.
+
+static VALUE overlay_without_gvl(VALUE self, VALUE rhs, void* (*func)(GEOSContextHandle_t, void*))
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  const GEOSGeometry* self_geom = self_data->geom;
+  if (self_geom) {
+    VALUE factory = self_data->factory;
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(factory, rhs, Qnil);
+    if (rhs_geom) {
+      RGeo_GeosOperation op;
+      op.geom1 = rgeo_isolate_geos_geometry(factory_data, self_geom);
+      op.geom2 = rgeo_isolate_geos_geometry(factory_data, rhs_geom);
+      GEOSGeometry* geom = NULL;
+      if (op.geom1 && op.geom2) {
+        geom = (GEOSGeometry*)rgeo_call_geos_without_gvl(factory_data, func, &op);
+      }
+      rgeo_release_isolated_geos_geometry(factory_data, op.geom1);
+      rgeo_release_isolated_geos_geometry(factory_data, op.geom2);
+      result = rgeo_wrap_geos_geometry(factory, geom, Qnil);
+    }
+  }
+  return result;
+}
+
+
+// Predicates supported by the batch methods.
+
+#define RGEO_BATCH_INTERSECTS 1
+#define RGEO_BATCH_DISJOINT 2
+#define RGEO_BATCH_CONTAINS 3
+#define RGEO_BATCH_WITHIN 4
+#define RGEO_BATCH_TOUCHES 5
+#define RGEO_BATCH_CROSSES 6
+#define RGEO_BATCH_OVERLAPS 7
+
+
+// Arguments and results for a batch operation, which evaluates one
+// receiver geometry against many others. It is run with the interpreter
+// lock released, so the receiver and others are isolated copies (see
+// rgeo_isolate_geos_geometry). The results array gets one predicate
+// result (0, 1, or 2 for an exception) per geometry, or the distances
+// array gets one distance per geometry.
+
+typedef struct {
+  const GEOSGeometry* geom;
+  const GEOSGeometry** others;
+  unsigned int count;
+  int predicate;
+  char* results;
+  double* distances;
+  char failed;
+} RGeo_GeosBatchOperation;
+
+
+// Evaluates a batch predicate for one pair, using the prepared
+// geometry if given and supported for the predicate.
+
+static char batch_predicate(GEOSContextHandle_t context, int predicate,
+  const GEOSGeometry* geom, const GEOSPreparedGeometry* prep, const GEOSGeometry* other)
+{
+  switch (predicate) {
+  case RGEO_BATCH_INTERSECTS:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+    if (prep) return GEOSPreparedIntersects_r(context, prep, other);
+#endif
+    return GEOSIntersects_r(context, geom, other);
+  case RGEO_BATCH_CONTAINS:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+    if (prep) return GEOSPreparedContains_r(context, prep, other);
+#endif
+    return GEOSContains_r(context, geom, other);
+  case RGEO_BATCH_DISJOINT:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+    if (prep) return GEOSPreparedDisjoint_r(context, prep, other);
+#endif
+    return GEOSDisjoint_r(context, geom, other);
+  case RGEO_BATCH_WITHIN:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+    if (prep) return GEOSPreparedWithin_r(context, prep, other);
+#endif
+    return GEOSWithin_r(context, geom, other);
+  case RGEO_BATCH_TOUCHES:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+    if (prep) return GEOSPreparedTouches_r(context, prep, other);
+#endif
+    return GEOSTouches_r(context, geom, other);
+  case RGEO_BATCH_CROSSES:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+    if (prep) return GEOSPreparedCrosses_r(context, prep, other);
+#endif
+    return GEOSCrosses_r(context, geom, other);
+  case RGEO_BATCH_OVERLAPS:
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+    if (prep) return GEOSPreparedOverlaps_r(context, prep, other);
+#endif
+    return GEOSOverlaps_r(context, geom, other);
+  }
+  return 2;
+}
+
+
+// Runs a batch predicate. A prepared geometry is built for the duration
+// of the batch, since preparation pays off after a few evaluations. The
+// receiver's own prepared geometry belongs to the receiver rather than
+// to this call, so it is not used here.
+
+static void* batch_predicate_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosBatchOperation* op = (RGeo_GeosBatchOperation*)arg;
+  const GEOSPreparedGeometry* prep = NULL;
+  unsigned int i;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+  if (op->count > 1) {
+#ifndef RGEO_GEOS_SUPPORTS_PREPARED2
+    if (op->predicate == RGEO_BATCH_INTERSECTS || op->predicate == RGEO_BATCH_CONTAINS)
+#endif
+      prep = GEOSPrepare_r(context, op->geom);
+  }
+#endif
+  for (i=0; i<op->count; ++i) {
+    op->results[i] = batch_predicate(context, op->predicate, op->geom, prep, op->others[i]);
+    if (op->results[i] != 0 && op->results[i] != 1) {
+      op->failed = 1;
+      break;
+    }
+  }
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+  if (prep) {
+    GEOSPreparedGeom_destroy_r(context, prep);
+  }
+#endif
+  return NULL;
+}
+
+
+static void* batch_distance_op(GEOSContextHandle_t context, void* arg)
+{
+  RGeo_GeosBatchOperation* op = (RGeo_GeosBatchOperation*)arg;
+  unsigned int i;
+  for (i=0; i<op->count; ++i) {
+    if (!GEOSDistance_r(context, op->geom, op->others[i], &op->distances[i])) {
+      op->failed = 1;
+      break;
+    }
+  }
+  return NULL;
+}
+
+
+// A call to one of the batch methods. The receiver and the array of
+// other geometries are converted and isolated by batch_start, and the
+// buffers and copies are freed by batch_finish, which is run under
+// rb_ensure so that nothing leaks if a conversion raises. The converted
+// ruby objects are kept in objects while their geometries are in use.
+
+typedef struct {
+  VALUE self;
+  VALUE geoms;
+  VALUE objects;
+  char bitmap;
+  RGeo_GeosBatchOperation op;
+} RGeo_GeosBatchCall;
+
+
+// Fills in the call's op from the receiver and each element of the
+// array, converted to GEOS geometries of the receiver's factory and
+// isolated for the blocking call. Returns 0 if any element could not be
+// converted.
+
+static char batch_start(RGeo_GeosBatchCall* call)
+{
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(call->self);
+  VALUE factory = self_data->factory;
+  RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+  RGeo_GeosBatchOperation* op = &call->op;
+  unsigned int len = (unsigned int)RARRAY_LEN(call->geoms);
+  unsigned int i;
+  call->objects = rb_ary_new2(len);
+  op->others = ALLOC_N(const GEOSGeometry*, len == 0 ? 1 : len);
+  op->geom = rgeo_isolate_geos_geometry(factory_data, self_data->geom);
+  if (!op->geom) {
+    return 0;
+  }
+  for (i=0; i<len; ++i) {
+    VALUE object = rgeo_convert_to_geos_object(factory, rb_ary_entry(call->geoms, i), Qnil);
+    const GEOSGeometry* geom = NIL_P(object) ? NULL : RGEO_GEOMETRY_DATA_PTR(object)->geom;
+    if (geom) {
+      rb_ary_push(call->objects, object);
+      geom = rgeo_isolate_geos_geometry(factory_data, geom);
+    }
+    if (!geom) {
+      return 0;
+    }
+    op->others[op->count++] = geom;
+  }
+  return 1;
+}
+
+
+// Frees the buffers and isolated copies of a batch call. Passed to
+// rb_ensure.
+
+static VALUE batch_finish(VALUE arg)
+{
+  RGeo_GeosBatchCall* call = (RGeo_GeosBatchCall*)arg;
+  RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(RGEO_GEOMETRY_DATA_PTR(call->self)->factory);
+  RGeo_GeosBatchOperation* op = &call->op;
+  unsigned int i;
+  rgeo_release_isolated_geos_geometry(factory_data, op->geom);
+  for (i=0; i<op->count; ++i) {
+    rgeo_release_isolated_geos_geometry(factory_data, op->others[i]);
+  }
+  free(op->others);
+  free(op->results);
+  free(op->distances);
+  return Qnil;
+}
+
+
+// Runs a batch predicate call and builds its result. Passed to rb_ensure.
+
+static VALUE batch_predicate_body(VALUE arg)
+{
+  VALUE result = Qnil;
+  RGeo_GeosBatchCall* call = (RGeo_GeosBatchCall*)arg;
+  RGeo_GeosBatchOperation* op = &call->op;
+  if (batch_start(call)) {
+    op->results = ALLOC_N(char, op->count == 0 ? 1 : op->count);
+    rgeo_call_geos_without_gvl(RGEO_FACTORY_DATA_PTR(RGEO_GEOMETRY_DATA_PTR(call->self)->factory), batch_predicate_op, op);
+    if (!op->failed) {
+      unsigned int i;
+      if (call->bitmap) {
+        result = rb_str_new(NULL, (op->count + 7) / 8);
+        unsigned char* ptr = (unsigned char*)RSTRING_PTR(result);
+        memset(ptr, 0, (op->count + 7) / 8);
+        for (i=0; i<op->count; ++i) {
+          if (op->results[i]) {
+            ptr[i / 8] |= (unsigned char)(1 << (i % 8));
+          }
+        }
+      }
+      else {
+        result = rb_ary_new();
+        for (i=0; i<op->count; ++i) {
+          if (op->results[i]) {
+            rb_ary_push(result, UINT2NUM(i));
+          }
+        }
+      }
+    }
+  }
+  return result;
+}
+
+
+// Runs a batch distance call and builds its result. Passed to rb_ensure.
+
+static VALUE batch_distance_body(VALUE arg)
+{
+  VALUE result = Qnil;
+  RGeo_GeosBatchCall* call = (RGeo_GeosBatchCall*)arg;
+  RGeo_GeosBatchOperation* op = &call->op;
+  if (batch_start(call)) {
+    op->distances = ALLOC_N(double, op->count == 0 ? 1 : op->count);
+    rgeo_call_geos_without_gvl(RGEO_FACTORY_DATA_PTR(RGEO_GEOMETRY_DATA_PTR(call->self)->factory), batch_distance_op, op);
+    if (!op->failed) {
+      unsigned int i;
+      result = rb_ary_new2(op->count);
+      for (i=0; i<op->count; ++i) {
+        rb_ary_push(result, rb_float_new(op->distances[i]));
+      }
+    }
+  }
+  return result;
+}
+
+
+// Sets up a batch call on self with the given array of geometries.
+
+static void batch_init(RGeo_GeosBatchCall* call, VALUE self, VALUE geoms)
+{
+  Check_Type(geoms, T_ARRAY);
+  call->self = self;
+  call->geoms = geoms;
+  call->objects = Qnil;
+  call->bitmap = 0;
+  call->op.geom = NULL;
+  call->op.others = NULL;
+  call->op.count = 0;
+  call->op.predicate = 0;
+  call->op.results = NULL;
+  call->op.distances = NULL;
+  call->op.failed = 0;
+}
+
+
 /**** RUBY METHOD DEFINITIONS ****/
 
 
 static VALUE method_geometry_initialized_p(VALUE self)
 {
-  return RGEO_GEOMETRY_DATA_PTR(self)->geom ? Qtrue : Qfalse;
+  return RGEO_RAW_GEOMETRY_DATA_PTR(self)->geom ? Qtrue : Qfalse;
+}
+
+
+static VALUE method_geometry_prepared_p(VALUE self)
+{
+  const GEOSPreparedGeometry* prep = RGEO_GEOMETRY_DATA_PTR(self)->prep;
+  return (prep && prep != (const GEOSPreparedGeometry*)1 && prep != (const GEOSPreparedGeometry*)2) ? Qtrue : Qfalse;
+}
+
+
+static VALUE method_geometry_prepare(VALUE self)
+{
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  if (self_data->geom) {
+    // Forcing the sentinel to 1 causes the next request to build
+    // the prepared geometry, regardless of the heuristic state.
+    const GEOSPreparedGeometry* prep = self_data->prep;
+    if (!prep || prep == (const GEOSPreparedGeometry*)2) {
+      self_data->prep = (const GEOSPreparedGeometry*)1;
+    }
+    rgeo_request_prepared_geometry(self_data);
+  }
+  return self;
 }
 
 
@@ -211,14 +1232,20 @@ static VALUE method_geometry_as_text(VALUE self)
     RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(self_data->factory);
     VALUE wkt_generator = factory_data->wkrep_wkt_generator;
     if (!NIL_P(wkt_generator)) {
-      result = rb_funcall(wkt_generator, rb_intern("generate"), 1, self);
+      if (factory_data->wkt_native_flags & RGEO_WKTNATIVE_ENABLED) {
+        result = generate_wkt_natively(self, factory_data, self_geom);
+      }
+      if (NIL_P(result)) {
+        RGEO_FACTORY_COUNT(factory_data, callbacks);
+        result = rb_funcall(wkt_generator, rb_intern("generate"), 1, self);
+      }
     }
     else {
-      GEOSWKTWriter* wkt_writer = factory_data->wkt_writer;
+      GEOSWKTWriter* wkt_writer = factory_data->globals->wkt_writer;
       GEOSContextHandle_t geos_context = self_data->geos_context;
       if (!wkt_writer) {
         wkt_writer = GEOSWKTWriter_create_r(geos_context);
-        factory_data->wkt_writer = wkt_writer;
+        factory_data->globals->wkt_writer = wkt_writer;
       }
       char* str = GEOSWKTWriter_write_r(geos_context, wkt_writer, self_geom);
       if (str) {
@@ -240,14 +1267,20 @@ static VALUE method_geometry_as_binary(VALUE self)
     RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(self_data->factory);
     VALUE wkb_generator = factory_data->wkrep_wkb_generator;
     if (!NIL_P(wkb_generator)) {
-      result = rb_funcall(wkb_generator, rb_intern("generate"), 1, self);
+      if ((factory_data->wkb_native_flags & RGEO_WKBNATIVE_ENABLED) && !GEOSisEmpty_r(self_data->geos_context, self_geom)) {
+        result = generate_wkb_natively(factory_data, self_geom);
+      }
+      if (NIL_P(result)) {
+        RGEO_FACTORY_COUNT(factory_data, callbacks);
+        result = rb_funcall(wkb_generator, rb_intern("generate"), 1, self);
+      }
     }
     else {
-      GEOSWKBWriter* wkb_writer = factory_data->wkb_writer;
+      GEOSWKBWriter* wkb_writer = factory_data->globals->wkb_writer;
       GEOSContextHandle_t geos_context = self_data->geos_context;
       if (!wkb_writer) {
         wkb_writer = GEOSWKBWriter_create_r(geos_context);
-        factory_data->wkb_writer = wkb_writer;
+        factory_data->globals->wkb_writer = wkb_writer;
       }
       size_t size;
       char* str = (char*)GEOSWKBWriter_write_r(geos_context, wkb_writer, self_geom, &size);
@@ -261,6 +1294,34 @@ static VALUE method_geometry_as_binary(VALUE self)
 }
 
 
+static VALUE method_geometry_klasses(VALUE self)
+{
+  return RGEO_GEOMETRY_DATA_PTR(self)->klasses;
+}
+
+
+static VALUE method_geometry_marshal_wkb(VALUE self)
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  const GEOSGeometry* self_geom = self_data->geom;
+  if (self_geom) {
+    GEOSContextHandle_t context = self_data->geos_context;
+    GEOSWKBWriter* wkb_writer = native_wkb_writer(RGEO_FACTORY_DATA_PTR(self_data->factory)->globals,
+      context, factory_coord_dims(self_data), 1);
+    if (wkb_writer) {
+      size_t size;
+      unsigned char* str = GEOSWKBWriter_write_r(context, wkb_writer, self_geom, &size);
+      if (str) {
+        result = rb_str_new((char*)str, size);
+        GEOSFree_r(context, str);
+      }
+    }
+  }
+  return result;
+}
+
+
 static VALUE method_geometry_is_empty(VALUE self)
 {
   VALUE result = Qnil;
@@ -342,7 +1403,14 @@ static VALUE method_geometry_disjoint(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSDisjoint_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedDisjoint_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSDisjoint_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -363,7 +1431,14 @@ static VALUE method_geometry_intersects(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSIntersects_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedIntersects_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSIntersects_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -384,7 +1459,14 @@ static VALUE method_geometry_touches(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSTouches_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedTouches_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSTouches_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -405,7 +1487,14 @@ static VALUE method_geometry_crosses(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSCrosses_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedCrosses_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSCrosses_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -426,7 +1515,14 @@ static VALUE method_geometry_within(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSWithin_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedWithin_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSWithin_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -447,7 +1543,14 @@ static VALUE method_geometry_contains(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSContains_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED1
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedContains_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSContains_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -468,7 +1571,14 @@ static VALUE method_geometry_overlaps(VALUE self, VALUE rhs)
   if (self_geom) {
     const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
     if (rhs_geom) {
-      char val = GEOSOverlaps_r(self_data->geos_context, self_geom, rhs_geom);
+      char val;
+#ifdef RGEO_GEOS_SUPPORTS_PREPARED2
+      const GEOSPreparedGeometry* prep = rgeo_request_prepared_geometry(self_data);
+      if (prep)
+        val = GEOSPreparedOverlaps_r(self_data->geos_context, prep, rhs_geom);
+      else
+#endif
+        val = GEOSOverlaps_r(self_data->geos_context, self_geom, rhs_geom);
       if (val == 0) {
         result = Qfalse;
       }
@@ -487,15 +1597,33 @@ static VALUE method_geometry_relate(VALUE self, VALUE rhs, VALUE pattern)
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
   const GEOSGeometry* self_geom = self_data->geom;
   if (self_geom) {
-    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(self_data->factory, rhs, Qnil);
-    if (rhs_geom) {
-      char val = GEOSRelatePattern_r(self_data->geos_context, self_geom, rhs_geom, StringValuePtr(pattern));
-      if (val == 0) {
-        result = Qfalse;
-      }
-      else if (val == 1) {
-        result = Qtrue;
+    VALUE factory = self_data->factory;
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(factory, rhs, Qnil);
+    // The pattern is copied out of the Ruby string while we still hold
+    // the GVL, since the string could be modified or moved once we
+    // release it. A DE-9IM pattern is always exactly 9 characters.
+    char pattern_buf[10];
+    StringValue(pattern);
+    if (rhs_geom && RSTRING_LEN(pattern) == 9) {
+      RGeo_GeosOperation op;
+      memcpy(pattern_buf, RSTRING_PTR(pattern), 9);
+      pattern_buf[9] = 0;
+      op.pattern = pattern_buf;
+      op.result = 2;
+      op.geom1 = rgeo_isolate_geos_geometry(factory_data, self_geom);
+      op.geom2 = rgeo_isolate_geos_geometry(factory_data, rhs_geom);
+      if (op.geom1 && op.geom2) {
+        rgeo_call_geos_without_gvl(factory_data, relate_pattern_op, &op);
+        if (op.result == 0) {
+          result = Qfalse;
+        }
+        else if (op.result == 1) {
+          result = Qtrue;
+        }
       }
+      rgeo_release_isolated_geos_geometry(factory_data, op.geom1);
+      rgeo_release_isolated_geos_geometry(factory_data, op.geom2);
     }
   }
   return result;
@@ -520,96 +1648,237 @@ static VALUE method_geometry_distance(VALUE self, VALUE rhs)
 }
 
 
-static VALUE method_geometry_buffer(VALUE self, VALUE distance)
+static VALUE method_geometry_batch_predicate(int argc, VALUE* argv, VALUE self)
 {
   VALUE result = Qnil;
+  VALUE predicate, geoms, format;
+  rb_scan_args(argc, argv, "21", &predicate, &geoms, &format);
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
-  const GEOSGeometry* self_geom = self_data->geom;
-  if (self_geom) {
-    VALUE factory = self_data->factory;
-    int resolution = NUM2INT(RGEO_FACTORY_DATA_PTR(factory)->buffer_resolution);
-    result = rgeo_wrap_geos_geometry(factory, GEOSBuffer_r(self_data->geos_context, self_geom, rb_num2dbl(distance), resolution), Qnil);
+  if (self_data->geom) {
+    ID predicate_id = rb_to_id(predicate);
+    RGeo_GeosBatchCall call;
+    batch_init(&call, self, geoms);
+    if (predicate_id == rb_intern("intersects?")) call.op.predicate = RGEO_BATCH_INTERSECTS;
+    else if (predicate_id == rb_intern("disjoint?")) call.op.predicate = RGEO_BATCH_DISJOINT;
+    else if (predicate_id == rb_intern("contains?")) call.op.predicate = RGEO_BATCH_CONTAINS;
+    else if (predicate_id == rb_intern("within?")) call.op.predicate = RGEO_BATCH_WITHIN;
+    else if (predicate_id == rb_intern("touches?")) call.op.predicate = RGEO_BATCH_TOUCHES;
+    else if (predicate_id == rb_intern("crosses?")) call.op.predicate = RGEO_BATCH_CROSSES;
+    else if (predicate_id == rb_intern("overlaps?")) call.op.predicate = RGEO_BATCH_OVERLAPS;
+    else rb_raise(rb_eArgError, "Unsupported batch predicate: %s", rb_id2name(predicate_id));
+    call.bitmap = !NIL_P(format) && rb_to_id(format) == rb_intern("bitmap");
+    result = rb_ensure(batch_predicate_body, (VALUE)&call, batch_finish, (VALUE)&call);
+    RB_GC_GUARD(call.objects);
   }
   return result;
 }
 
 
-static VALUE method_geometry_convex_hull(VALUE self)
+static VALUE method_geometry_batch_distance(VALUE self, VALUE geoms)
 {
   VALUE result = Qnil;
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
-  const GEOSGeometry* self_geom = self_data->geom;
-  if (self_geom) {
-    result = rgeo_wrap_geos_geometry(self_data->factory, GEOSConvexHull_r(self_data->geos_context, self_geom), Qnil);
+  if (self_data->geom) {
+    RGeo_GeosBatchCall call;
+    batch_init(&call, self, geoms);
+    result = rb_ensure(batch_distance_body, (VALUE)&call, batch_finish, (VALUE)&call);
+    RB_GC_GUARD(call.objects);
   }
   return result;
 }
 
 
-static VALUE method_geometry_intersection(VALUE self, VALUE rhs)
+static VALUE method_geometry_buffer(VALUE self, VALUE distance)
 {
   VALUE result = Qnil;
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
   const GEOSGeometry* self_geom = self_data->geom;
   if (self_geom) {
     VALUE factory = self_data->factory;
-    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(factory, rhs, Qnil);
-    if (rhs_geom) {
-      result = rgeo_wrap_geos_geometry(factory, GEOSIntersection_r(self_data->geos_context, self_geom, rhs_geom), Qnil);
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    RGeo_GeosOperation op;
+    op.distance = rb_num2dbl(distance);
+    op.resolution = factory_data->buffer_resolution;
+    op.geom1 = rgeo_isolate_geos_geometry(factory_data, self_geom);
+    if (op.geom1) {
+      GEOSGeometry* geom = (GEOSGeometry*)rgeo_call_geos_without_gvl(factory_data, buffer_op, &op);
+      rgeo_release_isolated_geos_geometry(factory_data, op.geom1);
+      result = rgeo_wrap_geos_geometry(factory, geom, Qnil);
     }
   }
   return result;
 }
 
 
-static VALUE method_geometry_union(VALUE self, VALUE rhs)
+// Runs a simplification operation on self with the given tolerance
+// without the interpreter lock, and wraps the result.
+
+static VALUE simplify_without_gvl(VALUE self, VALUE tolerance, void* (*func)(GEOSContextHandle_t, void*))
 {
   VALUE result = Qnil;
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
   const GEOSGeometry* self_geom = self_data->geom;
   if (self_geom) {
     VALUE factory = self_data->factory;
-    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(factory, rhs, Qnil);
-    if (rhs_geom) {
-      result = rgeo_wrap_geos_geometry(factory, GEOSUnion_r(self_data->geos_context, self_geom, rhs_geom), Qnil);
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    RGeo_GeosOperation op;
+    op.distance = rb_num2dbl(tolerance);
+    op.geom1 = rgeo_isolate_geos_geometry(factory_data, self_geom);
+    if (op.geom1) {
+      GEOSGeometry* geom = (GEOSGeometry*)rgeo_call_geos_without_gvl(factory_data, func, &op);
+      rgeo_release_isolated_geos_geometry(factory_data, op.geom1);
+      result = rgeo_wrap_geos_geometry(factory, geom, Qnil);
     }
   }
   return result;
 }
 
 
-static VALUE method_geometry_difference(VALUE self, VALUE rhs)
+static VALUE method_geometry_simplify(VALUE self, VALUE tolerance)
+{
+  return simplify_without_gvl(self, tolerance, simplify_op);
+}
+
+
+static VALUE method_geometry_topology_preserving_simplify(VALUE self, VALUE tolerance)
+{
+  return simplify_without_gvl(self, tolerance, topology_preserve_simplify_op);
+}
+
+
+static VALUE method_geometry_convex_hull(VALUE self)
 {
   VALUE result = Qnil;
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
   const GEOSGeometry* self_geom = self_data->geom;
   if (self_geom) {
-    VALUE factory = self_data->factory;
-    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(factory, rhs, Qnil);
-    if (rhs_geom) {
-      result = rgeo_wrap_geos_geometry(factory, GEOSDifference_r(self_data->geos_context, self_geom, rhs_geom), Qnil);
+    result = rgeo_wrap_geos_geometry(self_data->factory, GEOSConvexHull_r(self_data->geos_context, self_geom), Qnil);
+  }
+  return result;
+}
+
+
+static VALUE method_geometry_packed_coordinates(VALUE self, VALUE has_z)
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  if (self_data->geom) {
+    result = packed_coords_for(self_data, RTEST(has_z) ? 3 : 2);
+  }
+  return result;
+}
+
+
+static VALUE method_geometry_packed_coordinates_default(VALUE self)
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  if (self_data->geom) {
+    result = packed_coords_for(self_data, factory_coord_dims(self_data));
+  }
+  return result;
+}
+
+
+static VALUE method_geometry_flat_coordinates(VALUE self)
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  if (self_data->geom) {
+    VALUE packed = packed_coords_for(self_data, factory_coord_dims(self_data));
+    if (!NIL_P(packed)) {
+      long len = RSTRING_LEN(packed) / sizeof(double);
+      const double* buf = (const double*)RSTRING_PTR(packed);
+      long i;
+      result = rb_ary_new2(len);
+      for (i=0; i<len; ++i) {
+        rb_ary_push(result, rb_float_new(buf[i]));
+      }
     }
+    RB_GC_GUARD(packed);
   }
   return result;
 }
 
 
-static VALUE method_geometry_sym_difference(VALUE self, VALUE rhs)
+static VALUE method_geometry_num_coordinates(VALUE self)
 {
   VALUE result = Qnil;
   RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
-  const GEOSGeometry* self_geom = self_data->geom;
-  if (self_geom) {
-    VALUE factory = self_data->factory;
-    const GEOSGeometry* rhs_geom = rgeo_convert_to_geos_geometry(factory, rhs, Qnil);
-    if (rhs_geom) {
-      result = rgeo_wrap_geos_geometry(factory, GEOSSymDifference_r(self_data->geos_context, self_geom, rhs_geom), Qnil);
+  if (self_data->geom) {
+    int count = GEOSGetNumCoordinates_r(self_data->geos_context, self_data->geom);
+    if (count >= 0) {
+      result = INT2NUM(count);
     }
   }
   return result;
 }
 
 
+static VALUE method_geometry_coordinate_bounds(VALUE self)
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  if (self_data->geom) {
+    result = coord_bounds_for(self_data);
+  }
+  return result;
+}
+
+
+static VALUE method_geometry_each_coordinate(VALUE self)
+{
+  if (!rb_block_given_p()) {
+    return rb_funcall(self, rb_intern("enum_for"), 1, ID2SYM(rb_intern("each_coordinate")));
+  }
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  if (self_data->geom) {
+    unsigned int dims = factory_coord_dims(self_data);
+    VALUE packed = packed_coords_for(self_data, dims);
+    if (!NIL_P(packed)) {
+      long count = RSTRING_LEN(packed) / (dims * sizeof(double));
+      const double* buf = (const double*)RSTRING_PTR(packed);
+      long i;
+      for (i=0; i<count; ++i) {
+        const double* coord = buf + i * dims;
+        if (dims == 3) {
+          rb_yield_values(3, rb_float_new(coord[0]), rb_float_new(coord[1]), rb_float_new(coord[2]));
+        }
+        else {
+          rb_yield_values(2, rb_float_new(coord[0]), rb_float_new(coord[1]));
+        }
+      }
+    }
+    RB_GC_GUARD(packed);
+  }
+  return self;
+}
+
+
+static VALUE method_geometry_intersection(VALUE self, VALUE rhs)
+{
+  return overlay_without_gvl(self, rhs, intersection_op);
+}
+
+
+static VALUE method_geometry_union(VALUE self, VALUE rhs)
+{
+  return overlay_without_gvl(self, rhs, union_op);
+}
+
+
+static VALUE method_geometry_difference(VALUE self, VALUE rhs)
+{
+  return overlay_without_gvl(self, rhs, difference_op);
+}
+
+
+static VALUE method_geometry_sym_difference(VALUE self, VALUE rhs)
+{
+  return overlay_without_gvl(self, rhs, sym_difference_op);
+}
+
+
 static VALUE alloc_geometry(VALUE klass)
 {
   return rgeo_wrap_geos_geometry(Qnil, NULL, klass);
@@ -619,9 +1888,11 @@ static VALUE alloc_geometry(VALUE klass)
 static VALUE method_geometry_initialize_copy(VALUE self, VALUE orig)
 {
   // Clear out any existing value
-  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  RGeo_GeometryData* self_data = RGEO_RAW_GEOMETRY_DATA_PTR(self);
   GEOSGeometry* self_geom = self_data->geom;
+  self_data->adopted = 0;
   if (self_geom) {
+    rgeo_release_prepared_geometry(self_data);
     GEOSGeom_destroy_r(self_data->geos_context, self_geom);
     self_data->geom = NULL;
     self_data->geos_context = NULL;
@@ -641,6 +1912,9 @@ static VALUE method_geometry_initialize_copy(VALUE self, VALUE orig)
       self_data->geos_context = orig_context;
       self_data->factory = orig_data->factory;
       self_data->klasses = orig_data->klasses;
+      // The copy gets its own prepared geometry only if needed later.
+      self_data->prep = (RGEO_FACTORY_DATA_PTR(orig_data->factory)->flags & RGEO_FACTORYFLAGS_PREPARE_HEURISTIC) ?
+        (const GEOSPreparedGeometry*)2 : NULL;
     }
   }
   return self;
@@ -660,6 +1934,8 @@ void rgeo_init_geos_geometry(RGeo_Globals* globals)
   rb_define_method(geos_geometry_class, "_set_factory", method_geometry_set_factory, 1);
   rb_define_method(geos_geometry_class, "initialize_copy", method_geometry_initialize_copy, 1);
   rb_define_method(geos_geometry_class, "initialized?", method_geometry_initialized_p, 0);
+  rb_define_method(geos_geometry_class, "prepared?", method_geometry_prepared_p, 0);
+  rb_define_method(geos_geometry_class, "prepare!", method_geometry_prepare, 0);
   rb_define_method(geos_geometry_class, "factory", method_geometry_factory, 0);
   rb_define_method(geos_geometry_class, "dimension", method_geometry_dimension, 0);
   rb_define_method(geos_geometry_class, "geometry_type", method_geometry_geometry_type, 0);
@@ -683,7 +1959,11 @@ void rgeo_init_geos_geometry(RGeo_Globals* globals)
   rb_define_method(geos_geometry_class, "overlaps?", method_geometry_overlaps, 1);
   rb_define_method(geos_geometry_class, "relate?", method_geometry_relate, 2);
   rb_define_method(geos_geometry_class, "distance", method_geometry_distance, 1);
+  rb_define_method(geos_geometry_class, "batch_predicate", method_geometry_batch_predicate, -1);
+  rb_define_method(geos_geometry_class, "batch_distance", method_geometry_batch_distance, 1);
   rb_define_method(geos_geometry_class, "buffer", method_geometry_buffer, 1);
+  rb_define_method(geos_geometry_class, "simplify", method_geometry_simplify, 1);
+  rb_define_method(geos_geometry_class, "topology_preserving_simplify", method_geometry_topology_preserving_simplify, 1);
   rb_define_method(geos_geometry_class, "convex_hull", method_geometry_convex_hull, 0);
   rb_define_method(geos_geometry_class, "intersection", method_geometry_intersection, 1);
   rb_define_method(geos_geometry_class, "*", method_geometry_intersection, 1);
@@ -692,6 +1972,14 @@ void rgeo_init_geos_geometry(RGeo_Globals* globals)
   rb_define_method(geos_geometry_class, "difference", method_geometry_difference, 1);
   rb_define_method(geos_geometry_class, "-", method_geometry_difference, 1);
   rb_define_method(geos_geometry_class, "sym_difference", method_geometry_sym_difference, 1);
+  rb_define_method(geos_geometry_class, "_klasses", method_geometry_klasses, 0);
+  rb_define_method(geos_geometry_class, "_marshal_wkb", method_geometry_marshal_wkb, 0);
+  rb_define_method(geos_geometry_class, "_packed_coordinates", method_geometry_packed_coordinates, 1);
+  rb_define_method(geos_geometry_class, "packed_coordinates", method_geometry_packed_coordinates_default, 0);
+  rb_define_method(geos_geometry_class, "flat_coordinates", method_geometry_flat_coordinates, 0);
+  rb_define_method(geos_geometry_class, "_coordinate_bounds", method_geometry_coordinate_bounds, 0);
+  rb_define_method(geos_geometry_class, "_num_coordinates", method_geometry_num_coordinates, 0);
+  rb_define_method(geos_geometry_class, "each_coordinate", method_geometry_each_coordinate, 0);
 }
 
 
@@ -39,6 +39,7 @@
 
 #ifdef RGEO_GEOS_SUPPORTED
 
+#include <stdlib.h>
 #include <ruby.h>
 #include <geos_c.h>
 
@@ -54,10 +55,168 @@ RGEO_BEGIN_C
 /**** INTERNAL IMPLEMENTATION OF CREATE ****/
 
 
+// Envelope of one element of a multipolygon being validated.
+
+typedef struct {
+  double min_x;
+  double max_x;
+  double min_y;
+  double max_y;
+  unsigned int index;
+} RGeo_ElementEnvelope;
+
+
+static int compare_element_envelopes(const void* a, const void* b)
+{
+  double a_x = ((const RGeo_ElementEnvelope*)a)->min_x;
+  double b_x = ((const RGeo_ElementEnvelope*)b)->min_x;
+  return a_x < b_x ? -1 : (a_x > b_x ? 1 : 0);
+}
+
+
+// Computes the envelope of the given polygon from its exterior ring.
+// Returns 0 if the polygon is empty (or the envelope is unavailable),
+// in which case it cannot conflict with any other element.
+
+static char polygon_envelope(GEOSContextHandle_t context, const GEOSGeometry* geom, RGeo_ElementEnvelope* envelope)
+{
+  const GEOSGeometry* ring = GEOSGetExteriorRing_r(context, geom);
+  const GEOSCoordSequence* coord_seq = ring ? GEOSGeom_getCoordSeq_r(context, ring) : NULL;
+  unsigned int size, i;
+  if (!coord_seq || !GEOSCoordSeq_getSize_r(context, coord_seq, &size) || size == 0) {
+    return 0;
+  }
+  for (i=0; i<size; ++i) {
+    double x, y;
+    GEOSCoordSeq_getX_r(context, coord_seq, i, &x);
+    GEOSCoordSeq_getY_r(context, coord_seq, i, &y);
+    if (i == 0 || x < envelope->min_x) envelope->min_x = x;
+    if (i == 0 || x > envelope->max_x) envelope->max_x = x;
+    if (i == 0 || y < envelope->min_y) envelope->min_y = y;
+    if (i == 0 || y > envelope->max_y) envelope->max_y = y;
+  }
+  return 1;
+}
+
+
+// Checks the MultiPolygon assertions for the given elements: returns 1
+// if any two elements have intersecting interiors, or boundaries that
+// meet along a line. Both conditions require the two envelopes to meet,
+// so we sweep over the envelopes sorted by min_x, and run the relate
+// computations only for pairs whose envelopes intersect.
+
+static char multi_polygon_elements_conflict(GEOSContextHandle_t context, GEOSGeometry** geoms, unsigned int len)
+{
+  char problem = 0;
+  RGeo_ElementEnvelope* envelopes = ALLOC_N(RGeo_ElementEnvelope, len == 0 ? 1 : len);
+  unsigned int count = 0, i, j;
+  for (i=0; i<len; ++i) {
+    if (polygon_envelope(context, geoms[i], &envelopes[count])) {
+      envelopes[count++].index = i;
+    }
+  }
+  qsort(envelopes, count, sizeof(RGeo_ElementEnvelope), compare_element_envelopes);
+  for (i=0; i<count && !problem; ++i) {
+    const RGeo_ElementEnvelope* ienv = &envelopes[i];
+    for (j=i+1; j<count && envelopes[j].min_x <= ienv->max_x; ++j) {
+      const RGeo_ElementEnvelope* jenv = &envelopes[j];
+      if (jenv->min_y <= ienv->max_y && jenv->max_y >= ienv->min_y) {
+        GEOSGeometry* igeom = geoms[ienv->index];
+        GEOSGeometry* jgeom = geoms[jenv->index];
+        problem = GEOSRelatePattern_r(context, igeom, jgeom, "2********") ||
+          GEOSRelatePattern_r(context, igeom, jgeom, "****1****");
+        if (problem) {
+          break;
+        }
+      }
+    }
+  }
+  free(envelopes);
+  return problem;
+}
+
+
+// An element object to be adopted, with its position in the collection.
+
+typedef struct {
+  VALUE object;
+  unsigned int index;
+} RGeo_AdoptedElement;
+
+
+static int compare_adopted_elements(const void* a, const void* b)
+{
+  const RGeo_AdoptedElement* a_elem = (const RGeo_AdoptedElement*)a;
+  const RGeo_AdoptedElement* b_elem = (const RGeo_AdoptedElement*)b;
+  if (a_elem->object != b_elem->object) {
+    return a_elem->object < b_elem->object ? -1 : 1;
+  }
+  return a_elem->index < b_elem->index ? -1 : (a_elem->index > b_elem->index ? 1 : 0);
+}
+
+
+// Takes over the GEOS geometries of the given element objects, which
+// were cast by rgeo_convert_to_adoptable_geos_object and whose geometries
+// have been borrowed into geoms. An object that appears more than once
+// is adopted at its first position and cloned at the others, so that
+// the collection never holds one geometry twice. Duplicates are found
+// by sorting, and cloned before anything is adopted. Returns 0, having
+// adopted nothing, if a clone could not be made.
+
+static char adopt_elements(GEOSContextHandle_t context, VALUE objects, GEOSGeometry** geoms, unsigned int len)
+{
+  char success = 1;
+  RGeo_AdoptedElement* elements = ALLOC_N(RGeo_AdoptedElement, len == 0 ? 1 : len);
+  char* duplicates = ALLOC_N(char, len == 0 ? 1 : len);
+  unsigned int i, j;
+  for (i=0; i<len; ++i) {
+    elements[i].object = rb_ary_entry(objects, i);
+    elements[i].index = i;
+    duplicates[i] = 0;
+  }
+  qsort(elements, len, sizeof(RGeo_AdoptedElement), compare_adopted_elements);
+  for (i=1; i<len; ++i) {
+    if (elements[i].object == elements[i-1].object) {
+      duplicates[elements[i].index] = 1;
+    }
+  }
+  for (i=0; i<len; ++i) {
+    if (duplicates[i]) {
+      geoms[i] = GEOSGeom_clone_r(context, geoms[i]);
+      if (!geoms[i]) {
+        success = 0;
+        break;
+      }
+    }
+  }
+  if (success) {
+    for (i=0; i<len; ++i) {
+      if (!duplicates[i]) {
+        rgeo_adopt_geos_geometry(rb_ary_entry(objects, i), NULL);
+      }
+    }
+  }
+  else {
+    for (j=0; j<i; ++j) {
+      if (duplicates[j]) {
+        GEOSGeom_destroy_r(context, geoms[j]);
+      }
+    }
+  }
+  free(duplicates);
+  free(elements);
+  return success;
+}
+
+
 // Main implementation of the "create" class method for geometry collections.
-// You must pass in the correct GEOS geometry type ID.
+// You must pass in the correct GEOS geometry type ID. If adopt is set, the
+// elements' GEOS geometries are adopted rather than cloned (see
+// rgeo_adopt_geos_geometry). In that case the geometries are only borrowed
+// until the collection is known to be valid, so that a failed call leaves
+// every element intact.
 
-static VALUE create_geometry_collection(VALUE module, int type, VALUE factory, VALUE array)
+static VALUE create_geometry_collection(VALUE module, int type, VALUE factory, VALUE array, char adopt)
 {
   VALUE result = Qnil;
   Check_Type(array, T_ARRAY);
@@ -70,6 +229,7 @@ static VALUE create_geometry_collection(VALUE module, int type, VALUE factory, V
     unsigned int i,j;
     VALUE klasses = Qnil;
     VALUE cast_type = Qnil;
+    VALUE objects = adopt ? rb_ary_new2(len) : Qnil;
     switch (type) {
     case GEOS_MULTIPOINT:
       cast_type = factory_data->globals->feature_point;
@@ -82,7 +242,20 @@ static VALUE create_geometry_collection(VALUE module, int type, VALUE factory, V
       break;
     }
     for (i=0; i<len; ++i) {
-      GEOSGeometry* geom = rgeo_convert_to_detached_geos_geometry(rb_ary_entry(array, i), factory, cast_type, &klass);
+      VALUE elem = rb_ary_entry(array, i);
+      GEOSGeometry* geom = NULL;
+      if (adopt) {
+        VALUE object = rgeo_convert_to_adoptable_geos_object(elem, factory, cast_type);
+        if (!NIL_P(object)) {
+          RGeo_GeometryData* object_data = RGEO_GEOMETRY_DATA_PTR(object);
+          geom = object_data->geom;
+          klass = NIL_P(object_data->klasses) ? CLASS_OF(object) : object_data->klasses;
+          rb_ary_push(objects, object);
+        }
+      }
+      else {
+        geom = rgeo_convert_to_detached_geos_geometry(elem, factory, cast_type, &klass);
+      }
       if (!geom) {
         break;
       }
@@ -97,39 +270,25 @@ static VALUE create_geometry_collection(VALUE module, int type, VALUE factory, V
         rb_ary_push(klasses, klass);
       }
     }
-    if (i != len) {
-      for (j=0; j<i; ++j) {
-        GEOSGeom_destroy_r(geos_context, geoms[j]);
+    char valid = i == len;
+    // Due to a limitation of GEOS, the MultiPolygon assertions are not checked.
+    // We do that manually here, before any element is adopted.
+    if (valid && type == GEOS_MULTIPOLYGON && (factory_data->flags & 1) == 0) {
+      valid = !multi_polygon_elements_conflict(geos_context, geoms, len);
+    }
+    if (valid && adopt) {
+      valid = adopt_elements(geos_context, objects, geoms, len);
+    }
+    if (!valid) {
+      // Borrowed geometries still belong to their elements.
+      if (!adopt) {
+        for (j=0; j<i; ++j) {
+          GEOSGeom_destroy_r(geos_context, geoms[j]);
+        }
       }
     }
     else {
       GEOSGeometry* collection = GEOSGeom_createCollection_r(geos_context, type, geoms, len);
-      // Due to a limitation of GEOS, the MultiPolygon assertions are not checked.
-      // We do that manually here.
-      if (collection && type == GEOS_MULTIPOLYGON && (factory_data->flags & 1) == 0) {
-        char problem = 0;
-        for (i=1; i<len; ++i) {
-          for (j=0; j<i; ++j) {
-            GEOSGeometry* igeom = geoms[i];
-            GEOSGeometry* jgeom = geoms[j];
-            problem = GEOSRelatePattern_r(geos_context, igeom, jgeom, "2********");
-            if (problem) {
-              break;
-            }
-            problem = GEOSRelatePattern_r(geos_context, igeom, jgeom, "****1****");
-            if (problem) {
-              break;
-            }
-          }
-          if (problem) {
-            break;
-          }
-        }
-        if (problem) {
-          GEOSGeom_destroy_r(geos_context, collection);
-          collection = NULL;
-        }
-      }
       if (collection) {
         result = rgeo_wrap_geos_geometry(factory, collection, module);
         RGEO_GEOMETRY_DATA_PTR(result)->klasses = klasses;
@@ -140,12 +299,248 @@ static VALUE create_geometry_collection(VALUE module, int type, VALUE factory, V
       // case, this will be a memory leak.
     }
     free(geoms);
+    RB_GC_GUARD(objects);
   }
   
   return result;
 }
 
 
+#ifndef RGEO_GEOS_SUPPORTS_UNARYUNION
+
+// Components of a collection being unioned without GEOSUnaryUnion_r,
+// grouped by dimension. The arrays hold clones owned by the group.
+
+typedef struct {
+  GEOSGeometry** geoms[3];
+  unsigned int counts[3];
+} RGeo_UnionGroups;
+
+
+static unsigned int count_union_components(GEOSContextHandle_t context, const GEOSGeometry* geom)
+{
+  unsigned int result = 0;
+  int i, n;
+  switch (GEOSGeomTypeId_r(context, geom)) {
+  case GEOS_MULTIPOINT:
+  case GEOS_MULTILINESTRING:
+  case GEOS_MULTIPOLYGON:
+  case GEOS_GEOMETRYCOLLECTION:
+    n = GEOSGetNumGeometries_r(context, geom);
+    for (i=0; i<n; ++i) {
+      const GEOSGeometry* elem = GEOSGetGeometryN_r(context, geom, i);
+      if (elem) {
+        result += count_union_components(context, elem);
+      }
+    }
+    break;
+  default:
+    result = 1;
+    break;
+  }
+  return result;
+}
+
+
+// Adds clones of the points, lines and polygons of the given geometry
+// to the groups, flattening any nested collections. Empty components
+// are skipped. Returns 0 if a clone fails.
+
+static int collect_union_components(GEOSContextHandle_t context, const GEOSGeometry* geom, RGeo_UnionGroups* groups)
+{
+  int i, n, group;
+  switch (GEOSGeomTypeId_r(context, geom)) {
+  case GEOS_MULTIPOINT:
+  case GEOS_MULTILINESTRING:
+  case GEOS_MULTIPOLYGON:
+  case GEOS_GEOMETRYCOLLECTION:
+    n = GEOSGetNumGeometries_r(context, geom);
+    for (i=0; i<n; ++i) {
+      const GEOSGeometry* elem = GEOSGetGeometryN_r(context, geom, i);
+      if (elem && !collect_union_components(context, elem, groups)) {
+        return 0;
+      }
+    }
+    return 1;
+  case GEOS_POINT:
+    group = 0;
+    break;
+  case GEOS_POLYGON:
+    group = 2;
+    break;
+  default:
+    group = 1;
+    break;
+  }
+  if (!GEOSisEmpty_r(context, geom)) {
+    GEOSGeometry* clone = GEOSGeom_clone_r(context, geom);
+    if (!clone) {
+      return 0;
+    }
+    groups->geoms[group][groups->counts[group]++] = clone;
+  }
+  return 1;
+}
+
+
+// Unions one group of components, passing ownership of them to GEOS.
+// Polygons use the cascaded union; points and lines, which are always
+// homogeneous here, are unioned with themselves. Returns NULL with
+// nothing to do for an empty group.
+
+static GEOSGeometry* union_group(GEOSContextHandle_t context, RGeo_UnionGroups* groups, int group)
+{
+  static const int types[3] = {GEOS_MULTIPOINT, GEOS_MULTILINESTRING, GEOS_MULTIPOLYGON};
+  GEOSGeometry* result = NULL;
+  GEOSGeometry* collection;
+  if (groups->counts[group] == 0) {
+    return NULL;
+  }
+  collection = GEOSGeom_createCollection_r(context, types[group], groups->geoms[group], groups->counts[group]);
+  groups->counts[group] = 0;
+  if (collection) {
+    result = group == 2 ? GEOSUnionCascaded_r(context, collection) : GEOSUnion_r(context, collection, collection);
+    GEOSGeom_destroy_r(context, collection);
+  }
+  return result;
+}
+
+
+// Emulates GEOSUnaryUnion_r for old versions of GEOS, which cannot
+// union a geometry collection with itself if it mixes dimensions. The
+// components are grouped by dimension and each group is unioned. The
+// lines and polygons are then unioned together, and the points not
+// covered by either are added. Returns NULL on failure.
+
+static GEOSGeometry* emulated_unary_union(GEOSContextHandle_t context, const GEOSGeometry* geom)
+{
+  GEOSGeometry* result = NULL;
+  GEOSGeometry* unions[3] = {NULL, NULL, NULL};
+  GEOSGeometry* line_area = NULL;
+  GEOSGeometry** parts = NULL;
+  RGeo_UnionGroups groups;
+  unsigned int i, num_parts = 0, capacity;
+  int j, n, success = 1;
+  unsigned int total = count_union_components(context, geom);
+  for (j=0; j<3; ++j) {
+    groups.geoms[j] = (GEOSGeometry**)malloc((total ? total : 1) * sizeof(GEOSGeometry*));
+    groups.counts[j] = 0;
+    success = success && groups.geoms[j];
+  }
+  if (success) {
+    success = collect_union_components(context, geom, &groups);
+  }
+  for (j=0; success && j<3; ++j) {
+    if (groups.counts[j] > 0) {
+      unions[j] = union_group(context, &groups, j);
+      success = unions[j] != NULL;
+    }
+  }
+  if (success) {
+    if (unions[1] && unions[2]) {
+      line_area = GEOSUnion_r(context, unions[1], unions[2]);
+      success = line_area != NULL;
+    }
+    else if (unions[1] || unions[2]) {
+      line_area = GEOSGeom_clone_r(context, unions[1] ? unions[1] : unions[2]);
+      success = line_area != NULL;
+    }
+  }
+  if (success) {
+    if (!unions[0]) {
+      result = line_area ? line_area : GEOSGeom_createCollection_r(context, GEOS_GEOMETRYCOLLECTION, NULL, 0);
+      line_area = NULL;
+    }
+    else if (!line_area) {
+      result = unions[0];
+      unions[0] = NULL;
+    }
+    else {
+      n = GEOSGetNumGeometries_r(context, unions[0]);
+      capacity = n + (GEOSGeomTypeId_r(context, line_area) == GEOS_GEOMETRYCOLLECTION ? GEOSGetNumGeometries_r(context, line_area) : 1);
+      parts = (GEOSGeometry**)malloc(capacity * sizeof(GEOSGeometry*));
+      success = parts != NULL;
+      if (success) {
+        if (GEOSGeomTypeId_r(context, line_area) == GEOS_GEOMETRYCOLLECTION) {
+          for (j=0; success && j<GEOSGetNumGeometries_r(context, line_area); ++j) {
+            parts[num_parts] = GEOSGeom_clone_r(context, GEOSGetGeometryN_r(context, line_area, j));
+            success = parts[num_parts++] != NULL;
+          }
+        }
+        else {
+          parts[num_parts++] = line_area;
+          line_area = NULL;
+        }
+      }
+      for (j=0; success && j<n; ++j) {
+        const GEOSGeometry* point = GEOSGetGeometryN_r(context, unions[0], j);
+        char covered = point ? 0 : 2;
+        for (i=1; i<3 && !covered; ++i) {
+          if (unions[i]) {
+            covered = GEOSIntersects_r(context, point, unions[i]);
+          }
+        }
+        if (covered == 2) {
+          success = 0;
+        }
+        else if (!covered) {
+          parts[num_parts] = GEOSGeom_clone_r(context, point);
+          success = parts[num_parts++] != NULL;
+        }
+      }
+      if (success) {
+        result = GEOSGeom_createCollection_r(context, GEOS_GEOMETRYCOLLECTION, parts, num_parts);
+      }
+      else {
+        for (i=0; i<num_parts; ++i) {
+          if (parts[i]) {
+            GEOSGeom_destroy_r(context, parts[i]);
+          }
+        }
+      }
+      free(parts);
+    }
+  }
+  for (j=0; j<3; ++j) {
+    if (groups.geoms[j]) {
+      for (i=0; i<groups.counts[j]; ++i) {
+        GEOSGeom_destroy_r(context, groups.geoms[j][i]);
+      }
+      free(groups.geoms[j]);
+    }
+    if (unions[j]) {
+      GEOSGeom_destroy_r(context, unions[j]);
+    }
+  }
+  if (line_area) {
+    GEOSGeom_destroy_r(context, line_area);
+  }
+  return result;
+}
+
+#endif
+
+
+// Computes the union of all the elements of the given collection. This
+// is passed to rgeo_call_geos_without_gvl. Old versions of GEOS lack
+// GEOSUnaryUnion_r; there, multipolygons use the cascaded union, and
+// other collections are grouped by dimension (see
+// emulated_unary_union).
+
+static void* unary_union_op(GEOSContextHandle_t context, void* arg)
+{
+  const GEOSGeometry* geom = (const GEOSGeometry*)arg;
+#ifdef RGEO_GEOS_SUPPORTS_UNARYUNION
+  return GEOSUnaryUnion_r(context, geom);
+#else
+  if (GEOSGeomTypeId_r(context, geom) == GEOS_MULTIPOLYGON) {
+    return GEOSUnionCascaded_r(context, geom);
+  }
+  return emulated_unary_union(context, geom);
+#endif
+}
+
+
 /**** RUBY METHOD DEFINITIONS ****/
 
 
@@ -244,6 +639,25 @@ static VALUE method_geometry_collection_each(VALUE self)
 }
 
 
+static VALUE method_geometry_collection_unary_union(VALUE self)
+{
+  VALUE result = Qnil;
+  RGeo_GeometryData* self_data = RGEO_GEOMETRY_DATA_PTR(self);
+  const GEOSGeometry* self_geom = self_data->geom;
+  if (self_geom) {
+    VALUE factory = self_data->factory;
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(factory);
+    const GEOSGeometry* geom_input = rgeo_isolate_geos_geometry(factory_data, self_geom);
+    if (geom_input) {
+      GEOSGeometry* geom = (GEOSGeometry*)rgeo_call_geos_without_gvl(factory_data, unary_union_op, (void*)geom_input);
+      rgeo_release_isolated_geos_geometry(factory_data, geom_input);
+      result = rgeo_wrap_geos_geometry(factory, geom, Qnil);
+    }
+  }
+  return result;
+}
+
+
 static VALUE method_multi_point_geometry_type(VALUE self)
 {
   VALUE result = Qnil;
@@ -359,25 +773,61 @@ static VALUE method_multi_polygon_point_on_surface(VALUE self)
 
 static VALUE cmethod_geometry_collection_create(VALUE module, VALUE factory, VALUE array)
 {
-  return create_geometry_collection(module, GEOS_GEOMETRYCOLLECTION, factory, array);
+  return create_geometry_collection(module, GEOS_GEOMETRYCOLLECTION, factory, array, 0);
+}
+
+
+static VALUE cmethod_geometry_collection_create_adopting(VALUE module, VALUE factory, VALUE array)
+{
+  return create_geometry_collection(module, GEOS_GEOMETRYCOLLECTION, factory, array, 1);
 }
 
 
 static VALUE cmethod_multi_point_create(VALUE module, VALUE factory, VALUE array)
 {
-  return create_geometry_collection(module, GEOS_MULTIPOINT, factory, array);
+  return create_geometry_collection(module, GEOS_MULTIPOINT, factory, array, 0);
+}
+
+
+static VALUE cmethod_multi_point_create_adopting(VALUE module, VALUE factory, VALUE array)
+{
+  return create_geometry_collection(module, GEOS_MULTIPOINT, factory, array, 1);
 }
 
 
 static VALUE cmethod_multi_line_string_create(VALUE module, VALUE factory, VALUE array)
 {
-  return create_geometry_collection(module, GEOS_MULTILINESTRING, factory, array);
+  return create_geometry_collection(module, GEOS_MULTILINESTRING, factory, array, 0);
+}
+
+
+static VALUE cmethod_multi_line_string_create_adopting(VALUE module, VALUE factory, VALUE array)
+{
+  return create_geometry_collection(module, GEOS_MULTILINESTRING, factory, array, 1);
 }
 
 
 static VALUE cmethod_multi_polygon_create(VALUE module, VALUE factory, VALUE array)
 {
-  return create_geometry_collection(module, GEOS_MULTIPOLYGON, factory, array);
+  return create_geometry_collection(module, GEOS_MULTIPOLYGON, factory, array, 0);
+}
+
+
+static VALUE cmethod_multi_polygon_create_adopting(VALUE module, VALUE factory, VALUE array)
+{
+  return create_geometry_collection(module, GEOS_MULTIPOLYGON, factory, array, 1);
+}
+
+
+static VALUE cmethod_geometry_collection_union_all(VALUE module, VALUE factory, VALUE array)
+{
+  VALUE result = Qnil;
+  VALUE collection = create_geometry_collection(module, GEOS_GEOMETRYCOLLECTION, factory, array, 0);
+  if (!NIL_P(collection)) {
+    result = method_geometry_collection_unary_union(collection);
+  }
+  RB_GC_GUARD(collection);
+  return result;
 }
 
 
@@ -402,6 +852,7 @@ void rgeo_init_geos_geometry_collection(RGeo_Globals* globals)
   
   // Methods for GeometryCollectionImpl
   rb_define_module_function(geos_geometry_collection_class, "create", cmethod_geometry_collection_create, 2);
+  rb_define_module_function(geos_geometry_collection_class, "_create_adopting", cmethod_geometry_collection_create_adopting, 2);
   rb_include_module(geos_geometry_collection_class, rb_define_module("Enumerable"));
   rb_define_method(geos_geometry_collection_class, "eql?", method_geometry_collection_eql, 1);
   rb_define_method(geos_geometry_collection_class, "geometry_type", method_geometry_collection_geometry_type, 0);
@@ -410,19 +861,24 @@ void rgeo_init_geos_geometry_collection(RGeo_Globals* globals)
   rb_define_method(geos_geometry_collection_class, "geometry_n", method_geometry_collection_geometry_n, 1);
   rb_define_method(geos_geometry_collection_class, "[]", method_geometry_collection_brackets, 1);
   rb_define_method(geos_geometry_collection_class, "each", method_geometry_collection_each, 0);
+  rb_define_method(geos_geometry_collection_class, "unary_union", method_geometry_collection_unary_union, 0);
+  rb_define_module_function(geos_geometry_collection_class, "_union_all", cmethod_geometry_collection_union_all, 2);
   
   // Methods for MultiPointImpl
   rb_define_module_function(geos_multi_point_class, "create", cmethod_multi_point_create, 2);
+  rb_define_module_function(geos_multi_point_class, "_create_adopting", cmethod_multi_point_create_adopting, 2);
   rb_define_method(geos_multi_point_class, "geometry_type", method_multi_point_geometry_type, 0);
   
   // Methods for MultiLineStringImpl
   rb_define_module_function(geos_multi_line_string_class, "create", cmethod_multi_line_string_create, 2);
+  rb_define_module_function(geos_multi_line_string_class, "_create_adopting", cmethod_multi_line_string_create_adopting, 2);
   rb_define_method(geos_multi_line_string_class, "geometry_type", method_multi_line_string_geometry_type, 0);
   rb_define_method(geos_multi_line_string_class, "length", method_multi_line_string_length, 0);
   rb_define_method(geos_multi_line_string_class, "is_closed?", method_multi_line_string_is_closed, 0);
   
   // Methods for MultiPolygonImpl
   rb_define_module_function(geos_multi_polygon_class, "create", cmethod_multi_polygon_create, 2);
+  rb_define_module_function(geos_multi_polygon_class, "_create_adopting", cmethod_multi_polygon_create_adopting, 2);
   rb_define_method(geos_multi_polygon_class, "geometry_type", method_multi_polygon_geometry_type, 0);
   rb_define_method(geos_multi_polygon_class, "area", method_multi_polygon_area, 0);
   rb_define_method(geos_multi_polygon_class, "centroid", method_multi_polygon_centroid, 0);
@@ -413,6 +413,7 @@ static VALUE impl_copy_from(VALUE klass, VALUE factory, VALUE original, char sub
         GEOSCoordSequence* coord_seq = GEOSCoordSeq_clone_r(context, original_coord_seq);
         if (coord_seq) {
           GEOSGeometry* geom = subtype == 2 ? GEOSGeom_createLinearRing_r(context, coord_seq) : GEOSGeom_createLineString_r(context, coord_seq);
+          geom = rgeo_snap_geos_geometry(RGEO_FACTORY_DATA_PTR(factory), geom);
           if (geom) {
             result = rgeo_wrap_geos_geometry(factory, geom, klass);
           }
@@ -48,6 +48,7 @@
 #include "line_string.h"
 #include "polygon.h"
 #include "geometry_collection.h"
+#include "strtree.h"
 
 #endif
 
@@ -63,6 +64,9 @@ void Init_geos_c_impl()
   rgeo_init_geos_line_string(globals);
   rgeo_init_geos_polygon(globals);
   rgeo_init_geos_geometry_collection(globals);
+#ifdef RGEO_GEOS_SUPPORTS_STRTREE
+  rgeo_init_geos_strtree(globals);
+#endif
 #endif
 }
 
@@ -173,8 +173,8 @@ VALUE rgeo_create_geos_point(VALUE factory, double x, double y, double z)
   GEOSContextHandle_t context = factory_data->geos_context;
   GEOSCoordSequence* coord_seq = GEOSCoordSeq_create_r(context, 1, 3);
   if (coord_seq) {
-    if (GEOSCoordSeq_setX_r(context, coord_seq, 0, x)) {
-      if (GEOSCoordSeq_setY_r(context, coord_seq, 0, y)) {
+    if (GEOSCoordSeq_setX_r(context, coord_seq, 0, rgeo_snap_coordinate(x, factory_data->grid_scale))) {
+      if (GEOSCoordSeq_setY_r(context, coord_seq, 0, rgeo_snap_coordinate(y, factory_data->grid_scale))) {
         if (GEOSCoordSeq_setZ_r(context, coord_seq, 0, z)) {
           GEOSGeometry* geom = GEOSGeom_createPoint_r(context, coord_seq);
           if (geom) {
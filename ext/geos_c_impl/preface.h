@@ -41,6 +41,24 @@
 #endif
 #endif
 
+#ifdef HAVE_GEOSPREPAREDCONTAINS_R
+#define RGEO_GEOS_SUPPORTS_PREPARED1
+#endif
+#ifdef HAVE_GEOSPREPAREDDISJOINT_R
+#define RGEO_GEOS_SUPPORTS_PREPARED2
+#endif
+#ifdef HAVE_GEOSSTRTREE_CREATE_R
+#define RGEO_GEOS_SUPPORTS_STRTREE
+#endif
+#ifdef HAVE_GEOSUNARYUNION_R
+#define RGEO_GEOS_SUPPORTS_UNARYUNION
+#endif
+#ifdef HAVE_PTHREAD_H
+#if defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL) || defined(HAVE_RB_THREAD_BLOCKING_REGION)
+#define RGEO_GEOS_RELEASES_GVL
+#endif
+#endif
+
 #ifdef __cplusplus
 #define RGEO_BEGIN_C extern "C" {
 #define RGEO_END_C }
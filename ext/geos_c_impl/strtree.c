@@ -0,0 +1,516 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  Spatial index (STRtree) for GEOS wrapper
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#ifdef RGEO_GEOS_SUPPORTED
+#ifdef RGEO_GEOS_SUPPORTS_STRTREE
+
+#include <math.h>
+#include <ruby.h>
+#include <geos_c.h>
+
+#include "factory.h"
+#include "strtree.h"
+
+RGEO_BEGIN_C
+
+
+/**** INTERNAL DATA STRUCTURES ****/
+
+
+/*
+  Wrapped structure for STRtree objects.
+  The tree itself stores, for each inserted item, a small integer tag
+  (the item's index plus one) rather than a ruby object. The items
+  array holds the corresponding client-supplied values, and is marked
+  for the GC. The geoms array holds clones of the geometries used for
+  insertion, num_geoms of them in space for geoms_capacity. The tree
+  owns these clones rather than borrowing the geometries of the ruby
+  objects, which could be adopted or reinitialized while the tree still
+  refers to them. They must outlive the tree itself, because GEOS
+  references their internal envelopes directly.
+  
+  GEOS builds the tree lazily on the first query, after which no more
+  items may be inserted. The built flag tracks that transition. We also
+  keep the overall extent of the inserted items for nearest-neighbor
+  searches.
+*/
+typedef struct {
+  GEOSSTRtree* tree;
+  GEOSContextHandle_t geos_context;
+  VALUE factory;
+  VALUE items;
+  GEOSGeometry** geoms;
+  size_t num_geoms;
+  size_t geoms_capacity;
+  char built;
+  char has_extent;
+  double extent[4];
+} RGeo_STRtreeData;
+
+
+#define RGEO_STRTREE_DATA_PTR(obj) ((RGeo_STRtreeData*)DATA_PTR(obj))
+
+
+// Growable buffer of item tags, filled in by the query callback. The
+// failed flag is set if the buffer could not be grown.
+
+typedef struct {
+  size_t* tags;
+  size_t size;
+  size_t capacity;
+  char failed;
+} RGeo_STRtreeHits;
+
+
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+static void destroy_strtree_func(RGeo_STRtreeData* data)
+{
+  size_t i;
+  if (data->tree) {
+    GEOSSTRtree_destroy_r(data->geos_context, data->tree);
+  }
+  for (i=0; i<data->num_geoms; ++i) {
+    GEOSGeom_destroy_r(data->geos_context, data->geoms[i]);
+  }
+  free(data->geoms);
+  free(data);
+}
+
+
+static void mark_strtree_func(RGeo_STRtreeData* data)
+{
+  if (!NIL_P(data->factory)) {
+    rb_gc_mark(data->factory);
+  }
+  if (!NIL_P(data->items)) {
+    rb_gc_mark(data->items);
+  }
+}
+
+
+// Query callback. This is called from inside GEOS, so it must not call
+// back into ruby. It just collects the tags of the hits, and records a
+// failure to grow the buffer for the caller to report.
+
+static void query_callback(void* item, void* userdata)
+{
+  RGeo_STRtreeHits* hits = (RGeo_STRtreeHits*)userdata;
+  if (hits->failed) {
+    return;
+  }
+  if (hits->size == hits->capacity) {
+    size_t capacity = hits->capacity == 0 ? 16 : hits->capacity * 2;
+    size_t* tags = (size_t*)realloc(hits->tags, capacity * sizeof(size_t));
+    if (!tags) {
+      hits->failed = 1;
+      return;
+    }
+    hits->tags = tags;
+    hits->capacity = capacity;
+  }
+  hits->tags[hits->size++] = (size_t)item;
+}
+
+
+// Runs a query against the tree for the given geometry's envelope.
+// The caller must free hits->tags. Returns 0, with no hits, if the
+// results could not all be collected; the caller should then release
+// anything it holds and call raise_query_failure.
+
+static char query_tree(RGeo_STRtreeData* data, const GEOSGeometry* geom, RGeo_STRtreeHits* hits)
+{
+  hits->tags = NULL;
+  hits->size = 0;
+  hits->capacity = 0;
+  hits->failed = 0;
+  data->built = 1;
+  GEOSSTRtree_query_r(data->geos_context, data->tree, geom, query_callback, hits);
+  if (hits->failed) {
+    free(hits->tags);
+    hits->tags = NULL;
+    hits->size = 0;
+    return 0;
+  }
+  return 1;
+}
+
+
+static void raise_query_failure(void)
+{
+  rb_raise(rb_eNoMemError, "failed to allocate memory for STRtree query results");
+}
+
+
+// Computes the bounds of the given geometry as {min_x, min_y, max_x, max_y}.
+// Returns 0 if the geometry is empty or the bounds could not be computed.
+
+static char get_geometry_bounds(GEOSContextHandle_t context, const GEOSGeometry* geom, double* bounds)
+{
+  char result = 0;
+  GEOSGeometry* envelope = GEOSEnvelope_r(context, geom);
+  if (envelope) {
+    const GEOSCoordSequence* coord_seq = NULL;
+    switch (GEOSGeomTypeId_r(context, envelope)) {
+    case GEOS_POINT:
+      if (GEOSGetNumCoordinates_r(context, envelope) > 0) {
+        coord_seq = GEOSGeom_getCoordSeq_r(context, envelope);
+      }
+      break;
+    case GEOS_POLYGON:
+      coord_seq = GEOSGeom_getCoordSeq_r(context, GEOSGetExteriorRing_r(context, envelope));
+      break;
+    }
+    unsigned int size;
+    if (coord_seq && GEOSCoordSeq_getSize_r(context, coord_seq, &size) && size > 0) {
+      unsigned int i;
+      double x, y;
+      result = 1;
+      for (i=0; i<size; ++i) {
+        if (!GEOSCoordSeq_getX_r(context, coord_seq, i, &x) || !GEOSCoordSeq_getY_r(context, coord_seq, i, &y)) {
+          result = 0;
+          break;
+        }
+        if (i == 0 || x < bounds[0]) bounds[0] = x;
+        if (i == 0 || y < bounds[1]) bounds[1] = y;
+        if (i == 0 || x > bounds[2]) bounds[2] = x;
+        if (i == 0 || y > bounds[3]) bounds[3] = y;
+      }
+    }
+    GEOSGeom_destroy_r(context, envelope);
+  }
+  return result;
+}
+
+
+// Creates a GEOS geometry whose envelope is the given rectangle. This is
+// just a two-point line string along the diagonal, which is all the tree
+// needs for a query. The caller owns the result.
+
+static GEOSGeometry* create_box_geometry(GEOSContextHandle_t context, double min_x, double min_y, double max_x, double max_y)
+{
+  GEOSGeometry* result = NULL;
+  GEOSCoordSequence* coord_seq = GEOSCoordSeq_create_r(context, 2, 2);
+  if (coord_seq) {
+    GEOSCoordSeq_setX_r(context, coord_seq, 0, min_x);
+    GEOSCoordSeq_setY_r(context, coord_seq, 0, min_y);
+    GEOSCoordSeq_setX_r(context, coord_seq, 1, max_x);
+    GEOSCoordSeq_setY_r(context, coord_seq, 1, max_y);
+    result = GEOSGeom_createLineString_r(context, coord_seq);
+  }
+  return result;
+}
+
+
+// Returns a GEOS-backed ruby object for the given geometry, casting it
+// to the tree's factory if it is not already a GEOS object.
+// Returns Qnil if the cast failed.
+
+static VALUE geos_object_for(RGeo_STRtreeData* data, VALUE obj)
+{
+  VALUE result = obj;
+  if (!rgeo_is_geos_object(obj)) {
+    RGeo_FactoryData* factory_data = RGEO_FACTORY_DATA_PTR(data->factory);
+    RGEO_FACTORY_COUNT(factory_data, conversions);
+    result = rb_funcall(factory_data->globals->feature_module, rb_intern("cast"), 2, obj, data->factory);
+    if (!rgeo_is_geos_object(result)) {
+      result = Qnil;
+    }
+  }
+  if (!NIL_P(result) && !RGEO_GEOMETRY_DATA_PTR(result)->geom) {
+    result = Qnil;
+  }
+  return result;
+}
+
+
+// Converts a set of hits into a ruby array of items.
+
+static VALUE items_from_hits(RGeo_STRtreeData* data, const RGeo_STRtreeHits* hits)
+{
+  VALUE result = rb_ary_new2(hits->size);
+  size_t i;
+  for (i=0; i<hits->size; ++i) {
+    rb_ary_push(result, rb_ary_entry(data->items, (long)(hits->tags[i] - 1)));
+  }
+  return result;
+}
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+static VALUE method_strtree_size(VALUE self)
+{
+  return LONG2NUM(RARRAY_LEN(RGEO_STRTREE_DATA_PTR(self)->items));
+}
+
+
+static VALUE method_strtree_built_p(VALUE self)
+{
+  return RGEO_STRTREE_DATA_PTR(self)->built ? Qtrue : Qfalse;
+}
+
+
+static VALUE method_strtree_factory(VALUE self)
+{
+  return RGEO_STRTREE_DATA_PTR(self)->factory;
+}
+
+
+static VALUE method_strtree_insert(VALUE self, VALUE geometry, VALUE item)
+{
+  VALUE result = Qnil;
+  RGeo_STRtreeData* self_data = RGEO_STRTREE_DATA_PTR(self);
+  if (!self_data->built) {
+    VALUE object = geos_object_for(self_data, geometry);
+    GEOSContextHandle_t context = self_data->geos_context;
+    if (!NIL_P(object) && self_data->num_geoms == self_data->geoms_capacity) {
+      size_t capacity = self_data->geoms_capacity == 0 ? 16 : self_data->geoms_capacity * 2;
+      if (self_data->geoms) {
+        REALLOC_N(self_data->geoms, GEOSGeometry*, capacity);
+      }
+      else {
+        self_data->geoms = ALLOC_N(GEOSGeometry*, capacity);
+      }
+      self_data->geoms_capacity = capacity;
+    }
+    GEOSGeometry* geom = NIL_P(object) ? NULL : GEOSGeom_clone_r(context, RGEO_GEOMETRY_DATA_PTR(object)->geom);
+    if (geom) {
+      self_data->geoms[self_data->num_geoms++] = geom;
+      double bounds[4];
+      if (get_geometry_bounds(context, geom, bounds)) {
+        if (self_data->has_extent) {
+          if (bounds[0] < self_data->extent[0]) self_data->extent[0] = bounds[0];
+          if (bounds[1] < self_data->extent[1]) self_data->extent[1] = bounds[1];
+          if (bounds[2] > self_data->extent[2]) self_data->extent[2] = bounds[2];
+          if (bounds[3] > self_data->extent[3]) self_data->extent[3] = bounds[3];
+        }
+        else {
+          self_data->extent[0] = bounds[0];
+          self_data->extent[1] = bounds[1];
+          self_data->extent[2] = bounds[2];
+          self_data->extent[3] = bounds[3];
+          self_data->has_extent = 1;
+        }
+      }
+      rb_ary_push(self_data->items, item);
+      GEOSSTRtree_insert_r(context, self_data->tree, geom, (void*)(size_t)RARRAY_LEN(self_data->items));
+      result = self;
+    }
+  }
+  return result;
+}
+
+
+static VALUE method_strtree_query(VALUE self, VALUE geometry)
+{
+  VALUE result = Qnil;
+  RGeo_STRtreeData* self_data = RGEO_STRTREE_DATA_PTR(self);
+  VALUE object = geos_object_for(self_data, geometry);
+  if (!NIL_P(object)) {
+    RGeo_STRtreeHits hits;
+    if (!query_tree(self_data, RGEO_GEOMETRY_DATA_PTR(object)->geom, &hits)) {
+      raise_query_failure();
+    }
+    result = items_from_hits(self_data, &hits);
+    free(hits.tags);
+  }
+  return result;
+}
+
+
+static VALUE method_strtree_query_envelope(VALUE self, VALUE min_x, VALUE min_y, VALUE max_x, VALUE max_y)
+{
+  VALUE result = Qnil;
+  RGeo_STRtreeData* self_data = RGEO_STRTREE_DATA_PTR(self);
+  GEOSContextHandle_t context = self_data->geos_context;
+  GEOSGeometry* box = create_box_geometry(context, rb_num2dbl(min_x), rb_num2dbl(min_y), rb_num2dbl(max_x), rb_num2dbl(max_y));
+  if (box) {
+    RGeo_STRtreeHits hits;
+    char success = query_tree(self_data, box, &hits);
+    GEOSGeom_destroy_r(context, box);
+    if (!success) {
+      raise_query_failure();
+    }
+    result = items_from_hits(self_data, &hits);
+    free(hits.tags);
+  }
+  return result;
+}
+
+
+// Nearest-neighbor search. The tree only supports envelope queries, so we
+// query a box around the target that grows until it finds any candidate.
+// The closest candidate found bounds the distance to the true nearest
+// neighbor, whose envelope must therefore intersect the target's envelope
+// expanded by that distance. One more query over that region, followed
+// by exact distance computations, finds the answer.
+
+static VALUE method_strtree_nearest(VALUE self, VALUE geometry)
+{
+  VALUE result = Qnil;
+  RGeo_STRtreeData* self_data = RGEO_STRTREE_DATA_PTR(self);
+  if (!self_data->has_extent) {
+    return result;
+  }
+  VALUE object = geos_object_for(self_data, geometry);
+  if (NIL_P(object)) {
+    return result;
+  }
+  GEOSContextHandle_t context = self_data->geos_context;
+  const GEOSGeometry* geom = RGEO_GEOMETRY_DATA_PTR(object)->geom;
+  double bounds[4];
+  if (!geom || !get_geometry_bounds(context, geom, bounds)) {
+    return result;
+  }
+  double* extent = self_data->extent;
+  double radius = extent[2] - extent[0];
+  if (extent[3] - extent[1] > radius) {
+    radius = extent[3] - extent[1];
+  }
+  radius = radius > 0.0 ? radius / sqrt((double)RARRAY_LEN(self_data->items)) : 1.0;
+  
+  RGeo_STRtreeHits hits;
+  hits.tags = NULL;
+  hits.size = 0;
+  char pass;
+  for (pass=0; pass<2; ++pass) {
+    char covers_extent = 0;
+    while (1) {
+      free(hits.tags);
+      GEOSGeometry* box = create_box_geometry(context, bounds[0] - radius, bounds[1] - radius, bounds[2] + radius, bounds[3] + radius);
+      if (!box) {
+        return result;
+      }
+      char success = query_tree(self_data, box, &hits);
+      GEOSGeom_destroy_r(context, box);
+      if (!success) {
+        raise_query_failure();
+      }
+      covers_extent = bounds[0] - radius <= extent[0] && bounds[1] - radius <= extent[1] &&
+        bounds[2] + radius >= extent[2] && bounds[3] + radius >= extent[3];
+      if (hits.size > 0 || covers_extent || pass == 1) {
+        break;
+      }
+      radius *= 2.0;
+    }
+    if (hits.size == 0) {
+      break;
+    }
+    
+    // Find the closest candidate
+    size_t i;
+    size_t best = 0;
+    double best_dist = 0.0;
+    for (i=0; i<hits.size; ++i) {
+      double dist;
+      const GEOSGeometry* candidate = self_data->geoms[hits.tags[i] - 1];
+      if (candidate && GEOSDistance_r(context, geom, candidate, &dist) && (best == 0 || dist < best_dist)) {
+        best = hits.tags[i];
+        best_dist = dist;
+      }
+    }
+    if (best == 0) {
+      break;
+    }
+    result = rb_ary_entry(self_data->items, (long)(best - 1));
+    if (best_dist <= radius || covers_extent) {
+      // Every item closer than best_dist has already been examined.
+      break;
+    }
+    radius = best_dist;
+  }
+  free(hits.tags);
+  return result;
+}
+
+
+static VALUE cmethod_strtree_create(VALUE klass, VALUE factory, VALUE node_capacity)
+{
+  VALUE result = Qnil;
+  GEOSContextHandle_t context = RGEO_FACTORY_DATA_PTR(factory)->geos_context;
+  int capacity = NUM2INT(node_capacity);
+  RGeo_STRtreeData* data = ALLOC(RGeo_STRtreeData);
+  if (data) {
+    // Wrap the structure before allocating any other ruby object, so
+    // that the GC can see everything it references.
+    data->tree = NULL;
+    data->geos_context = context;
+    data->factory = Qnil;
+    data->items = Qnil;
+    data->geoms = NULL;
+    data->num_geoms = 0;
+    data->geoms_capacity = 0;
+    data->built = 0;
+    data->has_extent = 0;
+    VALUE wrapper = Data_Wrap_Struct(klass, mark_strtree_func, destroy_strtree_func, data);
+    data->tree = GEOSSTRtree_create_r(context, capacity < 2 ? 2 : capacity);
+    if (data->tree) {
+      data->factory = factory;
+      data->items = rb_ary_new();
+      result = wrapper;
+    }
+  }
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_geos_strtree(RGeo_Globals* globals)
+{
+  VALUE geos_strtree_class = rb_const_get_at(globals->geos_module, rb_intern("STRtree"));
+  rb_define_module_function(geos_strtree_class, "_create", cmethod_strtree_create, 2);
+  rb_define_method(geos_strtree_class, "_insert", method_strtree_insert, 2);
+  rb_define_method(geos_strtree_class, "_query", method_strtree_query, 1);
+  rb_define_method(geos_strtree_class, "_query_envelope", method_strtree_query_envelope, 4);
+  rb_define_method(geos_strtree_class, "_nearest", method_strtree_nearest, 1);
+  rb_define_method(geos_strtree_class, "size", method_strtree_size, 0);
+  rb_define_method(geos_strtree_class, "built?", method_strtree_built_p, 0);
+  rb_define_method(geos_strtree_class, "factory", method_strtree_factory, 0);
+}
+
+
+RGEO_END_C
+
+#endif
+#endif
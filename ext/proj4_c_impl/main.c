@@ -52,9 +52,19 @@
 
 #ifdef RGEO_PROJ4_SUPPORTED
 
+#include <math.h>
+#include <string.h>
 #include <ruby.h>
 #include <proj_api.h>
 
+#ifndef RB_GC_GUARD
+#define RB_GC_GUARD(v) (*(volatile VALUE*)&(v))
+#endif
+
+#ifndef NAN
+#define NAN (0.0/0.0)
+#endif
+
 #endif
 
 
@@ -224,6 +234,96 @@ static VALUE cmethod_proj4_transform(VALUE method, VALUE from, VALUE to, VALUE x
 }
 
 
+// Transforms count points stored consecutively in buf, each having dim
+// (2 or 3) coordinates. Handles conversion from and to degrees. Points
+// that could not be transformed are set to NaN.
+
+static void transform_packed(RGeo_Proj4Data* from_data, RGeo_Proj4Data* to_data, double* buf, long count, int dim)
+{
+  long i;
+  int j;
+  double* pt;
+  int from_degrees = !from_data->uses_radians && pj_is_latlong(from_data->pj);
+  int to_degrees = !to_data->uses_radians && pj_is_latlong(to_data->pj);
+  if (count <= 0) {
+    return;
+  }
+  if (from_degrees) {
+    for (i=0; i<count; ++i) {
+      buf[i*dim] *= DEG_TO_RAD;
+      buf[i*dim+1] *= DEG_TO_RAD;
+    }
+  }
+  double* orig = ALLOC_N(double, count * dim);
+  memcpy(orig, buf, count * dim * sizeof(double));
+  if (pj_transform(from_data->pj, to_data->pj, count, dim, buf, buf+1, dim == 3 ? buf+2 : NULL)) {
+    // The batch failed as a whole. Retry one point at a time so only the
+    // failing points are lost.
+    memcpy(buf, orig, count * dim * sizeof(double));
+    for (i=0; i<count; ++i) {
+      pt = buf + i*dim;
+      if (pj_transform(from_data->pj, to_data->pj, 1, 1, pt, pt+1, dim == 3 ? pt+2 : NULL)) {
+        pt[0] = HUGE_VAL;
+      }
+    }
+  }
+  free(orig);
+  for (i=0; i<count; ++i) {
+    pt = buf + i*dim;
+    if (pt[0] == HUGE_VAL || pt[1] == HUGE_VAL || (dim == 3 && pt[2] == HUGE_VAL)) {
+      for (j=0; j<dim; ++j) {
+        pt[j] = NAN;
+      }
+    }
+    else if (to_degrees) {
+      pt[0] *= RAD_TO_DEG;
+      pt[1] *= RAD_TO_DEG;
+    }
+  }
+}
+
+
+static VALUE cmethod_proj4_transform_array(VALUE method, VALUE from, VALUE to, VALUE coords, VALUE has_z)
+{
+  VALUE result = Qnil;
+  RGeo_Proj4Data* from_data = RGEO_PROJ4_DATA_PTR(from);
+  RGeo_Proj4Data* to_data = RGEO_PROJ4_DATA_PTR(to);
+  if (from_data->pj && to_data->pj) {
+    int dim = RTEST(has_z) ? 3 : 2;
+    int packed = TYPE(coords) == T_STRING;
+    long count, i;
+    double* buf;
+    VALUE buffer;
+    if (packed) {
+      count = RSTRING_LEN(coords) / (dim * sizeof(double));
+      buffer = rb_str_new(RSTRING_PTR(coords), count * dim * sizeof(double));
+    }
+    else {
+      Check_Type(coords, T_ARRAY);
+      count = RARRAY_LEN(coords) / dim;
+      buffer = rb_str_new(NULL, count * dim * sizeof(double));
+      buf = (double*)RSTRING_PTR(buffer);
+      for (i=0; i<count*dim; ++i) {
+        buf[i] = rb_num2dbl(rb_ary_entry(coords, i));
+      }
+    }
+    buf = (double*)RSTRING_PTR(buffer);
+    transform_packed(from_data, to_data, buf, count, dim);
+    if (packed) {
+      result = buffer;
+    }
+    else {
+      result = rb_ary_new2(count * dim);
+      for (i=0; i<count*dim; ++i) {
+        rb_ary_push(result, isnan(buf[i]) ? Qnil : rb_float_new(buf[i]));
+      }
+    }
+    RB_GC_GUARD(buffer);
+  }
+  return result;
+}
+
+
 static VALUE cmethod_proj4_create(VALUE klass, VALUE str, VALUE uses_radians)
 {
   VALUE result = Qnil;
@@ -254,6 +354,7 @@ static void rgeo_init_proj4()
   rb_define_method(proj4_class, "_radians?", method_proj4_uses_radians, 0);
   rb_define_method(proj4_class, "_get_geographic", method_proj4_get_geographic, 0);
   rb_define_module_function(proj4_class, "_transform_coords", cmethod_proj4_transform, 5);
+  rb_define_module_function(proj4_class, "_transform_coords_array", cmethod_proj4_transform_array, 4);
 }
 
 
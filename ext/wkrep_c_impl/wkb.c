@@ -0,0 +1,697 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  WKB parser and generator for native WKRep implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <string.h>
+#include <ctype.h>
+#include <ruby.h>
+
+#include "wkb.h"
+
+RGEO_BEGIN_C
+
+
+/**** INTERNAL DATA ****/
+
+
+static VALUE rgeo_wkb_generator_class;
+
+static ID id_call;
+static ID id_property;
+static ID id_point;
+static ID id_line_string;
+static ID id_linear_ring;
+static ID id_polygon;
+static ID id_multi_point;
+static ID id_line_string_from_coordinates;
+static ID id_polygon_from_coordinates;
+static ID id_multi_point_from_coordinates;
+static ID id_multi_line_string;
+static ID id_multi_polygon;
+static ID id_collection;
+static ID id_factory;
+static ID id_geometry_type;
+static ID id_srid;
+static ID id_x;
+static ID id_y;
+static ID id_z;
+static ID id_m;
+static ID id_points;
+static ID id_exterior_ring;
+static ID id_interior_rings;
+static ID id_is_empty;
+static ID id_num_geometries;
+static ID id_geometry_n;
+
+
+// State for a single call to WKBParser#_parse_native.
+// The cur_bulk flag is set if the current factory has bulk constructors
+// that take packed coordinates (such as line_string_from_coordinates),
+// with cur_factory_dims numbers per coordinate. Those are used instead
+// of creating a point object per vertex.
+
+typedef struct {
+  const unsigned char* data;
+  long len;
+  long pos;
+  VALUE factory_generator;
+  char support_ewkb;
+  char support_wkb12;
+  VALUE default_srid;
+  char cur_has_z;
+  char cur_has_m;
+  int cur_dims;
+  VALUE cur_srid;
+  VALUE cur_factory;
+  char cur_bulk;
+  int cur_factory_dims;
+} RGeo_WKBParseState;
+
+
+// State for a single call to WKBGenerator#_generate_native.
+
+typedef struct {
+  VALUE buffer;
+  VALUE type_codes;
+  char little_endian;
+  char ewkb;
+  char wkb12;
+  char emit_ewkb_srid;
+  char cur_has_z;
+  char cur_has_m;
+} RGeo_WKBGenerateState;
+
+
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+// Returns the RGeo::Error::ParseError class.
+
+static VALUE parse_error_class(void)
+{
+  VALUE error_module = rb_const_get(rb_define_module("RGeo"), rb_intern("Error"));
+  return rb_const_get(error_module, rb_intern("ParseError"));
+}
+
+
+static const char* bool_str(char value)
+{
+  return value ? "true" : "false";
+}
+
+
+// Decodes a hex string the same way as String#pack("H*").
+
+static VALUE decode_hex(VALUE str)
+{
+  long len = RSTRING_LEN(str);
+  VALUE result = rb_str_new(NULL, (len + 1) / 2);
+  const char* src = RSTRING_PTR(str);
+  unsigned char* dest = (unsigned char*)RSTRING_PTR(result);
+  long i;
+  for (i=0; i<len; ++i) {
+    char c = src[i];
+    unsigned char nibble = isalpha((unsigned char)c) ? ((c & 15) + 9) & 15 : c & 15;
+    if (i % 2 == 0) {
+      dest[i/2] = nibble << 4;
+    }
+    else {
+      dest[i/2] |= nibble;
+    }
+  }
+  return result;
+}
+
+
+static unsigned char get_byte(RGeo_WKBParseState* state)
+{
+  if (state->pos + 1 > state->len) {
+    rb_raise(parse_error_class(), "Not enough bytes left to fulfill 1 byte");
+  }
+  return state->data[state->pos++];
+}
+
+
+static unsigned long get_integer(RGeo_WKBParseState* state, char little_endian)
+{
+  if (state->pos + 4 > state->len) {
+    rb_raise(parse_error_class(), "Not enough bytes left to fulfill 1 integer");
+  }
+  const unsigned char* p = state->data + state->pos;
+  state->pos += 4;
+  if (little_endian) {
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+  }
+  else {
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16) | ((unsigned long)p[2] << 8) | (unsigned long)p[3];
+  }
+}
+
+
+// Raises unless there are enough bytes left for count doubles.
+
+static void check_doubles(RGeo_WKBParseState* state, unsigned long count)
+{
+  if ((unsigned long)(state->len - state->pos) / 8 < count) {
+    rb_raise(parse_error_class(), "Not enough bytes left to fulfill %lu doubles", count);
+  }
+}
+
+
+// Reads count doubles into dest. Call check_doubles first.
+
+static void get_doubles(RGeo_WKBParseState* state, char little_endian, int count, double* dest)
+{
+  int i, j;
+  for (i=0; i<count; ++i) {
+    const unsigned char* p = state->data + state->pos;
+    uint64_t bits = 0;
+    if (little_endian) {
+      for (j=7; j>=0; --j) {
+        bits = (bits << 8) | p[j];
+      }
+    }
+    else {
+      for (j=0; j<8; ++j) {
+        bits = (bits << 8) | p[j];
+      }
+    }
+    memcpy(dest + i, &bits, 8);
+    state->pos += 8;
+  }
+}
+
+
+static VALUE parse_point_coords(RGeo_WKBParseState* state, char little_endian)
+{
+  double coords[4];
+  VALUE args[4];
+  int i;
+  get_doubles(state, little_endian, state->cur_dims, coords);
+  for (i=0; i<state->cur_dims; ++i) {
+    args[i] = rb_float_new(coords[i]);
+  }
+  return rb_funcall2(state->cur_factory, id_point, state->cur_dims, args);
+}
+
+
+// Reads count coordinates into a String of packed native doubles, in the
+// layout taken by the factory's bulk constructors. A coordinate the data
+// lacks but the factory has is set to 0. Call check_doubles first.
+
+static VALUE read_packed_coords(RGeo_WKBParseState* state, char little_endian, unsigned long count)
+{
+  int dims = state->cur_factory_dims;
+  VALUE result = rb_str_new(NULL, count * dims * sizeof(double));
+  double* coords = (double*)RSTRING_PTR(result);
+  unsigned long i;
+  for (i=0; i<count; ++i) {
+    coords[i*dims+dims-1] = 0;
+    get_doubles(state, little_endian, state->cur_dims, coords + i*dims);
+  }
+  return result;
+}
+
+
+// Reads a point count and that many coordinates as for read_packed_coords.
+
+static VALUE parse_packed_coords(RGeo_WKBParseState* state, char little_endian)
+{
+  unsigned long count = get_integer(state, little_endian);
+  check_doubles(state, count * state->cur_dims);
+  return read_packed_coords(state, little_endian, count);
+}
+
+
+static VALUE parse_line_string(RGeo_WKBParseState* state, char little_endian)
+{
+  if (state->cur_bulk) {
+    return rb_funcall(state->cur_factory, id_line_string_from_coordinates, 1, parse_packed_coords(state, little_endian));
+  }
+  unsigned long count = get_integer(state, little_endian);
+  unsigned long i;
+  check_doubles(state, count * state->cur_dims);
+  VALUE points = rb_ary_new2(count);
+  for (i=0; i<count; ++i) {
+    rb_ary_push(points, parse_point_coords(state, little_endian));
+  }
+  return rb_funcall(state->cur_factory, id_line_string, 1, points);
+}
+
+
+// Parses the header of an object, setting *little_endian and returning
+// the type code. The contained argument is Qfalse for the toplevel
+// object, Qtrue for an element of a GeometryCollection, or a Fixnum type
+// code that an element of a typed collection must match. For the
+// toplevel object, this also sets up the current factory.
+
+static unsigned long parse_header(RGeo_WKBParseState* state, VALUE contained, char* little_endian_ptr)
+{
+  unsigned char endian_value = get_byte(state);
+  char little_endian;
+  switch (endian_value) {
+  case 0:
+    little_endian = 0;
+    break;
+  case 1:
+    little_endian = 1;
+    break;
+  default:
+    rb_raise(parse_error_class(), "Bad endian byte value: %d", (int)endian_value);
+  }
+  *little_endian_ptr = little_endian;
+  unsigned long type_code = get_integer(state, little_endian);
+  char has_z = 0;
+  char has_m = 0;
+  VALUE srid = RTEST(contained) ? Qnil : state->default_srid;
+  if (state->support_ewkb) {
+    has_z = (type_code & 0x80000000) != 0;
+    has_m = (type_code & 0x40000000) != 0;
+    if (type_code & 0x20000000) {
+      srid = ULONG2NUM(get_integer(state, little_endian));
+    }
+    type_code &= 0x0fffffff;
+  }
+  if (state->support_wkb12) {
+    has_z = has_z || ((type_code / 1000) & 1) != 0;
+    has_m = has_m || ((type_code / 1000) & 2) != 0;
+    type_code %= 1000;
+  }
+  if (RTEST(contained)) {
+    if (contained != Qtrue && (unsigned long)FIX2LONG(contained) != type_code) {
+      rb_raise(parse_error_class(), "Enclosed type=%lu is different from container constraint %ld", type_code, FIX2LONG(contained));
+    }
+    if (has_z != state->cur_has_z) {
+      rb_raise(parse_error_class(), "Enclosed hasZ=%s is different from toplevel hasZ=%s", bool_str(has_z), bool_str(state->cur_has_z));
+    }
+    if (has_m != state->cur_has_m) {
+      rb_raise(parse_error_class(), "Enclosed hasM=%s is different from toplevel hasM=%s", bool_str(has_m), bool_str(state->cur_has_m));
+    }
+    if (!NIL_P(srid) && !rb_equal(srid, state->cur_srid)) {
+      VALUE srid_str = rb_obj_as_string(srid);
+      VALUE cur_srid_str = NIL_P(state->cur_srid) ? rb_str_new2("(unspecified)") : rb_obj_as_string(state->cur_srid);
+      rb_raise(parse_error_class(), "Enclosed SRID %s is different from toplevel srid %s", StringValueCStr(srid_str), StringValueCStr(cur_srid_str));
+    }
+  }
+  else {
+    state->cur_has_z = has_z;
+    state->cur_has_m = has_m;
+    state->cur_dims = 2 + (has_z ? 1 : 0) + (has_m ? 1 : 0);
+    state->cur_srid = srid;
+    VALUE opts = rb_hash_new();
+    rb_hash_aset(opts, ID2SYM(rb_intern("srid")), srid);
+    rb_hash_aset(opts, ID2SYM(rb_intern("has_z_coordinate")), has_z ? Qtrue : Qfalse);
+    rb_hash_aset(opts, ID2SYM(rb_intern("has_m_coordinate")), has_m ? Qtrue : Qfalse);
+    VALUE factory = rb_funcall(state->factory_generator, id_call, 1, opts);
+    state->cur_factory = factory;
+    char factory_has_z = RTEST(rb_funcall(factory, id_property, 1, ID2SYM(rb_intern("has_z_coordinate"))));
+    char factory_has_m = RTEST(rb_funcall(factory, id_property, 1, ID2SYM(rb_intern("has_m_coordinate"))));
+    if (has_z && !factory_has_z) {
+      rb_raise(parse_error_class(), "Data has Z coordinates but the factory doesn't have Z coordinates");
+    }
+    if (has_m && !factory_has_m) {
+      rb_raise(parse_error_class(), "Data has M coordinates but the factory doesn't have M coordinates");
+    }
+    state->cur_factory_dims = 2 + (factory_has_z ? 1 : 0) + (factory_has_m ? 1 : 0);
+    state->cur_bulk = state->cur_factory_dims <= 3 &&
+      rb_respond_to(factory, id_line_string_from_coordinates) &&
+      rb_respond_to(factory, id_polygon_from_coordinates) &&
+      rb_respond_to(factory, id_multi_point_from_coordinates);
+  }
+  return type_code;
+}
+
+
+// Parses an object. See parse_header for the contained argument.
+
+static VALUE parse_object(RGeo_WKBParseState* state, VALUE contained)
+{
+  VALUE result = Qnil;
+  char little_endian;
+  unsigned long type_code = parse_header(state, contained, &little_endian);
+  VALUE factory = state->cur_factory;
+  unsigned long count, i;
+  VALUE elems;
+  switch (type_code) {
+  case 1:
+    check_doubles(state, state->cur_dims);
+    result = parse_point_coords(state, little_endian);
+    break;
+  case 2:
+    result = parse_line_string(state, little_endian);
+    break;
+  case 3:
+    {
+      count = get_integer(state, little_endian);
+      VALUE exterior_ring;
+      elems = rb_ary_new();
+      if (count > 0 && state->cur_bulk) {
+        exterior_ring = parse_packed_coords(state, little_endian);
+        for (i=1; i<count; ++i) {
+          rb_ary_push(elems, parse_packed_coords(state, little_endian));
+        }
+        result = rb_funcall(factory, id_polygon_from_coordinates, 2, exterior_ring, elems);
+        break;
+      }
+      if (count == 0) {
+        exterior_ring = rb_funcall(factory, id_linear_ring, 1, rb_ary_new());
+      }
+      else {
+        exterior_ring = parse_line_string(state, little_endian);
+        for (i=1; i<count; ++i) {
+          rb_ary_push(elems, parse_line_string(state, little_endian));
+        }
+      }
+      result = rb_funcall(factory, id_polygon, 2, exterior_ring, elems);
+    }
+    break;
+  case 4:
+  case 5:
+  case 6:
+  case 7:
+    count = get_integer(state, little_endian);
+    if (type_code == 4 && state->cur_bulk) {
+      // Each element point takes at least a header and its coordinates.
+      if ((unsigned long)(state->len - state->pos) / (5 + 8 * state->cur_dims) < count) {
+        rb_raise(parse_error_class(), "Not enough bytes left to fulfill %lu points", count);
+      }
+      VALUE coords = rb_str_new(NULL, count * state->cur_factory_dims * sizeof(double));
+      double* coord_ptr = (double*)RSTRING_PTR(coords);
+      for (i=0; i<count; ++i) {
+        char elem_little_endian;
+        parse_header(state, INT2FIX(1), &elem_little_endian);
+        check_doubles(state, state->cur_dims);
+        coord_ptr[i*state->cur_factory_dims+state->cur_factory_dims-1] = 0;
+        get_doubles(state, elem_little_endian, state->cur_dims, coord_ptr + i*state->cur_factory_dims);
+      }
+      result = rb_funcall(factory, id_multi_point_from_coordinates, 1, coords);
+      break;
+    }
+    elems = rb_ary_new();
+    for (i=0; i<count; ++i) {
+      rb_ary_push(elems, parse_object(state, type_code == 7 ? Qtrue : INT2FIX(type_code - 3)));
+    }
+    switch (type_code) {
+    case 4:
+      result = rb_funcall(factory, id_multi_point, 1, elems);
+      break;
+    case 5:
+      result = rb_funcall(factory, id_multi_line_string, 1, elems);
+      break;
+    case 6:
+      result = rb_funcall(factory, id_multi_polygon, 1, elems);
+      break;
+    default:
+      result = rb_funcall(factory, id_collection, 1, elems);
+      break;
+    }
+    break;
+  default:
+    rb_raise(parse_error_class(), "Unknown type value: %lu.", type_code);
+  }
+  return result;
+}
+
+
+static void emit_bytes(RGeo_WKBGenerateState* state, const unsigned char* bytes, long len)
+{
+  rb_str_buf_cat(state->buffer, (const char*)bytes, len);
+}
+
+
+static void emit_integer(RGeo_WKBGenerateState* state, unsigned long value)
+{
+  unsigned char bytes[4];
+  int i;
+  for (i=0; i<4; ++i) {
+    bytes[state->little_endian ? i : 3-i] = (unsigned char)((value >> (8*i)) & 0xff);
+  }
+  emit_bytes(state, bytes, 4);
+}
+
+
+static void emit_point_coords(RGeo_WKBGenerateState* state, VALUE point)
+{
+  double coords[4];
+  unsigned char bytes[32];
+  int dims = 0;
+  int i, j;
+  coords[dims++] = rb_num2dbl(rb_funcall(point, id_x, 0));
+  coords[dims++] = rb_num2dbl(rb_funcall(point, id_y, 0));
+  if (state->cur_has_z) {
+    coords[dims++] = rb_num2dbl(rb_funcall(point, id_z, 0));
+  }
+  if (state->cur_has_m) {
+    coords[dims++] = rb_num2dbl(rb_funcall(point, id_m, 0));
+  }
+  for (i=0; i<dims; ++i) {
+    uint64_t bits;
+    memcpy(&bits, coords + i, 8);
+    for (j=0; j<8; ++j) {
+      bytes[i*8 + (state->little_endian ? j : 7-j)] = (unsigned char)((bits >> (8*j)) & 0xff);
+    }
+  }
+  emit_bytes(state, bytes, dims * 8);
+}
+
+
+static void emit_line_string_coords(RGeo_WKBGenerateState* state, VALUE line_string)
+{
+  VALUE points = rb_funcall(line_string, id_points, 0);
+  Check_Type(points, T_ARRAY);
+  long len = RARRAY_LEN(points);
+  long i;
+  emit_integer(state, (unsigned long)len);
+  for (i=0; i<len; ++i) {
+    emit_point_coords(state, rb_ary_entry(points, i));
+  }
+}
+
+
+static void generate_feature(RGeo_WKBGenerateState* state, VALUE obj, char toplevel)
+{
+  unsigned char endian_byte = state->little_endian ? 1 : 0;
+  emit_bytes(state, &endian_byte, 1);
+  VALUE type = rb_funcall(obj, id_geometry_type, 0);
+  VALUE type_code_value = rb_hash_aref(state->type_codes, type);
+  if (NIL_P(type_code_value)) {
+    VALUE type_str = rb_obj_as_string(type);
+    rb_raise(parse_error_class(), "Unrecognized Geometry Type: %s", StringValueCStr(type_str));
+  }
+  unsigned long base_type_code = NUM2ULONG(type_code_value);
+  unsigned long type_code = base_type_code;
+  char emit_srid = 0;
+  if (state->ewkb) {
+    if (state->cur_has_z) {
+      type_code |= 0x80000000;
+    }
+    if (state->cur_has_m) {
+      type_code |= 0x40000000;
+    }
+    if (state->emit_ewkb_srid && toplevel) {
+      type_code |= 0x20000000;
+      emit_srid = 1;
+    }
+  }
+  else if (state->wkb12) {
+    if (state->cur_has_z) {
+      type_code += 1000;
+    }
+    if (state->cur_has_m) {
+      type_code += 2000;
+    }
+  }
+  emit_integer(state, type_code);
+  if (emit_srid) {
+    emit_integer(state, (unsigned long)NUM2LONG(rb_funcall(obj, id_srid, 0)));
+  }
+  long i, len;
+  switch (base_type_code) {
+  case 1:
+    emit_point_coords(state, obj);
+    break;
+  case 2:
+    emit_line_string_coords(state, obj);
+    break;
+  case 3:
+    {
+      VALUE exterior_ring = rb_funcall(obj, id_exterior_ring, 0);
+      if (RTEST(rb_funcall(exterior_ring, id_is_empty, 0))) {
+        emit_integer(state, 0);
+      }
+      else {
+        VALUE interior_rings = rb_funcall(obj, id_interior_rings, 0);
+        Check_Type(interior_rings, T_ARRAY);
+        len = RARRAY_LEN(interior_rings);
+        emit_integer(state, (unsigned long)(1 + len));
+        emit_line_string_coords(state, exterior_ring);
+        for (i=0; i<len; ++i) {
+          emit_line_string_coords(state, rb_ary_entry(interior_rings, i));
+        }
+      }
+    }
+    break;
+  case 4:
+  case 5:
+  case 6:
+  case 7:
+    len = NUM2LONG(rb_funcall(obj, id_num_geometries, 0));
+    emit_integer(state, (unsigned long)len);
+    for (i=0; i<len; ++i) {
+      generate_feature(state, rb_funcall(obj, id_geometry_n, 1, LONG2NUM(i)), 0);
+    }
+    break;
+  }
+}
+
+
+// Encodes a string in lower case hex, the same as String#unpack("H*").
+
+static VALUE encode_hex(VALUE str)
+{
+  static const char digits[] = "0123456789abcdef";
+  long len = RSTRING_LEN(str);
+  VALUE result = rb_str_new(NULL, len * 2);
+  const unsigned char* src = (const unsigned char*)RSTRING_PTR(str);
+  char* dest = RSTRING_PTR(result);
+  long i;
+  for (i=0; i<len; ++i) {
+    dest[i*2] = digits[src[i] >> 4];
+    dest[i*2+1] = digits[src[i] & 15];
+  }
+  return result;
+}
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+static VALUE method_wkb_parser_parse_native(VALUE self, VALUE data)
+{
+  Check_Type(data, T_STRING);
+  if (RSTRING_LEN(data) > 0 && isxdigit((unsigned char)RSTRING_PTR(data)[0])) {
+    data = decode_hex(data);
+  }
+  RGeo_WKBParseState state;
+  state.data = (const unsigned char*)RSTRING_PTR(data);
+  state.len = RSTRING_LEN(data);
+  state.pos = 0;
+  state.factory_generator = rb_iv_get(self, "@factory_generator");
+  state.support_ewkb = RTEST(rb_iv_get(self, "@support_ewkb"));
+  state.support_wkb12 = RTEST(rb_iv_get(self, "@support_wkb12"));
+  state.default_srid = rb_iv_get(self, "@default_srid");
+  state.cur_has_z = 0;
+  state.cur_has_m = 0;
+  state.cur_dims = 2;
+  state.cur_srid = Qnil;
+  state.cur_factory = Qnil;
+  state.cur_bulk = 0;
+  state.cur_factory_dims = 2;
+  VALUE result = parse_object(&state, Qfalse);
+  if (!RTEST(rb_iv_get(self, "@ignore_extra_bytes")) && state.pos < state.len) {
+    rb_raise(parse_error_class(), "Found %ld extra bytes at the end of the stream.", state.len - state.pos);
+  }
+  RB_GC_GUARD(data);
+  return result;
+}
+
+
+static VALUE method_wkb_generator_generate_native(VALUE self, VALUE obj)
+{
+  RGeo_WKBGenerateState state;
+  VALUE type_format = rb_iv_get(self, "@type_format");
+  state.buffer = rb_str_buf_new(64);
+  state.type_codes = rb_const_get(rgeo_wkb_generator_class, rb_intern("TYPE_CODES"));
+  state.little_endian = RTEST(rb_iv_get(self, "@little_endian"));
+  state.ewkb = type_format == ID2SYM(rb_intern("ewkb"));
+  state.wkb12 = type_format == ID2SYM(rb_intern("wkb12"));
+  state.emit_ewkb_srid = RTEST(rb_iv_get(self, "@emit_ewkb_srid"));
+  state.cur_has_z = 0;
+  state.cur_has_m = 0;
+  if (state.ewkb || state.wkb12) {
+    VALUE factory = rb_funcall(obj, id_factory, 0);
+    state.cur_has_z = RTEST(rb_funcall(factory, id_property, 1, ID2SYM(rb_intern("has_z_coordinate"))));
+    state.cur_has_m = RTEST(rb_funcall(factory, id_property, 1, ID2SYM(rb_intern("has_m_coordinate"))));
+  }
+  generate_feature(&state, obj, 1);
+  return RTEST(rb_iv_get(self, "@hex_format")) ? encode_hex(state.buffer) : state.buffer;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_wkrep_wkb(VALUE wkrep_module)
+{
+  id_call = rb_intern("call");
+  id_property = rb_intern("property");
+  id_point = rb_intern("point");
+  id_line_string = rb_intern("line_string");
+  id_linear_ring = rb_intern("linear_ring");
+  id_polygon = rb_intern("polygon");
+  id_multi_point = rb_intern("multi_point");
+  id_line_string_from_coordinates = rb_intern("line_string_from_coordinates");
+  id_polygon_from_coordinates = rb_intern("polygon_from_coordinates");
+  id_multi_point_from_coordinates = rb_intern("multi_point_from_coordinates");
+  id_multi_line_string = rb_intern("multi_line_string");
+  id_multi_polygon = rb_intern("multi_polygon");
+  id_collection = rb_intern("collection");
+  id_factory = rb_intern("factory");
+  id_geometry_type = rb_intern("geometry_type");
+  id_srid = rb_intern("srid");
+  id_x = rb_intern("x");
+  id_y = rb_intern("y");
+  id_z = rb_intern("z");
+  id_m = rb_intern("m");
+  id_points = rb_intern("points");
+  id_exterior_ring = rb_intern("exterior_ring");
+  id_interior_rings = rb_intern("interior_rings");
+  id_is_empty = rb_intern("is_empty?");
+  id_num_geometries = rb_intern("num_geometries");
+  id_geometry_n = rb_intern("geometry_n");
+  
+  VALUE wkb_parser_class = rb_const_get_at(wkrep_module, rb_intern("WKBParser"));
+  rb_define_method(wkb_parser_class, "_parse_native", method_wkb_parser_parse_native, 1);
+  
+  rgeo_wkb_generator_class = rb_const_get_at(wkrep_module, rb_intern("WKBGenerator"));
+  rb_gc_register_address(&rgeo_wkb_generator_class);
+  rb_define_method(rgeo_wkb_generator_class, "_generate_native", method_wkb_generator_generate_native, 1);
+}
+
+
+RGEO_END_C
@@ -0,0 +1,369 @@
+/*
+  -----------------------------------------------------------------------------
+  
+  WKT tokenizer for native WKRep implementation
+  
+  -----------------------------------------------------------------------------
+  Copyright 2010 Daniel Azuma
+  
+  All rights reserved.
+  
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+  
+  * Redistributions of source code must retain the above copyright notice,
+    this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+  * Neither the name of the copyright holder, nor the names of any other
+    contributors to this software, may be used to endorse or promote products
+    derived from this software without specific prior written permission.
+  
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+  -----------------------------------------------------------------------------
+*/
+
+
+#include "preface.h"
+
+#include <string.h>
+#include <ruby.h>
+
+#include "wkt.h"
+
+RGEO_BEGIN_C
+
+
+/**** INTERNAL DATA ****/
+
+
+// Scanner state. The string is expected to be already downcased.
+
+typedef struct {
+  VALUE str;
+  long pos;
+} RGeo_WKTScannerData;
+
+
+#define RGEO_WKT_SCANNER_DATA_PTR(obj) ((RGeo_WKTScannerData*)DATA_PTR(obj))
+
+
+static VALUE sym_comma;
+static VALUE sym_begin;
+static VALUE sym_end;
+
+
+/**** INTERNAL UTILITY FUNCTIONS ****/
+
+
+static int is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+
+static int is_delimiter(char c)
+{
+  return c == '(' || c == ')' || c == '[' || c == ']' || c == ',';
+}
+
+
+static int is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+
+// Returns true if the token matches /^[-+]?(\d+(\.\d*)?|\.\d+)(e[-+]?\d+)?$/
+
+static int is_number(const char* p, long len)
+{
+  long i = 0;
+  long digits = 0;
+  if (i < len && (p[i] == '-' || p[i] == '+')) {
+    ++i;
+  }
+  while (i < len && is_digit(p[i])) {
+    ++i;
+    ++digits;
+  }
+  if (i < len && p[i] == '.') {
+    ++i;
+    while (i < len && is_digit(p[i])) {
+      ++i;
+      ++digits;
+    }
+  }
+  if (digits == 0) {
+    return 0;
+  }
+  if (i < len && p[i] == 'e') {
+    ++i;
+    if (i < len && (p[i] == '-' || p[i] == '+')) {
+      ++i;
+    }
+    digits = 0;
+    while (i < len && is_digit(p[i])) {
+      ++i;
+      ++digits;
+    }
+    if (digits == 0) {
+      return 0;
+    }
+  }
+  return i == len;
+}
+
+
+static int is_word(const char* p, long len)
+{
+  long i;
+  for (i=0; i<len; ++i) {
+    if (p[i] < 'a' || p[i] > 'z') {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+
+// Returns the position of the first non-space character at or after pos.
+
+static long skip_spaces(const char* str, long len, long pos)
+{
+  while (pos < len && is_space(str[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+
+// Returns the length of the word token starting at p, which runs until
+// the next space or delimiter. The token is at least one character.
+
+static long word_length(const char* p, long len)
+{
+  long token_len = 1;
+  while (token_len < len && !is_space(p[token_len]) && !is_delimiter(p[token_len])) {
+    ++token_len;
+  }
+  return token_len;
+}
+
+
+// Converts a token that is_number has accepted.
+
+static double token_to_dbl(const char* p, long len)
+{
+  char buf[64];
+  if (len < (long)sizeof(buf)) {
+    memcpy(buf, p, len);
+    buf[len] = 0;
+    return rb_cstr_to_dbl(buf, 0);
+  }
+  return rb_str_to_dbl(rb_str_new(p, len), 0);
+}
+
+
+static VALUE parse_error_class(void)
+{
+  VALUE error_module = rb_const_get(rb_define_module("RGeo"), rb_intern("Error"));
+  return rb_const_get(error_module, rb_intern("ParseError"));
+}
+
+
+// Ruby callbacks
+
+static void mark_scanner_func(RGeo_WKTScannerData* data)
+{
+  rb_gc_mark(data->str);
+}
+
+
+static void destroy_scanner_func(RGeo_WKTScannerData* data)
+{
+  free(data);
+}
+
+
+/**** RUBY METHOD DEFINITIONS ****/
+
+
+static VALUE alloc_scanner(VALUE klass)
+{
+  VALUE result = Qnil;
+  RGeo_WKTScannerData* data = ALLOC(RGeo_WKTScannerData);
+  if (data) {
+    data->str = Qnil;
+    data->pos = 0;
+    result = Data_Wrap_Struct(klass, mark_scanner_func, destroy_scanner_func, data);
+  }
+  return result;
+}
+
+
+static VALUE method_scanner_initialize(VALUE self, VALUE str)
+{
+  Check_Type(str, T_STRING);
+  RGeo_WKTScannerData* self_data = RGEO_WKT_SCANNER_DATA_PTR(self);
+  self_data->str = str;
+  self_data->pos = 0;
+  return self;
+}
+
+
+// Returns the next token, using the same rules as the ruby tokenizer:
+// a Float for a number, a String for a word, :comma, :begin, or :end for
+// punctuation, or nil at the end of the input.
+
+static VALUE method_scanner_next_token(VALUE self)
+{
+  RGeo_WKTScannerData* self_data = RGEO_WKT_SCANNER_DATA_PTR(self);
+  VALUE result = Qnil;
+  if (NIL_P(self_data->str)) {
+    return result;
+  }
+  const char* str = RSTRING_PTR(self_data->str);
+  long len = RSTRING_LEN(self_data->str);
+  long pos = skip_spaces(str, len, self_data->pos);
+  if (pos < len) {
+    const char* token = str + pos;
+    long token_len = 1;
+    switch (*token) {
+    case ',':
+      result = sym_comma;
+      break;
+    case '(':
+    case '[':
+      result = sym_begin;
+      break;
+    case ')':
+    case ']':
+      result = sym_end;
+      break;
+    default:
+      token_len = word_length(token, len - pos);
+      if (is_number(token, token_len)) {
+        result = rb_float_new(token_to_dbl(token, token_len));
+      }
+      else if (is_word(token, token_len)) {
+        result = rb_str_new(token, token_len);
+      }
+      else {
+        VALUE token_str = rb_inspect(rb_str_new(token, token_len));
+        rb_raise(parse_error_class(), "Bad token: %s", StringValueCStr(token_str));
+      }
+      break;
+    }
+    pos += token_len;
+  }
+  self_data->pos = pos;
+  return result;
+}
+
+
+// Reads number tokens starting at the given position as long as they
+// continue, appends them as Floats to the given array, and returns the
+// position after the last number read.
+
+static long scan_numbers(const char* str, long len, long pos, VALUE array)
+{
+  while (1) {
+    long start = skip_spaces(str, len, pos);
+    if (start >= len || is_delimiter(str[start])) {
+      break;
+    }
+    long token_len = word_length(str + start, len - start);
+    if (!is_number(str + start, token_len)) {
+      break;
+    }
+    rb_ary_push(array, rb_float_new(token_to_dbl(str + start, token_len)));
+    pos = start + token_len;
+  }
+  return pos;
+}
+
+
+// Reads the run of number tokens that follows, such as the remaining
+// values of a coordinate tuple, and returns them as an array of Floats.
+// Stops before the first token that is not a number, which is left for
+// next_token, so the array is empty if the next token is not a number.
+
+static VALUE method_scanner_next_numbers(VALUE self)
+{
+  RGeo_WKTScannerData* self_data = RGEO_WKT_SCANNER_DATA_PTR(self);
+  VALUE result = rb_ary_new2(4);
+  if (!NIL_P(self_data->str)) {
+    self_data->pos = scan_numbers(RSTRING_PTR(self_data->str), RSTRING_LEN(self_data->str),
+      self_data->pos, result);
+  }
+  return result;
+}
+
+
+// Reads the rest of a list of comma-separated coordinate tuples, and
+// returns an array with one array of Floats per tuple. The first tuple
+// continues from the current position, so its first value is the number
+// the caller has already read with next_token. The list ends before any
+// token other than a number or a comma that is followed by a number.
+
+static VALUE method_scanner_next_coord_list(VALUE self)
+{
+  RGeo_WKTScannerData* self_data = RGEO_WKT_SCANNER_DATA_PTR(self);
+  VALUE result = rb_ary_new();
+  if (NIL_P(self_data->str)) {
+    return result;
+  }
+  const char* str = RSTRING_PTR(self_data->str);
+  long len = RSTRING_LEN(self_data->str);
+  long pos = self_data->pos;
+  while (1) {
+    VALUE tuple = rb_ary_new2(4);
+    rb_ary_push(result, tuple);
+    pos = scan_numbers(str, len, pos, tuple);
+    long next = skip_spaces(str, len, pos);
+    if (next >= len || str[next] != ',') {
+      break;
+    }
+    next = skip_spaces(str, len, next + 1);
+    if (next >= len || is_delimiter(str[next]) ||
+        !is_number(str + next, word_length(str + next, len - next))) {
+      break;
+    }
+    pos = next;
+  }
+  self_data->pos = pos;
+  return result;
+}
+
+
+/**** INITIALIZATION FUNCTION ****/
+
+
+void rgeo_init_wkrep_wkt(VALUE wkrep_module)
+{
+  sym_comma = ID2SYM(rb_intern("comma"));
+  sym_begin = ID2SYM(rb_intern("begin"));
+  sym_end = ID2SYM(rb_intern("end"));
+  
+  VALUE wkt_scanner_class = rb_define_class_under(wkrep_module, "WKTScanner", rb_cObject);
+  rb_define_alloc_func(wkt_scanner_class, alloc_scanner);
+  rb_define_method(wkt_scanner_class, "initialize", method_scanner_initialize, 1);
+  rb_define_method(wkt_scanner_class, "next_token", method_scanner_next_token, 0);
+  rb_define_method(wkt_scanner_class, "next_numbers", method_scanner_next_numbers, 0);
+  rb_define_method(wkt_scanner_class, "next_coord_list", method_scanner_next_coord_list, 0);
+}
+
+
+RGEO_END_C
@@ -58,3 +58,6 @@ require 'rgeo/cartesian/factory'
 require 'rgeo/cartesian/interface'
 require 'rgeo/cartesian/bounding_box'
 require 'rgeo/cartesian/analysis'
+begin
+  require 'rgeo/cartesian/cartesian_c_impl'
+rescue ::LoadError; end
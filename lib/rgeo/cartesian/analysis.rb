@@ -54,8 +54,20 @@ module RGeo
         # Returns 0 if the ring is empty.
         # The return value is undefined if the object is not a ring, or
         # is not in a Cartesian coordinate system.
+        # 
+        # The result is cached for rings from the simple Cartesian
+        # implementation, so repeated calls on the same ring are cheap.
         
         def ring_direction(ring_)
+          if ring_.respond_to?(:_ring_direction)
+            ring_._ring_direction
+          else
+            _compute_ring_direction(ring_)
+          end
+        end
+        
+        
+        def _compute_ring_direction(ring_)  # :nodoc:
           size_ = ring_.num_points - 1
           return 0 if size_ == 0
           
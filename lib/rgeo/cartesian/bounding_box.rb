@@ -54,6 +54,42 @@ module RGeo
     class BoundingBox
       
       
+      # Computes a bounding box for each of the given geometries in one
+      # call, returning an array of bounding boxes in the same order.
+      # The factory and options are the same as for BoundingBox.new.
+      # 
+      # Geometries that provide packed_coordinates, such as those of the
+      # GEOS implementation, are measured together in a single native
+      # pass over their coordinate buffers when the Cartesian extension
+      # is available. Other geometries are added one at a time.
+      
+      def self.for_geometries(factory_, geometries_, opts_={})
+        bboxes_ = geometries_.map{ |geom_| new(factory_, opts_) }
+        packed_ = []
+        indexes_ = []
+        native_ = respond_to?(:_native_coordinate_bounds_list)
+        geometries_.each_with_index do |geom_, i_|
+          geom_ = Feature.cast(geom_, factory_) unless geom_.factory == factory_
+          next unless geom_
+          if native_ && geom_.respond_to?(:packed_coordinates)
+            packed_ << geom_.packed_coordinates
+            indexes_ << i_
+          else
+            bboxes_[i_]._add_geometry(geom_)
+          end
+        end
+        unless packed_.empty?
+          dims_ = 2
+          dims_ += 1 if factory_.property(:has_z_coordinate)
+          dims_ += 1 if factory_.property(:has_m_coordinate)
+          _native_coordinate_bounds_list(packed_, dims_).each_with_index do |bounds_, j_|
+            bboxes_[indexes_[j_]]._add_bounds(bounds_)
+          end
+        end
+        bboxes_
+      end
+      
+      
       # Create a new empty bounding box with the given factory.
       # 
       # The factory defines the coordinate system for the bounding box,
@@ -216,7 +252,37 @@ module RGeo
           if geometry_.factory == @factory
             _add_geometry(geometry_)
           else
-            _add_geometry(Factory.cast(geometry_, @factory))
+            _add_geometry(Feature.cast(geometry_, @factory))
+          end
+        end
+        self
+      end
+      
+      
+      # Adjusts the extents of this bounding box to encompass the given
+      # coordinates, without creating any point objects. The coordinates
+      # may be given either as a flat array of numbers or as a String of
+      # packed native doubles, as returned by the GEOS implementation's
+      # packed_coordinates method. Each coordinate consists of X and Y,
+      # followed by Z if the factory supports Z, then M if the factory
+      # supports M. Returns self.
+      
+      def add_coordinates(coords_)
+        dims_ = 2
+        dims_ += 1 if @factory.property(:has_z_coordinate)
+        dims_ += 1 if @factory.property(:has_m_coordinate)
+        if BoundingBox.respond_to?(:_native_coordinate_bounds)
+          _add_bounds(BoundingBox._native_coordinate_bounds(coords_, dims_))
+        else
+          coords_ = coords_.unpack('d*') if coords_.kind_of?(::String)
+          count_ = coords_.size / dims_
+          if count_ > 0
+            bounds_ = []
+            dims_.times do |d_|
+              values_ = (0...count_).map{ |i_| coords_[i_ * dims_ + d_] }
+              bounds_ << values_.min << values_.max
+            end
+            _add_bounds(bounds_)
           end
         end
         self
@@ -242,7 +308,7 @@ module RGeo
             if @min_x == @max_x || @min_y == @max_y
               @factory.line(point_min_, point_max_)
             else
-              @factory.polygon(@factory.linear_ring(point_min_, @factory.point(@max_x, @min_y, *extras_), point_max_, @factory.point(@min_x, @max_y, *extras_), point_min_))
+              @factory.polygon(@factory.linear_ring([point_min_, @factory.point(@max_x, @min_y, *extras_), point_max_, @factory.point(@min_x, @max_y, *extras_), point_min_]))
             end
           end
         else
@@ -283,6 +349,10 @@ module RGeo
       
       
       def _add_geometry(geometry_)  # :nodoc:
+        if geometry_.respond_to?(:_coordinate_bounds)
+          _add_bounds(geometry_._coordinate_bounds)
+          return
+        end
         case geometry_
         when Feature::Point
           _add_point(geometry_)
@@ -302,6 +372,39 @@ module RGeo
       end
       
       
+      # Merges an array of bounds as computed by _coordinate_bounds or
+      # _native_coordinate_bounds: the minimum and maximum of X, Y, then
+      # Z and M if the factory supports them. A nil array is ignored.
+      
+      def _add_bounds(bounds_)  # :nodoc:
+        return unless bounds_
+        index_ = 4
+        if @factory.property(:has_z_coordinate)
+          z_index_ = index_
+          index_ += 2
+        end
+        m_index_ = index_ if @factory.property(:has_m_coordinate)
+        if @min_x
+          @min_x = bounds_[0] if bounds_[0] < @min_x
+          @max_x = bounds_[1] if bounds_[1] > @max_x
+          @min_y = bounds_[2] if bounds_[2] < @min_y
+          @max_y = bounds_[3] if bounds_[3] > @max_y
+          if @has_z
+            @min_z = bounds_[z_index_] if bounds_[z_index_] < @min_z
+            @max_z = bounds_[z_index_+1] if bounds_[z_index_+1] > @max_z
+          end
+          if @has_m
+            @min_m = bounds_[m_index_] if bounds_[m_index_] < @min_m
+            @max_m = bounds_[m_index_+1] if bounds_[m_index_+1] > @max_m
+          end
+        else
+          @min_x, @max_x, @min_y, @max_y = bounds_[0], bounds_[1], bounds_[2], bounds_[3]
+          @min_z, @max_z = bounds_[z_index_], bounds_[z_index_+1] if @has_z
+          @min_m, @max_m = bounds_[m_index_], bounds_[m_index_+1] if @has_m
+        end
+      end
+      
+      
       def _add_point(point_)  # :nodoc:
         if @min_x
           x_ = point_.x
@@ -153,6 +153,52 @@ module RGeo
       end
       
       
+      # Yields each pair of indexes (i, j), with i < j, of segments in the
+      # given array whose bounding boxes overlap. Candidates are found by
+      # sweeping along the x axis, so segments that are far apart in x
+      # are never compared.
+      
+      def self.each_overlapping_pair(segs_)
+        order_ = (0...segs_.size).sort_by{ |i_| segs_[i_]._min_x }
+        active_ = []
+        order_.each do |cur_|
+          seg_ = segs_[cur_]
+          min_x_ = seg_._min_x
+          min_y_ = seg_._min_y
+          max_y_ = seg_._max_y
+          active_.reject!{ |i_| segs_[i_]._max_x < min_x_ }
+          active_.each do |i_|
+            oseg_ = segs_[i_]
+            if oseg_._min_y <= max_y_ && min_y_ <= oseg_._max_y
+              if i_ < cur_
+                yield(i_, cur_)
+              else
+                yield(cur_, i_)
+              end
+            end
+          end
+          active_ << cur_
+        end
+      end
+      
+      
+      def _min_x  # :nodoc:
+        @sx < @ex ? @sx : @ex
+      end
+      
+      def _max_x  # :nodoc:
+        @sx < @ex ? @ex : @sx
+      end
+      
+      def _min_y  # :nodoc:
+        @sy < @ey ? @sy : @ey
+      end
+      
+      def _max_y  # :nodoc:
+        @sy < @ey ? @ey : @sy
+      end
+      
+      
     end
     
     
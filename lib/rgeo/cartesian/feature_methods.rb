@@ -48,7 +48,7 @@ module RGeo
       
       
       def envelope
-        BoundingBox.new(factory).add(self).to_geometry
+        @envelope ||= BoundingBox.new(factory).add(self).to_geometry
       end
       
       
@@ -69,33 +69,45 @@ module RGeo
       
       
       def is_simple?
+        unless defined?(@is_simple)
+          @is_simple = _compute_is_simple
+        end
+        @is_simple
+      end
+      
+      
+      def _compute_is_simple  # :nodoc:
+        if Analysis.respond_to?(:_native_line_string_simple?)
+          return Analysis._native_line_string_simple?(@points)
+        end
         segs_ = _segments
         len_ = segs_.length
         return false if segs_.any?{ |a_| a_.degenerate? }
         return true if len_ == 1
         return segs_[0].s != segs_[1].e if len_ == 2
-        segs_.each_with_index do |seg_, index_|
-          nindex_ = index_ + 1
-          nindex_ = nil if nindex_ == len_
-          return false if nindex_ && seg_.contains_point?(segs_[nindex_].e)
-          pindex_ = index_ - 1
-          pindex_ = nil if pindex_ < 0
-          return false if pindex_ && seg_.contains_point?(segs_[pindex_].s)
-          if nindex_
-            oindex_ = nindex_ + 1
-            while oindex_ < len_
-              oseg_ = segs_[oindex_]
-              return false if !(index_ == 0 && oindex_ == len_-1 && seg_.s == oseg_.e) && seg_.intersects_segment?(oseg_)
-              oindex_ += 1
-            end
-          end
+        (len_ - 1).times do |i_|
+          return false if segs_[i_].contains_point?(segs_[i_+1].e)
+          return false if segs_[i_+1].contains_point?(segs_[i_].s)
+        end
+        closed_ = len_ > 0 && segs_[0].s == segs_[len_-1].e
+        Segment.each_overlapping_pair(segs_) do |i_, j_|
+          next if j_ - i_ < 2 || i_ == 0 && j_ == len_-1 && closed_
+          return false if segs_[i_].intersects_segment?(segs_[j_])
         end
         true
       end
       
       
       def length
-        @segments.inject(0.0){ |sum_, seg_| sum_ + seg_.length }
+        @length ||= _segments.inject(0.0){ |sum_, seg_| sum_ + seg_.length }
+      end
+      
+      
+      def _ring_direction  # :nodoc:
+        unless defined?(@ring_direction)
+          @ring_direction = Analysis._compute_ring_direction(self)
+        end
+        @ring_direction
       end
       
       
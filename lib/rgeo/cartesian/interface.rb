@@ -89,6 +89,10 @@ module RGeo
       # Unimplemented operations may raise Error::UnsupportedOperation
       # if invoked.
       # 
+      # Factories are shared: a later call with an equal set of options
+      # returns the same factory, unless some option values are objects
+      # such as an SRS database.
+      # 
       # Options include:
       # 
       # [<tt>:srid</tt>]
@@ -132,7 +136,9 @@ module RGeo
       #   for WKRep::WKBGenerator.
       
       def simple_factory(opts_={})
-        Cartesian::Factory.new(opts_)
+        Feature::FactoryGenerator._intern(:simple_cartesian, opts_) do
+          Cartesian::Factory.new(opts_)
+        end
       end
       
       
@@ -150,6 +156,18 @@ module RGeo
       alias_method :factory_generator, :preferred_factory_generator
       
       
+      # Returns a Feature::FactoryGenerator that creates preferred
+      # factories, and returns the same factory again for later requests
+      # with the same configuration. See
+      # Feature::FactoryGenerator.memoize. One such generator is shared
+      # by the whole process; it is the default generator used by the
+      # WKT and WKB parsers.
+      
+      def memoized_factory_generator
+        @memoized_factory_generator ||= Feature::FactoryGenerator.memoize(method(:preferred_factory))
+      end
+      
+      
       # Returns a Feature::FactoryGenerator that creates simple factories.
       # The given options are used as the default options.
       # 
@@ -73,6 +73,8 @@ require 'rgeo/coord_sys/cs/factories'
 require 'rgeo/coord_sys/cs/entities'
 require 'rgeo/coord_sys/cs/wkt_parser'
 require 'rgeo/coord_sys/srs_database/interface.rb'
+require 'rgeo/coord_sys/srs_database/cache.rb'
+require 'rgeo/coord_sys/srs_database/http_connection.rb'
 require 'rgeo/coord_sys/srs_database/active_record_table.rb'
 require 'rgeo/coord_sys/srs_database/proj4_data.rb'
 require 'rgeo/coord_sys/srs_database/url_reader.rb'
@@ -83,6 +83,20 @@ module RGeo
       alias_method :==, :eql?
       
       
+      # Marshal support. A Proj4 is dumped as its definition string and
+      # its radians setting.
+      
+      def _dump(level_)  # :nodoc:
+        ::Marshal.dump([original_str || canonical_str, _radians?])
+      end
+      
+      
+      def self._load(str_)  # :nodoc:
+        defn_, radians_ = ::Marshal.load(str_)
+        new(defn_, :radians => radians_)
+      end
+      
+      
       # Returns the "canonical" string definition for this coordinate
       # system, as reported by Proj4. This may be slightly different
       # from the definition used to construct this object.
@@ -231,6 +245,25 @@ module RGeo
         end
         
         
+        # Low-level batch coordinate transform method.
+        # Transforms a whole sequence of coordinates from one proj4
+        # coordinate system to another using a single call into proj.
+        # The coordinates should be given as a flat array of numbers
+        # (x1, y1, x2, y2, ...), or if has_z is true, as a flat array of
+        # triples (x1, y1, z1, x2, y2, z2, ...). Returns a flat array of
+        # the same layout. If a particular point could not be
+        # transformed, its coordinates are set to nil.
+        # 
+        # You may also pass a String of packed native-endian doubles (as
+        # produced by <tt>Array#pack("d*")</tt>), in which case a String
+        # of the same layout is returned, and points that could not be
+        # transformed have their coordinates set to NaN.
+        
+        def transform_coords_array(from_proj_, to_proj_, coords_, has_z_=false)
+          _transform_coords_array(from_proj_, to_proj_, coords_, has_z_)
+        end
+        
+        
         # Low-level geometry transform method.
         # Transforms the given geometry between the given two projections.
         # The resulting geometry is constructed using the to_factory.
@@ -238,19 +271,25 @@ module RGeo
         # ignored.
         
         def transform(from_proj_, from_geometry_, to_proj_, to_factory_)
+          if defined?(Geos::GeometryImpl) && from_geometry_.kind_of?(Geos::GeometryImpl) &&
+              to_factory_.kind_of?(Geos::Factory)
+          then
+            result_ = to_factory_._project_geometry(from_proj_, from_geometry_, to_proj_)
+            return result_ unless result_ == false
+          end
           case from_geometry_
           when Feature::Point
             _transform_point(from_proj_, from_geometry_, to_proj_, to_factory_)
           when Feature::Line
-            to_factory_.line(from_geometry_.points.map{ |p_| _transform_point(from_proj_, p_, to_proj_, to_factory_) })
+            to_factory_.line(_transform_points(from_proj_, from_geometry_.points, to_proj_, to_factory_))
           when Feature::LinearRing
             _transform_linear_ring(from_proj_, from_geometry_, to_proj_, to_factory_)
           when Feature::LineString
-            to_factory_.line_string(from_geometry_.points.map{ |p_| _transform_point(from_proj_, p_, to_proj_, to_factory_) })
+            to_factory_.line_string(_transform_points(from_proj_, from_geometry_.points, to_proj_, to_factory_))
           when Feature::Polygon
             _transform_polygon(from_proj_, from_geometry_, to_proj_, to_factory_)
           when Feature::MultiPoint
-            to_factory_.multi_point(from_geometry_.map{ |p_| _transform_point(from_proj_, p_, to_proj_, to_factory_) })
+            to_factory_.multi_point(_transform_points(from_proj_, from_geometry_.to_a, to_proj_, to_factory_))
           when Feature::MultiLineString
             to_factory_.multi_line_string(from_geometry_.map{ |g_| transform(from_proj_, g_, to_proj_, to_factory_) })
           when Feature::MultiPolygon
@@ -262,35 +301,44 @@ module RGeo
         
         
         def _transform_point(from_proj_, from_point_, to_proj_, to_factory_)  # :nodoc:
-          from_factory_ = from_point_.factory
+          _transform_points(from_proj_, [from_point_], to_proj_, to_factory_)[0]
+        end
+        
+        
+        def _transform_points(from_proj_, from_points_, to_proj_, to_factory_)  # :nodoc:
+          return [] if from_points_.empty?
+          from_factory_ = from_points_[0].factory
           from_has_z_ = from_factory_.property(:has_z_coordinate)
           from_has_m_ = from_factory_.property(:has_m_coordinate)
           to_has_z_ = to_factory_.property(:has_z_coordinate)
           to_has_m_ = to_factory_.property(:has_m_coordinate)
-          x_ = from_point_.x
-          y_ = from_point_.y
-          if !from_proj_._radians? && from_proj_._geographic?
-            x_ *= ImplHelper::Math::RADIANS_PER_DEGREE
-            y_ *= ImplHelper::Math::RADIANS_PER_DEGREE
+          coords_ = []
+          if from_has_z_
+            from_points_.each{ |p_| coords_ << p_.x << p_.y << p_.z }
+          else
+            from_points_.each{ |p_| coords_ << p_.x << p_.y }
           end
-          coords_ = _transform_coords(from_proj_, to_proj_, x_, y_, from_has_z_ ? from_point_.z : nil)
-          if coords_
-            if !to_proj_._radians? && to_proj_._geographic?
-              coords_[0] *= ImplHelper::Math::DEGREES_PER_RADIAN
-              coords_[1] *= ImplHelper::Math::DEGREES_PER_RADIAN
+          coords_ = _transform_coords_array(from_proj_, to_proj_, coords_, from_has_z_)
+          return ::Array.new(from_points_.size) unless coords_
+          dim_ = from_has_z_ ? 3 : 2
+          result_ = []
+          from_points_.each_with_index do |p_, i_|
+            x_ = coords_[i_*dim_]
+            if x_
+              extras_ = []
+              extras_ << (from_has_z_ ? coords_[i_*dim_+2].to_f : 0.0) if to_has_z_
+              extras_ << (from_has_m_ ? p_.m : 0.0) if to_has_m_
+              result_ << to_factory_.point(x_, coords_[i_*dim_+1], *extras_)
+            else
+              result_ << nil
             end
-            extras_ = []
-            extras_ << coords_[2].to_f if to_has_z_
-            extras_ << from_has_m_ ? from_point_.m : 0.0 if to_has_m_
-            to_factory_.point(coords_[0], coords_[1], *extras_)
-          else
-            nil
           end
+          result_
         end
         
         
         def _transform_linear_ring(from_proj_, from_ring_, to_proj_, to_factory_)  # :nodoc:
-          to_factory_.linear_ring(from_ring_.points[0..-2].map{ |p_| _transform_point(from_proj_, p_, to_proj_, to_factory_) })
+          to_factory_.linear_ring(_transform_points(from_proj_, from_ring_.points[0..-2], to_proj_, to_factory_))
         end
         
         
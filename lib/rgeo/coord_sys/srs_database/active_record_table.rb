@@ -106,9 +106,11 @@ module RGeo
         #   column is not part of the OGC spec, but may be included in
         #   some spatial database implementations. Default is nil.
         # [<tt>:cache</tt>]
-        #   If set to true, entries are cached when first retrieved, so
-        #   subsequent requests do not have to make a database round trip.
-        #   Default is false.
+        #   If set to true, entries are cached in memory when first
+        #   retrieved, so subsequent requests do not have to make a
+        #   database round trip. You may also pass a Cache object, which
+        #   may be shared with other databases, or a hash of options for
+        #   a new Cache. Default is false.
         # 
         # Some option settings may be provided by the ActiveRecord
         # connection adapter, if the ActiveRecord class's connection uses
@@ -120,7 +122,7 @@ module RGeo
         # use a custom table.
         
         def initialize(opts_={})
-          @cache = opts_[:cache] ? {} : nil
+          @cache = Cache.for_option(opts_[:cache])
           @ar_class = opts_[:ar_class]
           unless @ar_class
             ar_base_class_ = opts_[:ar_base_class] || ::ActiveRecord::Base
@@ -154,12 +156,13 @@ module RGeo
         
         def get(ident_)
           ident_ = ident_.to_i
-          return @cache[ident_] if @cache && @cache.include?(ident_)
+          @cache ? @cache.fetch([[:active_record_table, @ar_class.table_name], ident_]){ _get(ident_) } : _get(ident_)
+        end
+        
+        
+        def _get(ident_)  # :nodoc:
           obj_ = @ar_class.where(@srid_column => ident_).first
-          unless obj_
-            @cache[ident_] = nil if @cache
-            return nil
-          end
+          return nil unless obj_
           auth_name_ = @auth_name_column ? obj_[@auth_name_column] : nil
           auth_srid_ = @auth_srid_column ? obj_[@auth_srid_column] : nil
           name_ = @name_column ? obj_[@name_column] : nil
@@ -171,16 +174,14 @@ module RGeo
           if @proj4text_column && Proj4.supported?
             proj4_ = Proj4.create(obj_[@proj4text_column].strip) rescue nil
           end
-          result_ = Entry.new(ident_, :authority => auth_name_, :authority_code => auth_srid_, :name => name_, :description => description_, :coord_sys => coord_sys_, :proj4 => proj4_)
-          @cache[ident_] = result_ if @cache
-          result_
+          Entry.new(ident_, :authority => auth_name_, :authority_code => auth_srid_, :name => name_, :description => description_, :coord_sys => coord_sys_, :proj4 => proj4_)
         end
         
         
         # Clears the cache if a cache is active.
         
         def clear_cache
-          @cache.clear if @cache
+          @cache.clear([:active_record_table, @ar_class.table_name]) if @cache
         end
         
         
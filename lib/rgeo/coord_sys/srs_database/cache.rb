@@ -0,0 +1,188 @@
+# -----------------------------------------------------------------------------
+# 
+# SRS database cache
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+
+require 'thread'
+
+
+module RGeo
+  
+  module CoordSys
+    
+    module SRSDatabase
+      
+      
+      # A cache of spatial reference lookups that may be shared by
+      # several databases and threads. Pass an instance as the
+      # <tt>:cache</tt> option of UrlReader, SrOrg or ActiveRecordTable.
+      # Each database uses keys of the form [namespace, identifier], so
+      # one cache may serve several databases.
+      # 
+      # If several threads look up the same missing key at once, only
+      # one of them performs the lookup; the others wait for its result.
+      # 
+      # Options:
+      # 
+      # [<tt>:ttl</tt>]
+      #   The number of seconds a cached entry remains valid. Default is
+      #   nil, meaning entries never expire.
+      # [<tt>:path</tt>]
+      #   If given, the cache is loaded from the file at this path, if
+      #   it exists, and saved back to it whenever an entry is added, so
+      #   that cached entries survive a restart. Default is nil.
+      
+      class Cache
+        
+        
+        # Create a new cache. See the Cache documentation for the
+        # options that can be passed.
+        
+        def initialize(opts_={})
+          @ttl = opts_[:ttl] ? opts_[:ttl].to_f : nil
+          @path = opts_[:path] ? opts_[:path].to_s : nil
+          @mutex = ::Mutex.new
+          @loaded = ::ConditionVariable.new
+          @pending = {}
+          @data = {}
+          if @path && ::File.file?(@path)
+            @data = (::File.open(@path, 'rb'){ |file_| ::Marshal.load(file_) } rescue {})
+            @data = {} unless @data.kind_of?(::Hash)
+          end
+        end
+        
+        
+        # Returns a cache for the given <tt>:cache</tt> option of a
+        # database: the option itself if it is a Cache, a new Cache
+        # configured by it if it is a hash, a new in-memory Cache if it
+        # is otherwise true, or nil if it is false or nil.
+        
+        def self.for_option(option_)
+          case option_
+          when Cache then option_
+          when ::Hash then new(option_)
+          when nil, false then nil
+          else new
+          end
+        end
+        
+        
+        # The number of seconds entries remain valid, or nil if they
+        # never expire.
+        attr_reader :ttl
+        
+        # The path of the backing file, or nil for a memory-only cache.
+        attr_reader :path
+        
+        
+        # Returns the value cached for the given key. If there is no
+        # valid value, the block is called to compute it, and its result
+        # (even if nil) is cached and returned. Concurrent calls for
+        # the same key wait for a single call of the block. If the block
+        # raises an exception, nothing is cached, and one of the waiting
+        # threads calls its own block.
+        
+        def fetch(key_)
+          @mutex.synchronize do
+            loop do
+              record_ = @data[key_]
+              return record_[1] if record_ && (!record_[0] || record_[0] > ::Time.now.to_f)
+              break unless @pending[key_]
+              @loaded.wait(@mutex)
+            end
+            @pending[key_] = true
+          end
+          begin
+            value_ = yield
+            @mutex.synchronize do
+              @data[key_] = [@ttl ? ::Time.now.to_f + @ttl : nil, value_]
+              _save
+            end
+          ensure
+            @mutex.synchronize do
+              @pending.delete(key_)
+              @loaded.broadcast
+            end
+          end
+          value_
+        end
+        
+        
+        # Returns true if a valid value is cached for the given key.
+        
+        def include?(key_)
+          @mutex.synchronize do
+            record_ = @data[key_]
+            record_ && (!record_[0] || record_[0] > ::Time.now.to_f) ? true : false
+          end
+        end
+        
+        
+        # Removes entries, including those in the backing file. If a
+        # namespace is given, only the entries whose keys are arrays
+        # beginning with that namespace are removed; otherwise all
+        # entries are removed.
+        
+        def clear(namespace_=nil)
+          @mutex.synchronize do
+            if namespace_.nil?
+              @data.clear
+            else
+              @data.delete_if{ |key_, record_| key_.kind_of?(::Array) && key_[0] == namespace_ }
+            end
+            _save
+          end
+          self
+        end
+        
+        
+        def _save  # :nodoc:
+          return unless @path
+          temp_path_ = "#{@path}.#{::Process.pid}.#{::Thread.current.object_id}"
+          ::File.open(temp_path_, 'wb'){ |file_| ::Marshal.dump(@data, file_) }
+          ::File.rename(temp_path_, @path)
+        rescue ::SystemCallError, ::IOError, ::TypeError
+          ::File.delete(temp_path_) rescue nil
+        end
+        
+        
+      end
+      
+      
+    end
+    
+  end
+  
+end
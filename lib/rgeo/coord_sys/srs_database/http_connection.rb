@@ -0,0 +1,110 @@
+# -----------------------------------------------------------------------------
+# 
+# Persistent HTTP connection for SRS databases
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+
+require 'net/http'
+require 'thread'
+
+
+module RGeo
+  
+  module CoordSys
+    
+    module SRSDatabase
+      
+      
+      # A connection to a single HTTP host, used by the URL-based
+      # spatial reference databases. If keep-alive is requested, the
+      # connection is opened once and reused by later requests (being
+      # reopened if the server closed it); requests are serialized
+      # because Net::HTTP is not thread-safe. Otherwise, a new
+      # connection is opened for each call to start.
+      
+      class HTTPConnection  # :nodoc:
+        
+        
+        def initialize(host_, port_=nil, keep_alive_=false)
+          @host = host_
+          @port = port_
+          @keep_alive = keep_alive_
+          @mutex = ::Mutex.new
+          @http = nil
+        end
+        
+        
+        # Yields an open Net::HTTP session and returns the block's
+        # result.
+        
+        def start
+          unless @keep_alive
+            return ::Net::HTTP.start(@host, @port){ |http_| yield(http_) }
+          end
+          @mutex.synchronize do
+            retried_ = false
+            begin
+              @http = ::Net::HTTP.start(@host, @port) unless @http && @http.started?
+              yield(@http)
+            rescue ::IOError, ::EOFError, ::SystemCallError, ::Timeout::Error
+              _finish_session
+              raise if retried_
+              retried_ = true
+              retry
+            end
+          end
+        end
+        
+        
+        # Closes the kept-alive session, if one is open.
+        
+        def finish
+          @mutex.synchronize{ _finish_session }
+        end
+        
+        
+        def _finish_session  # :nodoc:
+          @http.finish if @http && @http.started? rescue nil
+          @http = nil
+        end
+        
+        
+      end
+      
+      
+    end
+    
+  end
+  
+end
@@ -77,6 +77,20 @@ module RGeo
         #   If set, its value is taken as the authority name for all
         #   entries. The authority code will be set to the identifier. If
         #   not set, then the authority fields of entries will be blank.
+        # [<tt>:index</tt>]
+        #   If set, lookups that need to read the file use an index of
+        #   identifiers to file offsets instead of scanning the whole
+        #   file. The index is stored on disk, so it is built only once
+        #   and shared by every process that uses the same data file,
+        #   and nothing but the entries you look up is held in memory.
+        #   You may pass the path for the index file as the value, or
+        #   true to store it next to the data file (or in the temp
+        #   directory if the data file's directory is not writable). The
+        #   index is rebuilt automatically if the size or modification
+        #   time of the data file changes. Lookups binary search the
+        #   index with seek and read, rather than memory-mapping it,
+        #   since Ruby has no portable way to map a file; only the
+        #   records visited by the search are read. Default is false.
         
         def initialize(filename_, opts_={})
           dir_ = nil
@@ -107,6 +121,12 @@ module RGeo
             @cache = nil
             @populate_state = 0
           end
+          if opts_[:index]
+            @index_path = _index_path(opts_[:index])
+            _with_index{ nil }
+          else
+            @index_path = nil
+          end
         end
         
         
@@ -117,8 +137,8 @@ module RGeo
           return @cache[ident_] if @cache && @cache.include?(ident_)
           result_ = nil
           if @populate_state == 0
-            data_ = _search_file(ident_)
-            result_ = Entry.new(ident_, :authority => @authority, :authority_code => @authority ? ident_ : nil, :name => data_[1], :proj4 => data_[2]) if data_
+            data_ = @index_path ? _search_index(ident_) : _search_file(ident_)
+            result_ = _make_entry(ident_, data_[1], data_[2]) if data_
             @cache[ident_] = result_ if @cache
           elsif @populate_state == 1
             _search_file(nil)
@@ -137,43 +157,166 @@ module RGeo
         end
         
         
+        def _make_entry(ident_, name_, text_)  # :nodoc:
+          Entry.new(ident_, :authority => @authority, :authority_code => @authority ? ident_ : nil, :name => name_, :proj4 => text_)
+        end
+        
+        
         def _search_file(ident_)  # :nodoc:
           ::File.open(@path) do |file_|
-            cur_name_ = nil
-            cur_ident_ = nil
-            cur_text_ = nil
-            file_.each do |line_|
-              line_.strip!
-              if (comment_delim_ = line_.index('#'))
-                cur_name_ = line_[comment_delim_+1..-1].strip
-                line_ = line_[0..comment_delim_-1].strip
+            _each_entry(file_) do |cur_ident_, name_, text_, offset_|
+              if ident_.nil?
+                @cache[cur_ident_] = _make_entry(cur_ident_, name_, text_)
+              elsif cur_ident_ == ident_
+                return [ident_, name_, text_]
               end
-              unless cur_ident_
-                if line_ =~ /^<(\w+)>(.*)/
-                  cur_ident_ = $1
-                  cur_text_ = []
-                  line_ = $2.strip
+            end
+          end
+          nil
+        end
+        
+        
+        # Parses entries from the current position of the given file,
+        # yielding the identifier, name, proj4 text, and the offset at
+        # which parsing of the entry began.
+        
+        def _each_entry(file_)  # :nodoc:
+          cur_name_ = nil
+          cur_ident_ = nil
+          cur_text_ = nil
+          offset_ = file_.pos
+          while (line_ = file_.gets)
+            line_.strip!
+            if (comment_delim_ = line_.index('#'))
+              cur_name_ = line_[comment_delim_+1..-1].strip
+              line_ = line_[0..comment_delim_-1].strip
+            end
+            unless cur_ident_
+              if line_ =~ /^<(\w+)>(.*)/
+                cur_ident_ = $1
+                cur_text_ = []
+                line_ = $2.strip
+              end
+            end
+            if cur_ident_
+              if line_[-2..-1] == '<>'
+                cur_text_ << line_[0..-3].strip
+                yield(cur_ident_, cur_name_, cur_text_.join(' '), offset_)
+                cur_ident_ = nil
+                cur_name_ = nil
+                cur_text_ = nil
+                offset_ = file_.pos
+              else
+                cur_text_ << line_
+              end
+            end
+          end
+        end
+        
+        
+        # The index file starts with a header line giving the format,
+        # the size and modification time (to the microsecond) of the
+        # data file, the number of records, and the identifier width.
+        # It is followed by fixed width records, sorted by identifier,
+        # each holding a space padded identifier and a 64-bit big-endian
+        # file offset. The offset has the layout of pack('Q>'), but is
+        # written as two 32-bit halves since Ruby 1.8.7 lacks 'Q>'.
+        
+        INDEX_FORMAT = 'RGEOIDX2'  # :nodoc:
+        
+        
+        def _index_path(index_)  # :nodoc:
+          if index_.kind_of?(::String)
+            index_
+          elsif ::File.writable?(::File.dirname(@path))
+            "#{@path}.rgeoidx"
+          else
+            require 'tmpdir'
+            ::File.join(::Dir.tmpdir, "rgeo#{::File.expand_path(@path).gsub(/[^\w\.]/, '_')}.rgeoidx")
+          end
+        end
+        
+        
+        def _index_stamp  # :nodoc:
+          stat_ = ::File.stat(@path)
+          "#{INDEX_FORMAT} #{stat_.size} #{stat_.mtime.to_i}.#{stat_.mtime.usec}"
+        end
+        
+        
+        def _build_index  # :nodoc:
+          stamp_ = _index_stamp
+          records_ = []
+          ::File.open(@path, 'rb') do |file_|
+            _each_entry(file_){ |ident_, name_, text_, offset_| records_ << [ident_, offset_] }
+          end
+          records_.sort!
+          width_ = records_.map{ |r_| r_[0].length }.max || 1
+          temp_path_ = "#{@index_path}.#{::Process.pid}"
+          ::File.open(temp_path_, 'wb') do |file_|
+            file_.write("#{stamp_} #{records_.size} #{width_}\n")
+            records_.each do |r_|
+              file_.write(r_[0].ljust(width_) + [r_[1] >> 32, r_[1] & 0xffffffff].pack('NN'))
+            end
+          end
+          ::File.rename(temp_path_, @index_path)
+        end
+        
+        
+        # Yields the open index file, the record count, and the
+        # identifier width, rebuilding the index first if it is missing
+        # or out of date. Returns the block's result.
+        
+        def _with_index  # :nodoc:
+          2.times do |attempt_|
+            _build_index if attempt_ > 0
+            begin
+              ::File.open(@index_path, 'rb') do |file_|
+                header_ = file_.gets.to_s.split(' ')
+                if header_.size == 5 && header_[0..2].join(' ') == _index_stamp
+                  return yield(file_, header_[3].to_i, header_[4].to_i)
                 end
               end
-              if cur_ident_
-                if line_[-2..-1] == '<>'
-                  cur_text_ << line_[0..-3].strip
-                  cur_text_ = cur_text_.join(' ')
-                  if ident_.nil?
-                    @cache[ident_] = Entry.new(ident_, :authority => @authority, :authority_code => @authority ? id_ : nil, :name => cur_name_, :proj4 => cur_text_)
-                  end
-                  if cur_ident_ == ident_
-                    return [ident_, cur_name_, cur_text_]
-                  end
-                  cur_ident_ = nil
-                  cur_name_ = nil
-                  cur_text_ = nil
+            rescue ::Errno::ENOENT
+            end
+          end
+          nil
+        end
+        
+        
+        def _search_index(ident_)  # :nodoc:
+          offset_ = _with_index do |file_, count_, width_|
+            if ident_.length <= width_
+              key_ = ident_.ljust(width_)
+              base_ = file_.pos
+              record_size_ = width_ + 8
+              low_ = 0
+              high_ = count_
+              while low_ < high_
+                mid_ = (low_ + high_) / 2
+                file_.seek(base_ + mid_ * record_size_)
+                if file_.read(width_) < key_
+                  low_ = mid_ + 1
                 else
-                  cur_text_ << line_
+                  high_ = mid_
+                end
+              end
+              if low_ < count_
+                file_.seek(base_ + low_ * record_size_)
+                record_ = file_.read(record_size_)
+                if record_[0, width_] == key_
+                  offset_high_, offset_low_ = record_[width_, 8].unpack('NN')
+                  (offset_high_ << 32) | offset_low_
                 end
               end
             end
           end
+          return nil unless offset_
+          ::File.open(@path, 'rb') do |file_|
+            file_.seek(offset_)
+            _each_entry(file_) do |cur_ident_, name_, text_, entry_offset_|
+              return cur_ident_ == ident_ ? [ident_, name_, text_] : nil
+            end
+          end
           nil
         end
         
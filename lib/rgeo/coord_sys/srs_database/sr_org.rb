@@ -57,13 +57,20 @@ module RGeo
         # Options:
         # 
         # [<tt>:cache</tt>]
-        #   If set to true, lookup results are cached so if the same URL
-        #   is requested again, the result is served from cache rather
-        #   than issuing another HTTP request. Default is false.
+        #   If set to true, lookup results are cached in memory so if the
+        #   same URL is requested again, the result is served from cache
+        #   rather than issuing another HTTP request. You may also pass a
+        #   Cache object, which may be shared with other databases, or a
+        #   hash of options for a new Cache, e.g. to set a TTL or an
+        #   on-disk backing file. Default is false.
+        # [<tt>:keep_alive</tt>]
+        #   If set to true, HTTP connections are kept open and reused for
+        #   later requests to the same host. Default is false.
         
         def initialize(catalog_, opts_={})
           @catalog = catalog_.to_s.downcase
-          @cache = opts_[:cache] ? {} : nil
+          @cache = Cache.for_option(opts_[:cache])
+          @connection = HTTPConnection.new('spatialreference.org', nil, opts_[:keep_alive] ? true : false)
         end
         
         
@@ -76,25 +83,27 @@ module RGeo
         
         def get(ident_)
           ident_ = ident_.to_s
-          return @cache[ident_] if @cache && @cache.include?(ident_)
+          @cache ? @cache.fetch([[:sr_org, @catalog], ident_]){ _get(ident_) } : _get(ident_)
+        end
+        
+        
+        def _get(ident_)  # :nodoc:
           coord_sys_ = nil
           proj4_ = nil
-          ::Net::HTTP.start('spatialreference.org') do |http_|
+          @connection.start do |http_|
             response_ = http_.request_get("/ref/#{@catalog}/#{ident_}/ogcwkt/")
             coord_sys_ = response_.body if response_.kind_of?(::Net::HTTPSuccess)
             response_ = http_.request_get("/ref/#{@catalog}/#{ident_}/proj4/")
             proj4_ = response_.body if response_.kind_of?(::Net::HTTPSuccess)
           end
-          result_ = Entry.new(ident_, :coord_sys => coord_sys_.strip, :proj4 => proj4_.strip)
-          @cache[ident_] = result_ if @cache
-          result_
+          Entry.new(ident_, :coord_sys => coord_sys_.strip, :proj4 => proj4_.strip)
         end
         
         
         # Clear the cache if one exists.
         
         def clear_cache
-          @cache.clear if @cache
+          @cache.clear([:sr_org, @catalog]) if @cache
         end
         
         
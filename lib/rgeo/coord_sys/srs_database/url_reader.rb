@@ -55,12 +55,21 @@ module RGeo
         # Options:
         # 
         # [<tt>:cache</tt>]
-        #   If set to true, lookup results are cached so if the same URL
-        #   is requested again, the result is served from cache rather
-        #   than issuing another HTTP request. Default is false.
+        #   If set to true, lookup results are cached in memory so if the
+        #   same URL is requested again, the result is served from cache
+        #   rather than issuing another HTTP request. You may also pass a
+        #   Cache object, which may be shared with other databases, or a
+        #   hash of options for a new Cache, e.g. to set a TTL or an
+        #   on-disk backing file. Default is false.
+        # [<tt>:keep_alive</tt>]
+        #   If set to true, HTTP connections are kept open and reused for
+        #   later requests to the same host. Default is false.
         
         def initialize(opts_={})
-          @cache = opts_[:cache] ? {} : nil
+          @cache = Cache.for_option(opts_[:cache])
+          @keep_alive = opts_[:keep_alive] ? true : false
+          @connections = {}
+          @mutex = ::Mutex.new
         end
         
         
@@ -70,10 +79,14 @@ module RGeo
         
         def get(ident_)
           ident_ = ident_.to_s
-          return @cache[ident_] if @cache && @cache.include?(ident_)
+          @cache ? @cache.fetch([:url_reader, ident_]){ _get(ident_) } : _get(ident_)
+        end
+        
+        
+        def _get(ident_)  # :nodoc:
           uri_ = ::URI.parse(ident_)
           result_ = nil
-          ::Net::HTTP.start(uri_.host, uri_.port) do |http_|
+          _connection(uri_.host, uri_.port).start do |http_|
             request_ = uri_.path
             request_ = "#{request_}?#{uri_.query}" if uri_.query
             response_ = http_.request_get(request_)
@@ -86,15 +99,21 @@ module RGeo
               end
             end
           end
-          @cache[ident_] = result_ if @cache
           result_
         end
         
         
+        def _connection(host_, port_)  # :nodoc:
+          @mutex.synchronize do
+            @connections[[host_, port_]] ||= HTTPConnection.new(host_, port_, @keep_alive)
+          end
+        end
+        
+        
         # Clear the cache if one is present.
         
         def clear_cache
-          @cache.clear if @cache
+          @cache.clear(:url_reader) if @cache
         end
         
         
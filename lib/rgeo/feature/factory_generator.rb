@@ -34,6 +34,9 @@
 ;
 
 
+require 'monitor'
+
+
 module RGeo
   
   module Feature
@@ -130,6 +133,97 @@ module RGeo
       end
       
       
+      # Return a new FactoryGenerator that calls the given delegate, but
+      # remembers the factory returned for each configuration, so that
+      # later calls with an equal configuration return the same factory.
+      # Configurations are compared by value; string values are copied
+      # when they are cached. The cache is shared by all threads that
+      # use the generator, and the delegate is called at most once for
+      # each configuration.
+      
+      def self.memoize(delegate_)
+        cache_ = {}
+        monitor_ = ::Monitor.new
+        ::Proc.new do |c_|
+          key_ = _memoize_key(c_ || {})
+          monitor_.synchronize do
+            cache_.has_key?(key_) ? cache_[key_] : (cache_[key_] = delegate_.call(c_ || {}))
+          end
+        end
+      end
+      
+      
+      # Options whose factories hold state of their own, and which
+      # therefore are never shared through the registry used by _intern.
+      STATEFUL_OPTIONS = [:collect_stats]  # :nodoc:
+      
+      # The most configurations the registry used by _intern holds. When
+      # it is full, the oldest entry is dropped; a factory that is
+      # dropped keeps working, but is no longer shared.
+      REGISTRY_LIMIT = 256  # :nodoc:
+      
+      @registry = {}
+      @registry_monitor = ::Monitor.new
+      
+      
+      # Returns the factory for the given kind and configuration from a
+      # process-wide registry, calling the block to create it the first
+      # time. Configurations are compared by value, as for memoize. A
+      # configuration that sets a stateful option such as
+      # <tt>:collect_stats</tt>, or that has values other than nil,
+      # booleans, numbers, strings, symbols, and arrays and hashes of
+      # these, is not interned, and the block is called every time. The
+      # registry holds at most REGISTRY_LIMIT configurations.
+      
+      def self._intern(kind_, config_)  # :nodoc:
+        config_ ||= {}
+        if STATEFUL_OPTIONS.any?{ |k_| config_[k_] } || !_internable?(config_)
+          return yield
+        end
+        key_ = [kind_, _memoize_key(config_)]
+        @registry_monitor.synchronize do
+          if @registry.has_key?(key_)
+            @registry[key_]
+          else
+            @registry.shift if @registry.size >= REGISTRY_LIMIT
+            @registry[key_] = yield
+          end
+        end
+      end
+      
+      
+      def self._internable?(value_)  # :nodoc:
+        case value_
+        when ::Hash
+          value_.all?{ |k_, v_| _internable?(k_) && _internable?(v_) }
+        when ::Array
+          value_.all?{ |v_| _internable?(v_) }
+        else
+          value_.nil? || value_ == true || value_ == false || value_.kind_of?(::Numeric) ||
+            value_.kind_of?(::String) || value_.kind_of?(::Symbol)
+        end
+      end
+      
+      
+      def self._memoize_key(config_)  # :nodoc:
+        config_.map{ |k_, v_| [k_.to_s, _memoize_value(v_)] }.sort_by{ |pair_| pair_[0] }
+      end
+      
+      
+      def self._memoize_value(value_)  # :nodoc:
+        case value_
+        when ::String
+          value_.dup.freeze
+        when ::Hash
+          [::Hash, _memoize_key(value_)]
+        when ::Array
+          value_.map{ |v_| _memoize_value(v_) }
+        else
+          value_
+        end
+      end
+      
+      
     end
     
     
@@ -67,6 +67,9 @@ require 'rgeo/geographic/factory'
 require 'rgeo/geographic/projected_window'
 require 'rgeo/geographic/interface'
 require 'rgeo/geographic/spherical_math'
+begin
+  require 'rgeo/geographic/geographic_c_impl'
+rescue ::LoadError; end
 require 'rgeo/geographic/spherical_feature_methods'
 require 'rgeo/geographic/spherical_feature_classes'
 require 'rgeo/geographic/proj4_projector'
@@ -61,6 +61,7 @@ module RGeo
         @multi_polygon_class = Geographic.const_get("#{impl_prefix_}MultiPolygonImpl")
         @support_z = opts_[:has_z_coordinate] ? true : false
         @support_m = opts_[:has_m_coordinate] ? true : false
+        @lazy_projection = opts_[:lazy_projection] ? true : false
         @srid = opts_[:srid] || 4326
         @proj4 = opts_[:proj4]
         if CoordSys::Proj4.supported?
@@ -160,6 +161,33 @@ module RGeo
       end
       
       
+      # Projects the given points, which must be of this factory, and
+      # returns their projected x and y values as a flat array, or as a
+      # String of packed doubles. The projector converts the whole
+      # sequence at once if it can; otherwise each point is projected in
+      # turn. Points that could not be projected have NaN coordinates.
+      
+      def _project_xy(points_)  # :nodoc:
+        return nil unless @projector
+        coords_ = []
+        points_.each do |p_|
+          unless p_.factory == self
+            raise Error::InvalidGeometry, 'Wrong geometry type'
+          end
+          coords_ << p_.x << p_.y
+        end
+        result_ = @projector._project_xy(coords_) if @projector.respond_to?(:_project_xy)
+        unless result_
+          result_ = []
+          points_.each do |p_|
+            proj_ = @projector.project(p_)
+            result_ << proj_.x << proj_.y
+          end
+        end
+        result_
+      end
+      
+      
       # Reverse-projects the given geometry from the projected coordinate
       # space into lat-long space.
       # Raises Error::InvalidGeometry if the given geometry is not of
@@ -212,6 +240,8 @@ module RGeo
           @support_m
         when :is_geographic
           true
+        when :lazy_projection
+          @lazy_projection
         else
           nil
         end
@@ -70,7 +70,9 @@ module RGeo
       #   implemented for most types. Boundaries are available except for
       #   GeometryCollection.
       # * Length calculations are available, but areas are not. Distances
-      #   are available only between points.
+      #   are available only between points. To compute the distances
+      #   from one point to many others, call <tt>distances_to</tt> on
+      #   the point, passing an array of points.
       # * Equality and simplicity evaluation are implemented for some but
       #   not all types.
       # * Assertions for polygons and multipolygons are not implemented.
@@ -196,6 +198,15 @@ module RGeo
       #   Support a Z coordinate. Default is false.
       # [<tt>:has_m_coordinate</tt>]
       #   Support an M coordinate. Default is false.
+      # [<tt>:lazy_projection</tt>]
+      #   If true, the projection of each feature is computed and cached
+      #   the first time it is needed, such as by a predicate, envelope
+      #   or projection call, rather than when the feature is created.
+      #   This saves time and memory for features that are only stored
+      #   and serialized. However, polygons and multipolygons are then not
+      #   checked against the projection factory's assertions on creation,
+      #   and such an invalid feature will have a nil projection.
+      #   Default is false.
       # [<tt>:wkt_parser</tt>]
       #   Configure the parser for WKT. The value is a hash of
       #   configuration parameters for WKRep::WKTParser.new. Default is
@@ -229,7 +240,8 @@ module RGeo
           :coord_sys => _coordsys_4326,
           :srid => 4326,
           :has_z_coordinate => opts_[:has_z_coordinate],
-          :has_m_coordinate => opts_[:has_m_coordinate])
+          :has_m_coordinate => opts_[:has_m_coordinate],
+          :lazy_projection => opts_[:lazy_projection])
         projector_ = Geographic::SimpleMercatorProjector.new(factory_,
           :buffer_resolution => opts_[:buffer_resolution],
           :lenient_multi_polygon_assertions => opts_[:lenient_multi_polygon_assertions],
@@ -325,6 +337,15 @@ module RGeo
       #   Note: this is ignored if a <tt>:projection_factory</tt> is
       #   provided; in that case, the geographic factory's m-coordinate
       #   availability will match the projection factory's setting.
+      # [<tt>:lazy_projection</tt>]
+      #   If true, the projection of each feature is computed and cached
+      #   the first time it is needed, such as by a predicate, envelope
+      #   or projection call, rather than when the feature is created.
+      #   This saves time and memory for features that are only stored
+      #   and serialized. However, polygons and multipolygons are then not
+      #   checked against the projection factory's assertions on creation,
+      #   and such an invalid feature will have a nil projection.
+      #   Default is false.
       # [<tt>:wkt_parser</tt>]
       #   Configure the parser for WKT. The value is a hash of
       #   configuration parameters for WKRep::WKTParser.new. Default is
@@ -392,7 +413,8 @@ module RGeo
             :has_z_coordinate => projection_factory_.property(:has_z_coordinate),
             :has_m_coordinate => projection_factory_.property(:has_m_coordinate),
             :wkt_parser => opts_[:wkt_parser], :wkt_generator => opts_[:wkt_generator],
-            :wkb_parser => opts_[:wkb_parser], :wkb_generator => opts_[:wkb_generator])
+            :wkb_parser => opts_[:wkb_parser], :wkb_generator => opts_[:wkb_generator],
+            :lazy_projection => opts_[:lazy_projection])
           projector_ = Geographic::Proj4Projector.create_from_existing_factory(factory_,
             projection_factory_)
         else
@@ -449,7 +471,8 @@ module RGeo
             :has_z_coordinate => opts_[:has_z_coordinate],
             :has_m_coordinate => opts_[:has_m_coordinate],
             :wkt_parser => opts_[:wkt_parser], :wkt_generator => opts_[:wkt_generator],
-            :wkb_parser => opts_[:wkb_parser], :wkb_generator => opts_[:wkb_generator])
+            :wkb_parser => opts_[:wkb_parser], :wkb_generator => opts_[:wkb_generator],
+            :lazy_projection => opts_[:lazy_projection])
           projector_ = Geographic::Proj4Projector.create_from_proj4(factory_,
             projection_proj4_,
             :srid => projection_srid_,
@@ -58,6 +58,21 @@ module RGeo
       end
       
       
+      # Transforms a flat array of longitude and latitude values into a
+      # String of packed projected x and y values, using a single call
+      # into proj. Returns nil if either factory lacks a proj4.
+      
+      def _project_xy(coords_)  # :nodoc:
+        from_proj_ = @geography_factory.proj4
+        to_proj_ = @projection_factory.respond_to?(:proj4) ? @projection_factory.proj4 : nil
+        if from_proj_ && to_proj_
+          CoordSys::Proj4.transform_coords_array(from_proj_, to_proj_, coords_.pack('d*'))
+        else
+          nil
+        end
+      end
+      
+      
       def projection_factory
         @projection_factory
       end
@@ -138,7 +138,7 @@ module RGeo
       
       def _validate_geometry
         super
-        unless projection
+        unless factory.property(:lazy_projection) || projection
           raise Error::InvalidGeometry, 'Polygon failed assertions'
         end
       end
@@ -199,7 +199,7 @@ module RGeo
       
       def _validate_geometry
         super
-        unless projection
+        unless factory.property(:lazy_projection) || projection
           raise Error::InvalidGeometry, 'MultiPolygon failed assertions'
         end
       end
@@ -60,11 +60,6 @@ module RGeo
       end
       
       
-      def is_empty?
-        projection.is_empty?
-      end
-      
-      
       def is_simple?
         projection.is_simple?
       end
@@ -184,12 +179,15 @@ module RGeo
             if p_x_ < last_x_ - 180.0
               p_x_ += 360.0 while p_x_ < last_x_ - 180.0
             elsif p_x_ > last_x_ + 180.0
-              p_x_ +- 360.0 while p_x_ > last_x_ + 180.0
+              p_x_ -= 360.0 while p_x_ > last_x_ + 180.0
             else
               changed_ = false
             end
             if changed_
-              p_ = factory.point(p_x_, p_.y)
+              extras_ = []
+              extras_ << p_.z if factory.property(:has_z_coordinate)
+              extras_ << p_.m if factory.property(:has_m_coordinate)
+              p_ = factory.point(p_x_, p_.y, *extras_)
               @points[i_] = p_
             end
             last_ = p_
@@ -296,6 +296,53 @@ module RGeo
       end
       
       
+      # Returns an array of the indexes of the given points that lie
+      # within this rectangle. The points may be given as an array of
+      # Feature::Point objects in _unprojected_ (lat/lng) space, or as a
+      # Feature::MultiPoint or Feature::LineString in that space.
+      # This gives the same results as calling contains_point? on each
+      # point, but tests all the points in a single pass.
+      
+      def contained_point_indexes(points_)
+        _filter_xy(@factory._project_xy(_point_list(points_)))
+      end
+      
+      
+      # Returns an array of the given points that lie within this
+      # rectangle, in their original order. The points may be given in
+      # any of the forms accepted by contained_point_indexes.
+      
+      def contained_points(points_)
+        points_ = _point_list(points_)
+        contained_point_indexes(points_).map{ |i_| points_[i_] }
+      end
+      
+      
+      # Returns the portion of the given geometry that lies within this
+      # rectangle, as a geometry in _unprojected_ (lat/lng) space.
+      # The geometry is clipped in the projected coordinate system. If the
+      # rectangle crosses the seam of a wrapping projection, the geometry
+      # is clipped separately against the parts of the rectangle on each
+      # side of the seam, and the results are combined.
+      # 
+      # This requires the projection factory to support intersection and
+      # union, which generally means it must be backed by GEOS.
+      # Returns nil if the projection or any of the operations fails.
+      
+      def clip(geometry_)
+        projected_ = @factory.project(geometry_)
+        return nil unless projected_
+        result_ = nil
+        _projected_rectangles.each do |rect_|
+          piece_ = projected_.intersection(rect_)
+          return nil unless piece_
+          result_ = result_ ? result_.union(piece_) : piece_
+          return nil unless result_
+        end
+        result_ ? @factory.unproject(result_) : nil
+      end
+      
+      
       # Returns a new window resulting from scaling this window by the
       # given factors, which must be floating-point values.
       # If y_factor is not explicitly given, it defaults to the same as
@@ -368,6 +415,73 @@ module RGeo
       end
       
       
+      def _point_list(points_)  # :nodoc:
+        case points_
+        when Feature::LineString
+          points_.points
+        when Feature::MultiPoint
+          (0...points_.num_geometries).map{ |i_| points_.geometry_n(i_) }
+        else
+          points_.to_a
+        end
+      end
+      
+      
+      # Filters a flat array (or String of packed doubles) of projected
+      # x and y values, returning the indexes of the coordinates within
+      # this window.
+      
+      def _filter_xy(coords_)  # :nodoc:
+        bounds_ = [@x_min, @y_min, @x_max, @y_max]
+        if @factory.projection_wraps?
+          limits_ = @factory.projection_limits_window
+          width_ = limits_.x_span
+          wrap_max_ = limits_.x_max
+        end
+        if ProjectedWindow.respond_to?(:_native_filter_xy)
+          return ProjectedWindow._native_filter_xy(coords_, bounds_, width_, wrap_max_)
+        end
+        coords_ = coords_.unpack('d*') if coords_.kind_of?(::String)
+        crosses_seam_ = @x_max < @x_min
+        result_ = []
+        (coords_.size / 2).times do |i_|
+          y_ = coords_[i_ * 2 + 1]
+          next unless y_ <= @y_max && y_ >= @y_min
+          x_ = coords_[i_ * 2]
+          if width_
+            x_ = x_ % width_
+            x_ -= width_ if x_ >= wrap_max_
+          end
+          if crosses_seam_
+            result_ << i_ if x_ <= @x_max || x_ >= @x_min
+          else
+            result_ << i_ if x_ <= @x_max && x_ >= @x_min
+          end
+        end
+        result_
+      end
+      
+      
+      # Returns the rectangle as an array of geometries in the projected
+      # coordinate system: one polygon normally, or two if the rectangle
+      # crosses the seam. Degenerate rectangles yield lines or points.
+      
+      def _projected_rectangles  # :nodoc:
+        proj_factory_ = @factory.projection_factory
+        if @x_max < @x_min
+          limits_ = @factory.projection_limits_window
+          ranges_ = [[@x_min, limits_.x_max], [limits_.x_min, @x_max]]
+        else
+          ranges_ = [[@x_min, @x_max]]
+        end
+        ranges_.map do |x_min_, x_max_|
+          Cartesian::BoundingBox.new(proj_factory_).
+            add(proj_factory_.point(x_min_, @y_min)).
+            add(proj_factory_.point(x_max_, @y_max)).to_geometry
+        end
+      end
+      
+      
       class << self
         
         
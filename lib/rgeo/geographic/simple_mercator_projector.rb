@@ -53,6 +53,17 @@ module RGeo
           :lenient_multi_polygon_assertions => opts_[:lenient_multi_polygon_assertions],
           :has_z_coordinate => opts_[:has_z_coordinate],
           :has_m_coordinate => opts_[:has_m_coordinate])
+        @has_z = opts_[:has_z_coordinate] ? true : false
+        @has_m = opts_[:has_m_coordinate] ? true : false
+        # Whole coordinate sequences are converted natively when the
+        # projection factory can build geometries from packed buffers,
+        # which requires that it has at most one extra dimension.
+        if SimpleMercatorProjector.respond_to?(:_native_project) &&
+            @projection_factory.respond_to?(:line_string_from_coordinates) && !(@has_z && @has_m)
+          @native_dims = @has_z || @has_m ? 3 : 2
+        else
+          @native_dims = nil
+        end
       end
       
       
@@ -67,18 +78,31 @@ module RGeo
           rpd_ = ImplHelper::Math::RADIANS_PER_DEGREE
           radius_ = EQUATORIAL_RADIUS
           @projection_factory.point(geometry_.x * rpd_ * radius_,
-            ::Math.log(::Math.tan(::Math::PI / 4.0 + geometry_.y * rpd_ / 2.0)) * radius_)
+            ::Math.log(::Math.tan(::Math::PI / 4.0 + geometry_.y * rpd_ / 2.0)) * radius_,
+            *_extra_coords(geometry_))
         when Feature::Line
           @projection_factory.line(project(geometry_.start_point), project(geometry_.end_point))
         when Feature::LinearRing
-          @projection_factory.linear_ring(geometry_.points.map{ |p_| project(p_) })
+          if @native_dims
+            @projection_factory.linear_ring_from_coordinates(_project_coords(geometry_.points))
+          else
+            @projection_factory.linear_ring(geometry_.points.map{ |p_| project(p_) })
+          end
         when Feature::LineString
-          @projection_factory.line_string(geometry_.points.map{ |p_| project(p_) })
+          if @native_dims
+            @projection_factory.line_string_from_coordinates(_project_coords(geometry_.points))
+          else
+            @projection_factory.line_string(geometry_.points.map{ |p_| project(p_) })
+          end
         when Feature::Polygon
           @projection_factory.polygon(project(geometry_.exterior_ring),
                                       geometry_.interior_rings.map{ |p_| project(p_) })
         when Feature::MultiPoint
-          @projection_factory.multi_point(geometry_.map{ |p_| project(p_) })
+          if @native_dims
+            @projection_factory.multi_point_from_coordinates(_project_coords(geometry_.to_a))
+          else
+            @projection_factory.multi_point(geometry_.map{ |p_| project(p_) })
+          end
         when Feature::MultiLineString
           @projection_factory.multi_line_string(geometry_.map{ |p_| project(p_) })
         when Feature::MultiPolygon
@@ -97,18 +121,19 @@ module RGeo
           dpr_ = ImplHelper::Math::DEGREES_PER_RADIAN
           radius_ = EQUATORIAL_RADIUS
           @geography_factory.point(geometry_.x / radius_ * dpr_,
-            (2.0 * ::Math.atan(::Math.exp(geometry_.y / radius_)) - ::Math::PI / 2.0) * dpr_)
+            (2.0 * ::Math.atan(::Math.exp(geometry_.y / radius_)) - ::Math::PI / 2.0) * dpr_,
+            *_extra_coords(geometry_))
         when Feature::Line
           @geography_factory.line(unproject(geometry_.start_point), unproject(geometry_.end_point))
         when Feature::LinearRing
-          @geography_factory.linear_ring(geometry_.points.map{ |p_| unproject(p_) })
+          @geography_factory.linear_ring(_unprojected_points(geometry_))
         when Feature::LineString
-          @geography_factory.line_string(geometry_.points.map{ |p_| unproject(p_) })
+          @geography_factory.line_string(_unprojected_points(geometry_))
         when Feature::Polygon
           @geography_factory.polygon(unproject(geometry_.exterior_ring),
             geometry_.interior_rings.map{ |p_| unproject(p_) })
         when Feature::MultiPoint
-          @geography_factory.multi_point(geometry_.map{ |p_| unproject(p_) })
+          @geography_factory.multi_point(_unprojected_points(geometry_))
         when Feature::MultiLineString
           @geography_factory.multi_line_string(geometry_.map{ |p_| unproject(p_) })
         when Feature::MultiPolygon
@@ -121,6 +146,65 @@ module RGeo
       end
       
       
+      # Returns the Z and M values of the given point that the factories
+      # support, which pass through the projection unchanged.
+      
+      def _extra_coords(point_)  # :nodoc:
+        extras_ = []
+        extras_ << point_.z if @has_z
+        extras_ << point_.m if @has_m
+        extras_
+      end
+      
+      
+      # Returns a packed buffer of the projected coordinates of the
+      # given geographic points, in the layout used by the projection
+      # factory's *_from_coordinates methods.
+      
+      def _project_coords(points_)  # :nodoc:
+        coords_ = []
+        points_.each do |p_|
+          coords_ << p_.x << p_.y
+          coords_.concat(_extra_coords(p_))
+        end
+        SimpleMercatorProjector._native_project(coords_, @native_dims, EQUATORIAL_RADIUS)
+      end
+      
+      
+      # Projects a flat array of longitude and latitude values into a
+      # flat array, or String of packed doubles, of x and y values.
+      
+      def _project_xy(coords_)  # :nodoc:
+        if SimpleMercatorProjector.respond_to?(:_native_project)
+          SimpleMercatorProjector._native_project(coords_, 2, EQUATORIAL_RADIUS)
+        else
+          rpd_ = ImplHelper::Math::RADIANS_PER_DEGREE
+          radius_ = EQUATORIAL_RADIUS
+          result_ = []
+          (coords_.size / 2).times do |i_|
+            result_ << coords_[i_ * 2] * rpd_ * radius_ <<
+              ::Math.log(::Math.tan(::Math::PI / 4.0 + coords_[i_ * 2 + 1] * rpd_ / 2.0)) * radius_
+          end
+          result_
+        end
+      end
+      
+      
+      # Returns the unprojected points of the given projected line string
+      # or multipoint, reading its packed coordinates directly if the
+      # projection factory supports it.
+      
+      def _unprojected_points(geometry_)  # :nodoc:
+        if @native_dims && geometry_.respond_to?(:packed_coordinates)
+          coords_ = SimpleMercatorProjector._native_unproject(geometry_.packed_coordinates,
+            @native_dims, EQUATORIAL_RADIUS)
+          coords_.each_slice(@native_dims).map{ |c_| @geography_factory.point(*c_) }
+        else
+          (geometry_.respond_to?(:points) ? geometry_.points : geometry_).map{ |p_| unproject(p_) }
+        end
+      end
+      
+      
       def wraps?
         true
       end
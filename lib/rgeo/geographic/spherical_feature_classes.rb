@@ -66,13 +66,31 @@ module RGeo
         rhs_ = Feature.cast(rhs_, @factory)
         case rhs_
         when SphericalPointImpl
-          _xyz.dist_to_point(rhs_._xyz) * SphericalMath::RADIUS
+          if SphericalMath.respond_to?(:_native_distance)
+            SphericalMath._native_distance(@y, @x, rhs_.y, rhs_.x) * SphericalMath::RADIUS
+          else
+            _xyz.dist_to_point(rhs_._xyz) * SphericalMath::RADIUS
+          end
         else
           super
         end
       end
       
       
+      # Returns an array of the distances from this point to each of the
+      # given points, in meters. This is equivalent to calling distance
+      # for each point, but is faster for large numbers of points.
+      
+      def distances_to(points_)
+        points_ = points_.to_a unless points_.kind_of?(::Array)
+        if SphericalMath.respond_to?(:_native_distances) && points_.all?{ |p_| p_.kind_of?(SphericalPointImpl) }
+          SphericalMath._native_distances(@y, @x, points_, SphericalMath::RADIUS)
+        else
+          points_.map{ |p_| distance(p_) }
+        end
+      end
+      
+      
       def equals?(rhs_)
         return false unless rhs_.is_a?(self.class) && rhs_.factory == self.factory
         case rhs_
@@ -64,6 +64,18 @@ module RGeo
       
       
       def is_simple?
+        unless defined?(@is_simple)
+          if SphericalMath.respond_to?(:_native_line_string_simple?)
+            @is_simple = SphericalMath._native_line_string_simple?(@points)
+          else
+            @is_simple = _compute_is_simple
+          end
+        end
+        @is_simple
+      end
+      
+      
+      def _compute_is_simple  # :nodoc:
         arcs_ = _arcs
         len_ = arcs_.length
         return false if arcs_.any?{ |a_| a_.degenerate? }
@@ -53,6 +53,34 @@ module RGeo
   # To use the Geos implementation, first obtain a factory using the
   # ::RGeo::Geos.factory method. You may then call any of the standard
   # factory methods on the resulting object.
+  # 
+  # In addition to the standard interfaces, GEOS geometries (other than
+  # those from a ZM factory) provide raw access to their coordinates
+  # without creating point objects. <tt>packed_coordinates</tt> returns
+  # a String of packed native doubles, <tt>flat_coordinates</tt> returns
+  # an Array of Floats, and <tt>each_coordinate</tt> yields the numbers
+  # for each coordinate in turn. Each coordinate has two numbers, or
+  # three if the factory has a Z or M coordinate. Polygon rings are
+  # visited exterior ring first, and collections are visited in order.
+  # The coordinate-buffer constructors on the factory, such as
+  # <tt>line_string_from_coordinates</tt>, accept the same layout.
+  # 
+  # GEOS geometries also evaluate a predicate or distance against many
+  # geometries in a single call. <tt>batch_predicate(pred, geoms)</tt>
+  # takes a predicate name such as <tt>:contains?</tt> or
+  # <tt>:intersects?</tt> and an Array of geometries, and returns the
+  # indexes of the geometries for which the predicate holds. Pass
+  # <tt>:bitmap</tt> as a third argument to get a String with one bit
+  # per geometry instead, least significant bit first (as read by
+  # <tt>unpack('b*')</tt>). <tt>batch_distance(geoms)</tt> returns an
+  # Array of distances. These use a prepared version of the receiver,
+  # and run with the Ruby interpreter lock released where supported.
+  # They return nil if any of the evaluations fails. Collections also
+  # provide <tt>unary_union</tt>, which dissolves their elements.
+  # 
+  # Geometries can be simplified natively for a given tolerance using
+  # <tt>simplify</tt> (Douglas-Peucker, which may produce invalid
+  # geometries) or <tt>topology_preserving_simplify</tt>.
   
   module Geos
   end
@@ -64,6 +92,7 @@ end
 # Implementation files
 require 'rgeo/geos/factory'
 require 'rgeo/geos/interface'
+require 'rgeo/geos/strtree'
 begin
   require 'rgeo/geos/geos_c_impl'
 rescue ::LoadError; end
@@ -67,11 +67,18 @@ module RGeo
           if flags_ & 6 == 6
             raise Error::UnsupportedOperation, "GEOS cannot support both Z and M coordinates at the same time."
           end
+          flags_ |= 8 unless opts_[:auto_prepare] == :disabled
+          flags_ |= 16 if opts_[:collect_stats]
           
           # Buffer resolution
           buffer_resolution_ = opts_[:buffer_resolution].to_i
           buffer_resolution_ = 1 if buffer_resolution_ < 1
           
+          # Grid size for snapping coordinates
+          grid_size_ = opts_[:grid_size]
+          grid_size_ = grid_size_ ? grid_size_.to_f : 0.0
+          grid_size_ = grid_size_ > 0.0 ? grid_size_ : nil
+          
           # Interpret the generator options
           wkt_generator_ = opts_[:wkt_generator]
           case wkt_generator_
@@ -116,7 +123,8 @@ module RGeo
           srid_ ||= coord_sys_.authority_code if coord_sys_
           
           # Create the factory and set instance variables
-          result_ = _create(flags_, srid_.to_i, buffer_resolution_, wkt_generator_, wkb_generator_)
+          result_ = _create(flags_, srid_.to_i, buffer_resolution_, wkt_generator_, wkb_generator_,
+            _wkt_native_flags(wkt_generator_), _wkb_native_flags(wkb_generator_), grid_size_)
           
           # Interpret parser options
           wkt_parser_ = opts_[:wkt_parser]
@@ -145,6 +153,8 @@ module RGeo
           result_.instance_variable_set(:@wkb_parser, wkb_parser_)
           result_.instance_variable_set(:@wkt_generator, wkt_generator_)
           result_.instance_variable_set(:@wkb_generator, wkb_generator_)
+          result_.instance_variable_set(:@marshal_opts,
+            _marshal_opts(opts_, flags_, srid_, buffer_resolution_, grid_size_, proj4_, coord_sys_))
           
           # Return the result
           result_
@@ -152,6 +162,97 @@ module RGeo
         alias_method :new, :create
         
         
+        # Returns flags describing the given WKT generator, if its output
+        # can be produced by the C extension directly from the GEOS
+        # coordinate sequences. Returns 0 if the generator must be called.
+        
+        def _wkt_native_flags(generator_)  # :nodoc:
+          return 0 unless generator_.instance_of?(WKRep::WKTGenerator)
+          flags_ = 1
+          case generator_.tag_format
+          when :wkt11_strict
+            flags_ |= 2
+          when :ewkt
+            flags_ |= 4
+            flags_ |= 8 if generator_.emit_ewkt_srid?
+          when :wkt12
+            flags_ |= 16
+          end
+          flags_ |= 32 if generator_.square_brackets?
+          case generator_.convert_case
+          when :upper
+            flags_ |= 64
+          when :lower
+            flags_ |= 128
+          end
+          flags_
+        end
+        
+        
+        # Returns flags describing the given WKB generator, if its output
+        # can be produced from that of the GEOS WKB writer. The C
+        # extension rewrites the GEOS type codes for the EWKB and WKB12
+        # formats, and inserts the EWKB SRID. Returns 0 if the generator
+        # must be called.
+        
+        def _wkb_native_flags(generator_)  # :nodoc:
+          return 0 unless generator_.instance_of?(WKRep::WKBGenerator)
+          flags_ = 1
+          flags_ |= 2 if generator_.little_endian?
+          flags_ |= 4 if generator_.hex_format?
+          case generator_.type_format
+          when :ewkb
+            flags_ |= 8
+            flags_ |= 16 if generator_.emit_ewkb_srid?
+          when :wkb12
+            flags_ |= 32
+          end
+          flags_
+        end
+        
+        
+        
+        # Returns the options needed to recreate a factory, as an array
+        # of option/value pairs sorted by option name. Generator and
+        # parser options are kept only if they are given as hashes or
+        # symbols, since other objects cannot be marshaled reliably.
+        
+        def _marshal_opts(opts_, flags_, srid_, buffer_resolution_, grid_size_, proj4_, coord_sys_)  # :nodoc:
+          result_ = {:srid => srid_.to_i, :buffer_resolution => buffer_resolution_}
+          result_[:lenient_multi_polygon_assertions] = true if flags_ & 1 != 0
+          result_[:has_z_coordinate] = true if flags_ & 2 != 0
+          result_[:has_m_coordinate] = true if flags_ & 4 != 0
+          result_[:auto_prepare] = :disabled if flags_ & 8 == 0
+          result_[:collect_stats] = true if flags_ & 16 != 0
+          result_[:grid_size] = grid_size_ if grid_size_
+          result_[:proj4] = proj4_.original_str if proj4_
+          result_[:coord_sys] = coord_sys_.to_wkt if coord_sys_
+          [:wkt_generator, :wkb_generator, :wkt_parser, :wkb_parser].each do |key_|
+            value_ = opts_[key_]
+            result_[key_] = value_ if value_.kind_of?(::Hash) || value_.kind_of?(::Symbol)
+          end
+          result_.to_a.sort_by{ |key_, value_| key_.to_s }
+        end
+        
+        
+        # Returns a factory matching the given marshal fingerprint,
+        # creating it the first time the fingerprint is seen. Factories
+        # are shared through the registry used by Geos.factory, keyed by
+        # the fingerprint itself, so that a factory that collects stats
+        # is also shared by the geometries loaded with it.
+        
+        def _marshal_factory(fingerprint_)  # :nodoc:
+          Feature::FactoryGenerator._intern(:geos_marshal, :fingerprint => fingerprint_) do
+            create(_marshal_hash(::Marshal.load(fingerprint_)))
+          end
+        end
+        
+        
+        def _marshal_hash(pairs_)  # :nodoc:
+          pairs_.inject({}){ |hash_, (key_, value_)| hash_[key_] = value_; hash_ }
+        end
+        
+        
       end
       
       
@@ -163,7 +264,7 @@ module RGeo
       # Factory equivalence test.
       
       def eql?(rhs_)
-        rhs_.is_a?(Factory) && rhs_.srid == _srid && rhs_._buffer_resolution == _buffer_resolution && rhs_._flags == _flags && rhs_.proj4 == @proj4
+        rhs_.is_a?(Factory) && rhs_.srid == _srid && rhs_._buffer_resolution == _buffer_resolution && rhs_._grid_size == _grid_size && rhs_._flags & ~16 == _flags & ~16 && rhs_.proj4 == @proj4
       end
       alias_method :==, :eql?
       
@@ -175,6 +276,19 @@ module RGeo
       end
       
       
+      def _marshal_opts  # :nodoc:
+        @marshal_opts
+      end
+      
+      
+      # Returns a string identifying the options of this factory, used
+      # by Marshal to recreate an equivalent factory when loading.
+      
+      def _marshal_fingerprint  # :nodoc:
+        @marshal_fingerprint ||= ::Marshal.dump(@marshal_opts)
+      end
+      
+      
       # Returns the resolution used by buffer calculations on geometries
       # created by this factory
       
@@ -183,6 +297,49 @@ module RGeo
       end
       
       
+      # Returns the size of the grid that coordinates are snapped to, or
+      # nil if coordinates are not snapped.
+      
+      def grid_size
+        _grid_size
+      end
+      
+      
+      # Returns a hash of the instrumentation counters collected by this
+      # factory since it was created or since reset_stats was last
+      # called, or nil if the factory was not created with the
+      # <tt>:collect_stats</tt> option. The keys are:
+      # 
+      # [<tt>:geos_calls</tt>]
+      #   The number of GEOS operations run with the interpreter lock
+      #   released: overlays, buffers, relate, simplification, unary
+      #   unions, and batch predicates and distances.
+      # [<tt>:geos_time</tt>]
+      #   The total time in seconds spent in those operations.
+      # [<tt>:conversions</tt>]
+      #   The number of geometries cast to this factory because they
+      #   came from another factory or implementation.
+      # [<tt>:clones</tt>]
+      #   The number of GEOS geometries copied to wrap them.
+      # [<tt>:allocations</tt>]
+      #   The number of geometry objects created.
+      # [<tt>:callbacks</tt>]
+      #   The number of calls to ruby WKT and WKB generators that
+      #   could not be handled natively.
+      
+      def stats
+        _stats
+      end
+      
+      
+      # Resets the counters reported by stats.
+      
+      def reset_stats
+        _reset_stats
+        self
+      end
+      
+      
       # Returns true if this factory is lenient with MultiPolygon assertions
       
       def lenient_multi_polygon_assertions?
@@ -302,6 +459,105 @@ module RGeo
       end
       
       
+      # Creates a geometry collection like #collection, but takes over
+      # the GEOS geometries of any elements that already belong to this
+      # factory instead of copying them. This avoids holding two copies
+      # of every element while the collection is built.
+      # 
+      # Geometries are taken over only if the collection is created
+      # successfully; otherwise every element is left as it was. Each
+      # element whose geometry is taken over is left uninitialized (see
+      # GeometryImpl#initialized?), and any other use of it raises
+      # RGeo::Error::InvalidGeometry, so use this only for elements that
+      # are not used anywhere else. An element that appears more than
+      # once is taken over once and copied for its other positions.
+      
+      def collection!(elems_)
+        elems_ = elems_.to_a unless elems_.kind_of?(::Array)
+        GeometryCollectionImpl._create_adopting(self, elems_) rescue nil
+      end
+      
+      
+      # Creates a multi point like #multi_point, taking over the GEOS
+      # geometries of its elements. See #collection! for details.
+      
+      def multi_point!(elems_)
+        elems_ = elems_.to_a unless elems_.kind_of?(::Array)
+        MultiPointImpl._create_adopting(self, elems_) rescue nil
+      end
+      
+      
+      # Creates a multi line string like #multi_line_string, taking over
+      # the GEOS geometries of its elements. See #collection! for
+      # details.
+      
+      def multi_line_string!(elems_)
+        elems_ = elems_.to_a unless elems_.kind_of?(::Array)
+        MultiLineStringImpl._create_adopting(self, elems_) rescue nil
+      end
+      
+      
+      # Creates a multi polygon like #multi_polygon, taking over the
+      # GEOS geometries of its elements. See #collection! for details.
+      
+      def multi_polygon!(elems_)
+        elems_ = elems_.to_a unless elems_.kind_of?(::Array)
+        MultiPolygonImpl._create_adopting(self, elems_) rescue nil
+      end
+      
+      
+      # Computes the union of all the given geometries in a single GEOS
+      # operation (a unary union), which is much faster than folding
+      # Geometry#union over the list. Returns nil if the union could
+      # not be computed.
+      
+      def union_all(geoms_)
+        geoms_ = geoms_.to_a unless geoms_.kind_of?(::Array)
+        GeometryCollectionImpl._union_all(self, geoms_) rescue nil
+      end
+      
+      
+      # Creates a LineString directly from a flat coordinate buffer,
+      # without creating point objects. The buffer may be an Array of
+      # numbers, or a String of packed native-endian doubles (as
+      # produced by <tt>pack('d*')</tt>). Each coordinate takes two
+      # numbers, or three if the factory has a Z or M coordinate.
+      # Returns nil if the buffer is malformed.
+      
+      def line_string_from_coordinates(coords_)
+        _line_string_from_coords(coords_) rescue nil
+      end
+      
+      
+      # Creates a LinearRing directly from a flat coordinate buffer.
+      # The ring is closed automatically if necessary.
+      # See line_string_from_coordinates for the buffer format.
+      
+      def linear_ring_from_coordinates(coords_)
+        _linear_ring_from_coords(coords_) rescue nil
+      end
+      
+      
+      # Creates a Polygon directly from flat coordinate buffers, one for
+      # the outer ring and one for each inner ring. The rings are closed
+      # automatically if necessary.
+      # See line_string_from_coordinates for the buffer format.
+      
+      def polygon_from_coordinates(outer_coords_, inner_coords_=nil)
+        inner_coords_ = inner_coords_.to_a unless inner_coords_.kind_of?(::Array)
+        _polygon_from_coords(outer_coords_, inner_coords_) rescue nil
+      end
+      
+      
+      # Creates a MultiPoint directly from a flat coordinate buffer,
+      # with one point per coordinate.
+      # See line_string_from_coordinates for the buffer format.
+      
+      def multi_point_from_coordinates(coords_)
+        _multi_point_from_coords(coords_) rescue nil
+      end
+      
+      
       # See ::RGeo::Feature::Factory#proj4
       
       def proj4
@@ -328,14 +584,21 @@ module RGeo
         case original_
         when GeometryImpl
           # Optimization if we're just changing factories, but the
-          # factories are zm-compatible and proj4-compatible.
+          # factories are zm-compatible and proj4-compatible. If this
+          # factory snaps to a different grid, the coordinates are
+          # copied with snapping instead.
           if original_.factory != self && ntype_ == type_ &&
               original_.factory._flags & 0x6 == _flags & 0x6 &&
               (!project_ || original_.factory.proj4 == @proj4)
           then
-            result_ = original_.dup
-            result_._set_factory(self)
-            return result_
+            if !_grid_size || original_.factory._grid_size == _grid_size
+              result_ = original_.dup
+              result_._set_factory(self)
+              return result_
+            end
+            has_z_ = _flags & 0x6 != 0
+            result_ = _copy_with_packed_coordinates(original_, original_._packed_coordinates(has_z_), has_z_)
+            return result_ if result_
           end
           # LineString conversion optimization.
           if (original_.factory != self || ntype_ != type_) &&
@@ -345,6 +608,14 @@ module RGeo
           then
             return IMPL_CLASSES[ntype_]._copy_from(self, original_)
           end
+          # Projection optimization: transform the coordinates in bulk
+          # without creating intermediate point objects.
+          if project_ && ntype_ == type_ && (from_proj_ = original_.factory.proj4) &&
+              @proj4 && from_proj_ != @proj4
+          then
+            result_ = _project_geometry(from_proj_, original_, @proj4)
+            return result_ unless result_ == false
+          end
         when ZMGeometryImpl
           # Optimization for just removing a coordinate from an otherwise
           # compatible factory
@@ -358,6 +629,21 @@ module RGeo
       end
       
       
+      # Projects the given GEOS geometry into this factory, using a
+      # packed coordinate buffer rather than ruby point objects.
+      # Returns false if the factories' coordinate dimensions do not
+      # allow it, or nil if the projection failed.
+      
+      def _project_geometry(from_proj_, geometry_, to_proj_)  # :nodoc:
+        from_flags_ = geometry_.factory._flags
+        return false if (from_flags_ | _flags) & 0x4 != 0
+        has_z_ = from_flags_ & 0x2 != 0
+        coords_ = CoordSys::Proj4.transform_coords_array(from_proj_, to_proj_,
+          geometry_._packed_coordinates(has_z_), has_z_)
+        coords_ ? _copy_with_packed_coordinates(geometry_, coords_, has_z_) : nil
+      end
+      
+      
     end
     
     
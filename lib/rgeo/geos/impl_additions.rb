@@ -46,6 +46,74 @@ module RGeo
         "#<#{self.class}:0x#{object_id.to_s(16)} #{as_text.inspect}>"
       end
       
+      
+      # :stopdoc:
+      if ::RGeo::Geos.supported?
+        
+        # Marshal support. A dumped geometry consists of the factory's
+        # fingerprint, the implementation class of the geometry (or of
+        # its elements, for a collection), and the geometry itself as WKB in the native
+        # GEOS dimension. Each part is preceded by its length, except
+        # the last, which is preceded by a format byte since GEOS cannot
+        # write empty points as WKB.
+        
+        MARSHAL_KLASSES = [nil, PointImpl, LineStringImpl, LinearRingImpl, LineImpl,
+          PolygonImpl, GeometryCollectionImpl, MultiPointImpl, MultiLineStringImpl, MultiPolygonImpl].freeze
+        MARSHAL_ARRAY_CODE = MARSHAL_KLASSES.size
+        
+        
+        def _dump(level_)
+          fingerprint_ = factory._marshal_fingerprint
+          klasses_ = GeometryImpl._marshal_klasses(_klasses || self.class, []).pack('w*')
+          if (wkb_ = _marshal_wkb)
+            data_ = 'B' + wkb_
+          else
+            data_ = 'T' + as_text
+          end
+          [fingerprint_.size].pack('N') + fingerprint_ + [klasses_.size].pack('N') + klasses_ + data_
+        end
+        
+        
+        def self._load(str_)
+          size_ = str_[0, 4].unpack('N').first
+          factory_ = Factory._marshal_factory(str_[4, size_])
+          offset_ = 4 + size_
+          size_ = str_[offset_, 4].unpack('N').first
+          klasses_ = _unmarshal_klasses(str_[offset_ + 4, size_].unpack('w*'))
+          offset_ += 4 + size_
+          data_ = str_[offset_ + 1..-1]
+          if str_[offset_, 1] == 'B'
+            factory_._unmarshal_wkb(data_, klasses_)
+          else
+            factory_._parse_wkt_impl(data_)
+          end
+        end
+        
+        
+        def self._marshal_klasses(klasses_, codes_)
+          if klasses_.kind_of?(::Array)
+            codes_ << MARSHAL_ARRAY_CODE << klasses_.size
+            klasses_.each{ |k_| _marshal_klasses(k_, codes_) }
+          else
+            codes_ << (MARSHAL_KLASSES.index(klasses_) || 0)
+          end
+          codes_
+        end
+        
+        
+        def self._unmarshal_klasses(codes_)
+          code_ = codes_.shift
+          if code_ == MARSHAL_ARRAY_CODE
+            (0...codes_.shift).map{ _unmarshal_klasses(codes_) }
+          else
+            MARSHAL_KLASSES[code_.to_i]
+          end
+        end
+        
+      end
+      # :startdoc:
+      
+      
     end
     
     
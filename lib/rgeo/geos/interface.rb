@@ -69,6 +69,11 @@ module RGeo
       # configured with both Z and M support will work, but will be
       # slower than a 2-dimensional or 3-dimensional factory.
       # 
+      # Factories are shared: a later call with an equal set of options
+      # returns the same factory. Factories created with the
+      # <tt>:collect_stats</tt> option, or with options whose values are
+      # objects such as an SRS database, are never shared.
+      # 
       # Options include:
       # 
       # [<tt>:lenient_multi_polygon_assertions</tt>]
@@ -85,6 +90,30 @@ module RGeo
       #   4-sided polygon. A resolution of 2 would cause that buffer
       #   to be approximated by an 8-sided polygon. The exact behavior
       #   for different kinds of buffers is defined by GEOS.
+      # [<tt>:grid_size</tt>]
+      #   If set to a positive number, the X and Y coordinates of
+      #   geometries are snapped to a grid of that size when the
+      #   factory creates the geometries from coordinates, parses them,
+      #   or casts them from another factory. For example, a value of
+      #   0.01 rounds coordinates to two decimal places. The results of
+      #   operations such as unions are not snapped. Default is no
+      #   snapping.
+      # [<tt>:collect_stats</tt>]
+      #   If set to true, the factory counts GEOS operations (and the
+      #   time spent in them), conversions of geometries from other
+      #   factories, geometry clones and allocations, and calls to ruby
+      #   WKT/WKB generators. See RGeo::Geos::Factory#stats. Default is
+      #   false.
+      # [<tt>:auto_prepare</tt>]
+      #   Request an auto-prepare strategy. Supported values are
+      #   <tt>:simple</tt> and <tt>:disabled</tt>. The former (which is
+      #   the default) generates a prepared geometry the second time a
+      #   geometry is used as the receiver of a predicate such as
+      #   contains? or intersects?, so repeated tests against the same
+      #   geometry do not recompute its internal topology. The latter
+      #   disables automatic preparation. In either case, you can call
+      #   <tt>prepare!</tt> on a geometry to prepare it explicitly, and
+      #   <tt>prepared?</tt> to find out whether it has been prepared.
       # [<tt>:srid</tt>]
       #   Set the SRID returned by geometries created by this factory.
       #   Default is 0.
@@ -139,10 +168,12 @@ module RGeo
       
       def factory(opts_={})
         if supported?
-          if opts_[:has_z_coordinate] && opts_[:has_m_coordinate]
-            ZMFactory.new(opts_)
-          else
-            Factory.create(opts_)
+          Feature::FactoryGenerator._intern(:geos, opts_) do
+            if opts_[:has_z_coordinate] && opts_[:has_m_coordinate]
+              ZMFactory.new(opts_)
+            else
+              Factory.create(opts_)
+            end
           end
         else
           nil
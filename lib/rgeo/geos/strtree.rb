@@ -0,0 +1,158 @@
+# -----------------------------------------------------------------------------
+# 
+# GEOS STRtree spatial index
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+module RGeo
+  
+  module Geos
+    
+    
+    # A spatial index for GEOS geometries, based on the GEOS implementation
+    # of the Sort-Tile-Recursive packed R-tree.
+    # 
+    # Use this to find candidate geometries quickly before running exact
+    # predicates on them. You insert geometries (each optionally paired
+    # with an arbitrary item to return in its place), and then query the
+    # tree with a geometry or a Cartesian::BoundingBox. Queries return the
+    # items whose geometries have envelopes intersecting the envelope of
+    # the query; that is, they return candidates, which you should still
+    # check with a predicate such as intersects? if you need exact results.
+    # 
+    # Note that GEOS builds the tree the first time it is queried, and it
+    # cannot be modified after that point. Therefore, insert all your
+    # geometries before making any queries.
+    
+    class STRtree
+      
+      
+      class << self
+        
+        
+        # Create a new STRtree whose geometries and queries are interpreted
+        # using the given GEOS factory. Geometries from other factories
+        # are cast to this factory when inserted. Returns nil if the GEOS
+        # implementation, or the STRtree feature of GEOS, is not supported.
+        # 
+        # Options include:
+        # 
+        # [<tt>:node_capacity</tt>]
+        #   The maximum number of children of each node. Default is 10.
+        
+        def create(factory_, opts_={})
+          return nil unless respond_to?(:_create)
+          factory_ = factory_.z_factory if factory_.is_a?(ZMFactory)
+          unless factory_.is_a?(Factory)
+            raise Error::UnsupportedOperation, "STRtree requires a GEOS factory"
+          end
+          _create(factory_, (opts_[:node_capacity] || 10).to_i)
+        end
+        alias_method :new, :create
+        
+        
+        # Returns true if the STRtree is supported in this installation.
+        
+        def supported?
+          respond_to?(:_create)
+        end
+        
+        
+      end
+      
+      
+      def inspect  # :nodoc:
+        "#<#{self.class}:0x#{object_id.to_s(16)} size=#{size}#{built? ? ' built' : ''}>"
+      end
+      
+      
+      # Insert the given geometry into the tree. The given item is
+      # returned from queries that hit this geometry; if you do not
+      # provide one, the geometry itself is used. Returns self.
+      # 
+      # Raises Error::UnsupportedOperation if the tree has already been
+      # queried, and Error::InvalidGeometry if the geometry could not be
+      # cast to the tree's factory.
+      
+      def insert(geometry_, item_=geometry_)
+        if built?
+          raise Error::UnsupportedOperation, "Cannot insert into an STRtree after it has been queried"
+        end
+        unless _insert(geometry_, item_)
+          raise Error::InvalidGeometry, "Could not cast #{geometry_}"
+        end
+        self
+      end
+      alias_method :<<, :insert
+      
+      
+      # Returns an array of the items whose geometries' envelopes
+      # intersect the envelope of the given query, which may be a geometry
+      # or a Cartesian::BoundingBox. If a block is given, yields each item
+      # in turn instead.
+      
+      def query(query_)
+        if query_.is_a?(Cartesian::BoundingBox)
+          result_ = query_.empty? ? [] :
+            _query_envelope(query_.min_x, query_.min_y, query_.max_x, query_.max_y)
+        else
+          result_ = _query(query_)
+          unless result_
+            raise Error::InvalidGeometry, "Could not cast #{query_}"
+          end
+        end
+        if block_given?
+          result_.each{ |item_| yield item_ }
+          self
+        else
+          result_
+        end
+      end
+      
+      
+      # Returns the item whose geometry is closest to the given geometry,
+      # using the same distance computation as Feature::Geometry#distance.
+      # Returns nil if the tree is empty. If more than one geometry is at
+      # the minimum distance, one of them is chosen arbitrarily.
+      
+      def nearest(geometry_)
+        _nearest(geometry_)
+      end
+      
+      
+    end
+    
+    
+  end
+  
+end
@@ -58,6 +58,19 @@ module RGeo
         end
         
         
+        # Returns a factory matching the given marshal fingerprint,
+        # creating it the first time the fingerprint is seen. Factories
+        # are shared through the registry used by Geos.factory, keyed by
+        # the fingerprint itself, so that a factory that collects stats
+        # is also shared by the geometries loaded with it.
+        
+        def _marshal_factory(fingerprint_)  # :nodoc:
+          Feature::FactoryGenerator._intern(:geos_zm_marshal, :fingerprint => fingerprint_) do
+            create(Factory._marshal_hash(::Marshal.load(fingerprint_)))
+          end
+        end
+        
+        
       end
       
       
@@ -76,6 +89,9 @@ module RGeo
         config_ = {
           :lenient_multi_polygon_assertions => opts_[:lenient_multi_polygon_assertions],
           :buffer_resolution => opts_[:buffer_resolution],
+          :grid_size => opts_[:grid_size],
+          :auto_prepare => opts_[:auto_prepare],
+          :collect_stats => opts_[:collect_stats],
           :wkt_generator => opts_[:wkt_generator], :wkt_parser => opts_[:wkt_parser],
           :wkb_generator => opts_[:wkb_generator], :wkb_parser => opts_[:wkb_parser],
           :srid => srid_.to_i, :proj4 => proj4_, :coord_sys => coord_sys_,
@@ -150,6 +166,37 @@ module RGeo
       end
       
       
+      # Returns a string identifying the options of this factory, used
+      # by Marshal to recreate an equivalent factory when loading.
+      
+      def _marshal_fingerprint  # :nodoc:
+        @marshal_fingerprint ||= ::Marshal.dump(@zfactory._marshal_opts.reject{ |key_, value_| key_ == :has_z_coordinate })
+      end
+      
+      
+      # Returns the instrumentation counters of the z and m factories,
+      # added together, or nil if stats are not collected. See
+      # Factory#stats.
+      
+      def stats
+        zstats_ = @zfactory.stats
+        mstats_ = @mfactory.stats
+        return nil unless zstats_ && mstats_
+        result_ = {}
+        zstats_.each{ |key_, value_| result_[key_] = value_ + mstats_[key_] }
+        result_
+      end
+      
+      
+      # Resets the counters reported by stats.
+      
+      def reset_stats
+        @zfactory.reset_stats
+        @mfactory.reset_stats
+        self
+      end
+      
+      
       # Factory equivalence test.
       
       def eql?(rhs_)
@@ -187,63 +234,64 @@ module RGeo
       # See ::RGeo::Feature::Factory#point
       
       def point(x_, y_, z_=0, m_=0)
-        ZMPointImpl.create(self, @zfactory.point(x_, y_, z_), @mfactory.point(x_, y_, m_))
+        ZMPointImpl.create(self, @zfactory.point(x_, y_, z_), [m_].pack('d')) rescue nil
       end
       
       
       # See ::RGeo::Feature::Factory#line_string
       
       def line_string(points_)
-        ZMLineStringImpl.create(self, @zfactory.line_string(points_), @mfactory.line_string(points_))
+        _create_from_points(ZMLineStringImpl, @zfactory.line_string(points_), points_)
       end
       
       
       # See ::RGeo::Feature::Factory#line
       
       def line(start_, end_)
-        ZMLineStringImpl.create(self, @zfactory.line(start_, end_), @mfactory.line(start_, end_))
+        _create_from_points(ZMLineStringImpl, @zfactory.line(start_, end_), [start_, end_])
       end
       
       
       # See ::RGeo::Feature::Factory#linear_ring
       
       def linear_ring(points_)
-        ZMLineStringImpl.create(self, @zfactory.linear_ring(points_), @mfactory.linear_ring(points_))
+        _create_from_points(ZMLineStringImpl, @zfactory.linear_ring(points_), points_)
       end
       
       
       # See ::RGeo::Feature::Factory#polygon
       
       def polygon(outer_ring_, inner_rings_=nil)
-        ZMPolygonImpl.create(self, @zfactory.polygon(outer_ring_, inner_rings_), @mfactory.polygon(outer_ring_, inner_rings_))
+        inner_rings_ = inner_rings_.to_a
+        _create_from_parts(ZMPolygonImpl, @zfactory.polygon(outer_ring_, inner_rings_), [outer_ring_] + inner_rings_)
       end
       
       
       # See ::RGeo::Feature::Factory#collection
       
       def collection(elems_)
-        ZMGeometryCollectionImpl.create(self, @zfactory.collection(elems_), @mfactory.collection(elems_))
+        _create_from_parts(ZMGeometryCollectionImpl, @zfactory.collection(elems_), elems_)
       end
       
       
       # See ::RGeo::Feature::Factory#multi_point
       
       def multi_point(elems_)
-        ZMGeometryCollectionImpl.create(self, @zfactory.multi_point(elems_), @mfactory.multi_point(elems_))
+        _create_from_parts(ZMGeometryCollectionImpl, @zfactory.multi_point(elems_), elems_)
       end
       
       
       # See ::RGeo::Feature::Factory#multi_line_string
       
       def multi_line_string(elems_)
-        ZMMultiLineStringImpl.create(self, @zfactory.multi_line_string(elems_), @mfactory.multi_line_string(elems_))
+        _create_from_parts(ZMMultiLineStringImpl, @zfactory.multi_line_string(elems_), elems_)
       end
       
       
       # See ::RGeo::Feature::Factory#multi_polygon
       
       def multi_polygon(elems_)
-        ZMMultiPolygonImpl.create(self, @zfactory.multi_polygon(elems_), @mfactory.multi_polygon(elems_))
+        _create_from_parts(ZMMultiPolygonImpl, @zfactory.multi_polygon(elems_), elems_)
       end
       
       
@@ -261,6 +309,75 @@ module RGeo
       end
       
       
+      # Creates a ZM line string of the given class from a newly built
+      # z geometry and the points it was built from, which supply the M
+      # values.
+      
+      def _create_from_points(klass_, zgeometry_, points_)  # :nodoc:
+        return nil unless zgeometry_
+        klass_.create(self, zgeometry_, _m_coords_for_points(points_.to_a, zgeometry_._num_coordinates))
+      end
+      
+      
+      # Creates a ZM polygon or collection of the given class from a newly
+      # built z geometry and the geometries that became its rings or
+      # elements, in order, which supply the M values.
+      
+      def _create_from_parts(klass_, zgeometry_, parts_)  # :nodoc:
+        return nil unless zgeometry_
+        if zgeometry_.geometry_type == Feature::Polygon
+          zparts_ = [zgeometry_.exterior_ring] + zgeometry_.interior_rings
+        else
+          zparts_ = (0...zgeometry_.num_geometries).map{ |i_| zgeometry_.geometry_n(i_) }
+        end
+        mcoords_ = []
+        parts_.to_a.each_with_index do |part_, i_|
+          mcoords_ << _m_coords_for(part_, zparts_[i_])
+        end
+        klass_.create(self, zgeometry_, mcoords_.join)
+      end
+      
+      
+      # Returns the packed M values for the given source geometry, as it
+      # appears in the given z geometry.
+      
+      def _m_coords_for(source_, zgeometry_)  # :nodoc:
+        count_ = zgeometry_._num_coordinates
+        if ZMGeometryImpl === source_ && source_._m_coords.size == count_ * 8
+          return source_._m_coords
+        end
+        type_ = source_.geometry_type
+        if type_ == Feature::Point
+          [_m_of(source_)].pack('d')
+        elsif type_.subtype_of?(Feature::LineString)
+          _m_coords_for_points(source_.points, count_)
+        elsif type_ == Feature::Polygon
+          ([_m_coords_for(source_.exterior_ring, zgeometry_.exterior_ring)] +
+            (0...source_.num_interior_rings).map{ |i_|
+              _m_coords_for(source_.interior_ring_n(i_), zgeometry_.interior_ring_n(i_)) }).join
+        else
+          (0...source_.num_geometries).map{ |i_|
+            _m_coords_for(source_.geometry_n(i_), zgeometry_.geometry_n(i_)) }.join
+        end
+      end
+      
+      
+      # Returns the packed M values for a sequence of points that made up
+      # a z geometry with the given number of coordinates. If GEOS closed
+      # a ring by adding a coordinate, the first point's M is repeated.
+      
+      def _m_coords_for_points(points_, count_)  # :nodoc:
+        mvalues_ = points_.map{ |p_| _m_of(p_) }
+        mvalues_ << mvalues_.first if count_ == mvalues_.size + 1
+        mvalues_.pack('d*')
+      end
+      
+      
+      def _m_of(point_)  # :nodoc:
+        point_.factory.property(:has_m_coordinate) ? point_.m.to_f : 0.0
+      end
+      
+      
       # See ::RGeo::Feature::Factory#override_cast
       
       def override_cast(original_, ntype_, flags_)
@@ -279,9 +396,7 @@ module RGeo
           then
             zresult_ = original_.z_geometry.dup
             zresult_._set_factory(@zfactory)
-            mresult_ = original_.m_geometry.dup
-            mresult_._set_factory(@mfactory)
-            return original_.class.create(self, zresult_, mresult_)
+            return original_.class.create(self, zresult_, original_._m_coords)
           end
           # LineString conversion optimization.
           if (original_.factory != self || ntype_ != type_) &&
@@ -290,8 +405,7 @@ module RGeo
           then
             klass_ = Factory::IMPL_CLASSES[ntype_]
             zresult_ = klass_._copy_from(@zfactory, original_.z_geometry)
-            mresult_ = klass_._copy_from(@mfactory, original_.m_geometry)
-            return ZMLineStringImpl.create(self, zresult_, mresult_)
+            return ZMLineStringImpl.create(self, zresult_, original_._m_coords)
           end
         end
         false
@@ -39,15 +39,22 @@ module RGeo
   module Geos
     
     
+    # A ZM geometry keeps a single GEOS geometry holding the X, Y and Z
+    # coordinates, which is used for all topological operations, and a
+    # String of packed doubles holding the M value of each coordinate,
+    # in the order GEOS stores the coordinates. A second GEOS geometry
+    # carrying M as its third ordinate is built only when an operation
+    # needs M values for newly computed coordinates.
+    
     class ZMGeometryImpl  # :nodoc:
       
       include Feature::Instance
       
       
-      def initialize(factory_, zgeometry_, mgeometry_)
+      def initialize(factory_, zgeometry_, mcoords_)
         @factory = factory_
         @zgeometry = zgeometry_
-        @mgeometry = mgeometry_
+        @mcoords = mcoords_
       end
       
       
@@ -71,12 +78,60 @@ module RGeo
       
       
       def m_geometry
+        unless defined?(@mgeometry)
+          xy_ = @zgeometry._packed_coordinates(false).unpack('d*')
+          coords_ = []
+          @mcoords.unpack('d*').each_with_index do |m_, i_|
+            coords_ << xy_[i_ * 2] << xy_[i_ * 2 + 1] << m_
+          end
+          @mgeometry = @factory.m_factory._copy_with_packed_coordinates(@zgeometry, coords_.pack('d*'), true)
+        end
         @mgeometry
       end
       
       
+      def _m_coords  # :nodoc:
+        @mcoords
+      end
+      
+      
+      # Returns the ZM geometry for a part of this geometry's GEOS
+      # geometry, whose coordinates start at the given coordinate offset.
+      
+      def _part(zpart_, offset_)  # :nodoc:
+        zpart_ ? ZMGeometryImpl.create(@factory, zpart_, @mcoords[offset_ * 8, zpart_._num_coordinates * 8]) : nil
+      end
+      
+      
+      # Marshal support. The z geometry is dumped along with the
+      # fingerprint of this geometry's factory and the packed M values.
+      
+      def _dump(level_)  # :nodoc:
+        ::Marshal.dump([@factory._marshal_fingerprint, @zgeometry, @mcoords])
+      end
+      
+      
+      def self._load(str_)  # :nodoc:
+        fingerprint_, zgeometry_, mcoords_ = ::Marshal.load(str_)
+        factory_ = ZMFactory._marshal_factory(fingerprint_)
+        zgeometry_._set_factory(factory_.z_factory)
+        new(factory_, zgeometry_, mcoords_)
+      end
+      
+      
+      def prepared?
+        @zgeometry.prepared?
+      end
+      
+      
+      def prepare!
+        @zgeometry.prepare!
+        self
+      end
+      
+      
       def eql?(rhs_)
-        rhs_.is_a?(self.class) && @factory.eql?(rhs_.factory) && @zgeometry.eql?(rhs_.z_geometry) && @mgeometry.eql?(rhs_.m_geometry)
+        rhs_.is_a?(self.class) && @factory.eql?(rhs_.factory) && @zgeometry.eql?(rhs_.z_geometry) && @mcoords == rhs_._m_coords
       end
       
       
@@ -96,7 +151,7 @@ module RGeo
       
       
       def envelope
-        ZMGeometryImpl.create(@factory, @zgeometry.envelope, @mgeometry.envelope)
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.envelope, m_geometry.envelope)
       end
       
       
@@ -121,7 +176,7 @@ module RGeo
       
       
       def boundary
-        ZMGeometryImpl.create(@factory, @zgeometry.boundary, @mgeometry.boundary)
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.boundary, m_geometry.boundary)
       end
       
       
@@ -176,32 +231,32 @@ module RGeo
       
       
       def buffer(distance_)
-        ZMGeometryImpl.create(@factory, @zgeometry.buffer(distance_), @mgeometry.buffer(distance_))
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.buffer(distance_), m_geometry.buffer(distance_))
       end
       
       
       def convex_hull
-        ZMGeometryImpl.create(@factory, @zgeometry.convex_hull, @mgeometry.convex_hull)
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.convex_hull, m_geometry.convex_hull)
       end
       
       
       def intersection(rhs_)
-        ZMGeometryImpl.create(@factory, @zgeometry.intersection(rhs_), @mgeometry.intersection(rhs_))
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.intersection(rhs_), m_geometry.intersection(rhs_))
       end
       
       
       def union(rhs_)
-        ZMGeometryImpl.create(@factory, @zgeometry.union(rhs_), @mgeometry.union(rhs_))
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.union(rhs_), m_geometry.union(rhs_))
       end
       
       
       def difference(rhs_)
-        ZMGeometryImpl.create(@factory, @zgeometry.difference(rhs_), @mgeometry.difference(rhs_))
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.difference(rhs_), m_geometry.difference(rhs_))
       end
       
       
       def sym_difference(rhs_)
-        ZMGeometryImpl.create(@factory, @zgeometry.sym_difference(rhs_), @mgeometry.sym_difference(rhs_))
+        ZMGeometryImpl._create_from_pair(@factory, @zgeometry.sym_difference(rhs_), m_geometry.sym_difference(rhs_))
       end
       
       
@@ -232,7 +287,7 @@ module RGeo
       
       
       def m
-        @mgeometry.m
+        @mcoords.unpack('d')[0]
       end
       
       
@@ -273,16 +328,14 @@ module RGeo
       
       
       def point_n(n_)
-        ZMPointImpl.create(@factory, @zgeometry.point_n(n_), @mgeometry.point_n(n_))
+        n_ >= 0 ? _part(@zgeometry.point_n(n_), n_) : nil
       end
       
       
       def points
         result_ = []
-        zpoints_ = @zgeometry.points
-        mpoints_ = @mgeometry.points
-        zpoints_.size.times do |i_|
-          result_ << ZMPointImpl.create(@factory, zpoints_[i_], mpoints_[i_])
+        @zgeometry.points.each_with_index do |zpoint_, i_|
+          result_ << ZMPointImpl.create(@factory, zpoint_, @mcoords[i_ * 8, 8])
         end
         result_
       end
@@ -300,17 +353,17 @@ module RGeo
       
       
       def centroid
-        ZMPointImpl.create(@factory, @zgeometry.centroid, @mgeometry.centroid)
+        ZMPointImpl._create_from_pair(@factory, @zgeometry.centroid, m_geometry.centroid)
       end
       
       
       def point_on_surface
-        ZMPointImpl.create(@factory, @zgeometry.centroid, @mgeometry.centroid)
+        ZMPointImpl._create_from_pair(@factory, @zgeometry.centroid, m_geometry.centroid)
       end
       
       
       def exterior_ring
-        ZMLineStringImpl.create(@factory, @zgeometry.exterior_ring, @mgeometry.exterior_ring)
+        _part(@zgeometry.exterior_ring, 0)
       end
       
       
@@ -320,16 +373,19 @@ module RGeo
       
       
       def interior_ring_n(n_)
-        ZMLineStringImpl.create(@factory, @zgeometry.interior_ring_n(n_), @mgeometry.interior_ring_n(n_))
+        return nil if n_ < 0 || n_ >= num_interior_rings
+        offset_ = @zgeometry.exterior_ring._num_coordinates
+        n_.times{ |i_| offset_ += @zgeometry.interior_ring_n(i_)._num_coordinates }
+        _part(@zgeometry.interior_ring_n(n_), offset_)
       end
       
       
       def interior_rings
         result_ = []
-        zrings_ = @zgeometry.interior_rings
-        mrings_ = @mgeometry.interior_rings
-        zrings_.size.times do |i_|
-          result_ << ZMLineStringImpl.create(@factory, zrings_[i_], mrings_[i_])
+        offset_ = @zgeometry.exterior_ring._num_coordinates
+        @zgeometry.interior_rings.each do |zring_|
+          result_ << _part(zring_, offset_)
+          offset_ += zring_._num_coordinates
         end
         result_
       end
@@ -351,14 +407,20 @@ module RGeo
       
       
       def geometry_n(n_)
-        ZMGeometryImpl.create(@factory, @zgeometry.geometry_n(n_), @mgeometry.geometry_n(n_))
+        return nil if n_ < 0 || n_ >= num_geometries
+        offset_ = 0
+        n_.times{ |i_| offset_ += @zgeometry.geometry_n(i_)._num_coordinates }
+        _part(@zgeometry.geometry_n(n_), offset_)
       end
       alias_method :[], :geometry_n
       
       
       def each
+        offset_ = 0
         num_geometries.times do |i_|
-          yield geometry_n(i_)
+          zpart_ = @zgeometry.geometry_n(i_)
+          yield _part(zpart_, offset_)
+          offset_ += zpart_._num_coordinates
         end
       end
       
@@ -391,12 +453,12 @@ module RGeo
       
       
       def centroid
-        ZMPointImpl.create(@factory, @zgeometry.centroid, @mgeometry.centroid)
+        ZMPointImpl._create_from_pair(@factory, @zgeometry.centroid, m_geometry.centroid)
       end
       
       
       def point_on_surface
-        ZMPointImpl.create(@factory, @zgeometry.centroid, @mgeometry.centroid)
+        ZMPointImpl._create_from_pair(@factory, @zgeometry.centroid, m_geometry.centroid)
       end
       
       
@@ -418,9 +480,23 @@ module RGeo
       }.freeze
       
       
-      def self.create(factory_, zgeometry_, mgeometry_)
+      def self.create(factory_, zgeometry_, mcoords_)
+        return nil unless zgeometry_ && mcoords_
         klass_ = self == ZMGeometryImpl ? TYPE_KLASSES[zgeometry_.geometry_type] : self
-        klass_ && zgeometry_ && mgeometry_ ? klass_.new(factory_, zgeometry_, mgeometry_) : nil
+        klass_ ? klass_.new(factory_, zgeometry_, mcoords_) : nil
+      end
+      
+      
+      # Creates a geometry from the results of running the same operation
+      # on a geometry's z and m views, taking the M values from the
+      # third ordinate of the m result.
+      
+      def self._create_from_pair(factory_, zgeometry_, mgeometry_)  # :nodoc:
+        return nil unless zgeometry_ && mgeometry_
+        coords_ = mgeometry_._packed_coordinates(true).unpack('d*')
+        mvalues_ = []
+        2.step(coords_.size - 1, 3){ |i_| mvalues_ << coords_[i_] }
+        create(factory_, zgeometry_, mvalues_.pack('d*'))
       end
       
       
@@ -136,7 +136,7 @@ module RGeo
       
       
       def length
-        @elements.inject(0.0){ |sum_, obj_| sum_ + obj_.length }
+        @length ||= @elements.inject(0.0){ |sum_, obj_| sum_ + obj_.length }
       end
       
       
@@ -70,3 +70,6 @@ require 'rgeo/wkrep/wkt_parser'
 require 'rgeo/wkrep/wkt_generator'
 require 'rgeo/wkrep/wkb_parser'
 require 'rgeo/wkrep/wkb_generator'
+begin
+  require 'rgeo/wkrep/wkrep_c_impl'
+rescue ::LoadError; end
@@ -70,6 +70,10 @@ module RGeo
     # [<tt>:little_endian</tt>]
     #   If true, output little endian (NDR) byte order. If false, output
     #   big endian (XDR), or network byte order. Default is false.
+    # 
+    # If the native WKRep extension is available, generation is done in
+    # C. Otherwise, a pure ruby implementation is used. The two behave
+    # identically.
     
     class WKBGenerator
       
@@ -127,6 +131,7 @@ module RGeo
       # according to the current settings.
       
       def generate(obj_)
+        return _generate_native(obj_) if respond_to?(:_generate_native)
         factory_ = obj_.factory
         if @type_format == :ewkb || @type_format == :wkb12
           @cur_has_z = factory_.property(:has_z_coordinate)
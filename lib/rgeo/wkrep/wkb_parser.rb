@@ -53,7 +53,9 @@ module RGeo
     # It should understand the configuration options <tt>:srid</tt>,
     # <tt>:has_z_coordinate</tt>, and <tt>:has_m_coordinate</tt>.
     # You may also pass a specific RGeo::Feature::Factory, or nil to
-    # specify the default Cartesian FactoryGenerator.
+    # specify the default Cartesian FactoryGenerator, which reuses
+    # factories across parses (see
+    # RGeo::Cartesian.memoized_factory_generator).
     # 
     # The following additional options are recognized. These can be passed
     # to the constructor, or set on the object afterwards.
@@ -73,6 +75,10 @@ module RGeo
     # [<tt>:default_srid</tt>]
     #   A SRID to pass to the factory generator if no SRID is present in
     #   the input. Defaults to nil (i.e. don't specify a SRID).
+    # 
+    # If the native WKRep extension is available, parsing is done in C.
+    # Otherwise, a pure ruby implementation is used. The two behave
+    # identically.
     
     class WKBParser
       
@@ -88,7 +94,7 @@ module RGeo
           @factory_generator = factory_generator_
           @exact_factory = nil
         else
-          @factory_generator = Cartesian.method(:preferred_factory)
+          @factory_generator = Cartesian.memoized_factory_generator
           @exact_factory = nil
         end
         @support_ewkb = opts_[:support_ewkb] ? true : false
@@ -141,6 +147,7 @@ module RGeo
       # reasons but deprecated. Use #parse instead.
       
       def parse(data_)
+        return _parse_native(data_) if respond_to?(:_parse_native)
         if data_[0,1] =~ /[0-9a-fA-F]/
           data_ = [data_].pack('H*')
         end
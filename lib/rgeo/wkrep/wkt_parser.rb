@@ -56,7 +56,9 @@ module RGeo
     # It should understand the configuration options <tt>:srid</tt>,
     # <tt>:has_z_coordinate</tt>, and <tt>:has_m_coordinate</tt>.
     # You may also pass a specific RGeo::Feature::Factory, or nil to
-    # specify the default Cartesian FactoryGenerator.
+    # specify the default Cartesian FactoryGenerator, which reuses
+    # factories across parses (see
+    # RGeo::Cartesian.memoized_factory_generator).
     # 
     # The following additional options are recognized. These can be passed
     # to the constructor, or set on the object afterwards.
@@ -80,6 +82,9 @@ module RGeo
     # [<tt>:default_srid</tt>]
     #   A SRID to pass to the factory generator if no SRID is present in
     #   the input. Defaults to nil (i.e. don't specify a SRID).
+    # 
+    # If the native WKRep extension is available, tokenizing is done in
+    # C. Otherwise, a pure ruby tokenizer is used.
     
     class WKTParser
       
@@ -95,7 +100,7 @@ module RGeo
           @factory_generator = factory_generator_
           @exact_factory = nil
         else
-          @factory_generator = Cartesian.method(:preferred_factory)
+          @factory_generator = Cartesian.memoized_factory_generator
           @exact_factory = nil
         end
         @support_ewkt = opts_[:support_ewkt] ? true : false
@@ -171,6 +176,50 @@ module RGeo
       end
       
       
+      # Parse a sequence of geometries from the given IO object, and
+      # yield each one to the given block. Each geometry must be
+      # terminated by a newline or a semicolon. (If EWKT support is
+      # active, the semicolon following an SRID prefix does not count.)
+      # Blank entries are skipped. The input is read in chunks, so the
+      # whole input does not need to fit in memory at once.
+      # 
+      # Returns an Enumerator if no block is given.
+      
+      def each_geometry(io_)
+        return enum_for(:each_geometry, io_) unless block_given?
+        partial_ = ''
+        prefix_ = nil
+        loop do
+          chunk_ = io_.read(65536)
+          if chunk_
+            # Only the new chunk is split. Its first piece continues the
+            # partial entry carried over from earlier chunks, and its last
+            # piece starts the next one.
+            entries_ = chunk_.split(/[;\n]/, -1)
+            partial_ << entries_.shift.to_s
+            unless entries_.empty?
+              entries_.unshift(partial_)
+              partial_ = entries_.pop
+            end
+          else
+            entries_ = [partial_]
+          end
+          entries_.each do |entry_|
+            entry_ = entry_.strip
+            next if entry_.length == 0
+            if @support_ewkt && entry_ =~ /^srid=\d+$/i
+              prefix_ = "#{entry_};"
+            else
+              yield parse(prefix_ ? prefix_ + entry_ : entry_)
+              prefix_ = nil
+            end
+          end
+          break unless chunk_
+        end
+        self
+      end
+      
+      
       def _check_factory_support  # :nodoc:
         if @cur_expect_z && !@cur_factory_support_z
           raise Error::ParseError, "Geometry calls for Z coordinate but factory doesn't support it."
@@ -251,41 +300,76 @@ module RGeo
       
       def _parse_coords  # :nodoc:
         _expect_token_type(::Numeric)
-        x_ = @cur_token
-        _next_token
-        _expect_token_type(::Numeric)
-        y_ = @cur_token
-        _next_token
-        extra_ = []
-        if @cur_expect_z.nil?
+        if @_native_scanner
+          coords_ = @_native_scanner.next_numbers.unshift(@cur_token)
+          _next_token
+        else
+          coords_ = []
           while ::Numeric === @cur_token
-            extra_ << @cur_token
+            coords_ << @cur_token
             _next_token
           end
-          num_extras_ = extra_.size
+        end
+        _point_from_coords(coords_)
+      end
+      
+      
+      # Parses a run of comma-separated coordinate tuples and appends
+      # the points to the given array. The native scanner reads the whole
+      # run in one call; otherwise this parses a single tuple, and the
+      # caller's loop handles the commas.
+      
+      def _parse_coord_list(points_)  # :nodoc:
+        if @_native_scanner
+          _expect_token_type(::Numeric)
+          tuples_ = @_native_scanner.next_coord_list
+          tuples_[0].unshift(@cur_token)
+          _next_token
+          tuples_.each{ |coords_| points_ << _point_from_coords(coords_) }
+        else
+          points_ << _parse_coords
+        end
+        points_
+      end
+      
+      
+      def _point_from_coords(coords_)  # :nodoc:
+        if coords_.size < 2
+          raise Error::ParseError, "Found #{coords_.size} coordinates, but expected at least 2."
+        end
+        x_ = coords_[0]
+        y_ = coords_[1]
+        extra_ = []
+        if @cur_expect_z.nil?
+          num_extras_ = coords_.size - 2
           @cur_expect_z = num_extras_ > 0 && (!@cur_factory || @cur_factory_support_z) ? true : false
           num_extras_ -= 1 if @cur_expect_z
           @cur_expect_m = num_extras_ > 0 && (!@cur_factory || @cur_factory_support_m) ? true : false
           num_extras_ -= 1 if @cur_expect_m
           if num_extras_ > 0
-            raise Error::ParseError, "Found #{extra_.size+2} coordinates, which is too many for this factory."
+            raise Error::ParseError, "Found #{coords_.size} coordinates, which is too many for this factory."
           end
           _ensure_factory
+          extra_ = coords_[2..-1]
         else
+          expected_ = 2
+          expected_ += 1 if @cur_expect_z
+          expected_ += 1 if @cur_expect_m
+          if coords_.size != expected_
+            raise Error::ParseError, "Found #{coords_.size} coordinates, but expected #{expected_}."
+          end
+          index_ = 2
           val_ = 0
           if @cur_expect_z
-            _expect_token_type(::Numeric)
-            val_ = @cur_token
-            _next_token
+            val_ = coords_[index_]
+            index_ += 1
           end
           if @cur_factory_support_z
             extra_ << val_
           end
           val_ = 0
           if @cur_expect_m
-            _expect_token_type(::Numeric)
-            val_ = @cur_token
-            _next_token
+            val_ = coords_[index_]
           end
           if @cur_factory_support_m
             extra_ << val_
@@ -315,7 +399,7 @@ module RGeo
           _expect_token_type(:begin)
           _next_token
           loop do
-            points_ << _parse_coords
+            _parse_coord_list(points_)
             break if @cur_token == :end
             _expect_token_type(:comma)
             _next_token
@@ -415,13 +499,18 @@ module RGeo
       
       
       def _start_scanner(str_)  # :nodoc:
-        @_scanner = ::StringScanner.new(str_)
+        if defined?(WKTScanner)
+          @_native_scanner = WKTScanner.new(str_)
+        else
+          @_scanner = ::StringScanner.new(str_)
+        end
         _next_token
       end
       
       
       def _clean_scanner  # :nodoc:
         @_scanner = nil
+        @_native_scanner = nil
         @cur_token = nil
       end
       
@@ -434,6 +523,7 @@ module RGeo
       
       
       def _next_token  # :nodoc:
+        return @cur_token = @_native_scanner.next_token if @_native_scanner
         if @_scanner.scan_until(/\(|\)|\[|\]|,|[^\s\(\)\[\],]+/)
           token_ = @_scanner.matched
           case token_
@@ -104,6 +104,28 @@ module RGeo
         end
         
         
+        def test_simple_mercator_transform_array
+          geography_ = RGeo::CoordSys::Proj4.create('+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :radians => true)
+          projection_ = RGeo::CoordSys::Proj4.create('+proj=merc +a=6378137 +b=6378137 +lat_ts=0.0 +lon_0=0.0 +x_0=0.0 +y_0=0 +k=1.0 +units=m +nadgrids=@null +wktext +no_defs')
+          coords_ = RGeo::CoordSys::Proj4.transform_coords_array(geography_, projection_, [0, 0, 0.01, 0.01, -1, -1])
+          assert_equal(6, coords_.size)
+          _assert_xy_close(_project_merc(0, 0), coords_[0, 2])
+          _assert_xy_close(_project_merc(0.01, 0.01), coords_[2, 2])
+          _assert_xy_close(_project_merc(-1, -1), coords_[4, 2])
+          packed_ = RGeo::CoordSys::Proj4.transform_coords_array(geography_, projection_, [1, 1, -1, -1].pack('d*'))
+          coords_ = packed_.unpack('d*')
+          _assert_xy_close(_project_merc(1, 1), coords_[0, 2])
+          _assert_xy_close(_project_merc(-1, -1), coords_[2, 2])
+        end
+        
+        
+        def test_identity_transform_array
+          proj_ = RGeo::CoordSys::Proj4.create('+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs')
+          assert_equal([1, 2, 0, 3, 4, 5], RGeo::CoordSys::Proj4.transform_coords_array(proj_, proj_, [1, 2, 0, 3, 4, 5], true))
+          assert_equal([], RGeo::CoordSys::Proj4.transform_coords_array(proj_, proj_, []))
+        end
+        
+        
         def test_equivalence
           proj1_ = RGeo::CoordSys::Proj4.create('+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs')
           proj2_ = RGeo::CoordSys::Proj4.create('+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs')
@@ -121,6 +143,49 @@ module RGeo
         end
         
         
+        def test_line_string_transform_lowlevel
+          geography_ = RGeo::Geos.factory(:proj4 => '+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :srid =>4326)
+          projection_ = RGeo::Geos.factory(:proj4 => '+proj=tmerc +lat_0=49 +lon_0=-2 +k=0.9996012717 +x_0=400000 +y_0=-100000 +ellps=airy +datum=OSGB36 +units=m +no_defs', :srid => 27700)
+          proj_line_ = projection_.parse_wkt('LINESTRING(473600.5 186659.8, 400000 -100000)')
+          geo_line_ = RGeo::CoordSys::Proj4.transform(projection_.proj4, proj_line_, geography_.proj4, geography_)
+          assert_equal(2, geo_line_.num_points)
+          _assert_close_enough(-0.9393598527244420, geo_line_.point_n(0).x)
+          _assert_close_enough(51.5740106527552697, geo_line_.point_n(0).y)
+          _assert_close_enough(-2.0, geo_line_.point_n(1).x.round(2))
+        end
+        
+        
+        def test_polygon_projection_cast
+          geography_ = RGeo::Geos.factory(:proj4 => '+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :srid =>4326)
+          projection_ = RGeo::Geos.factory(:proj4 => '+proj=tmerc +lat_0=49 +lon_0=-2 +k=0.9996012717 +x_0=400000 +y_0=-100000 +ellps=airy +datum=OSGB36 +units=m +no_defs', :srid => 27700)
+          proj_poly_ = projection_.parse_wkt('POLYGON((473600.5 186659.8, 473700.5 186659.8, 473700.5 186759.8, 473600.5 186659.8), (473650 186670, 473660 186670, 473660 186680, 473650 186670))')
+          geo_poly_ = RGeo::Feature.cast(proj_poly_, :project => true, :factory => geography_)
+          assert_equal(geography_, geo_poly_.factory)
+          assert_equal(1, geo_poly_.num_interior_rings)
+          assert_equal(4, geo_poly_.exterior_ring.num_points)
+          assert_equal(geo_poly_.exterior_ring.point_n(0), geo_poly_.exterior_ring.point_n(3))
+          geo_point_ = RGeo::Feature.cast(proj_poly_.exterior_ring.point_n(0), :project => true, :factory => geography_)
+          assert_equal(geo_point_, geo_poly_.exterior_ring.point_n(0))
+          _assert_close_enough(-0.9393598527244420, geo_point_.x)
+          round_trip_ = RGeo::Feature.cast(geo_poly_, :project => true, :factory => projection_)
+          _assert_close_enough(473700.5, round_trip_.exterior_ring.point_n(1).x)
+          _assert_close_enough(186759.8, round_trip_.exterior_ring.point_n(2).y)
+        end
+        
+        
+        def test_multi_line_string_transform_lowlevel
+          geography_ = RGeo::Geos.factory(:proj4 => '+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :srid =>4326)
+          projection_ = RGeo::Geos.factory(:proj4 => '+proj=tmerc +lat_0=49 +lon_0=-2 +k=0.9996012717 +x_0=400000 +y_0=-100000 +ellps=airy +datum=OSGB36 +units=m +no_defs', :srid => 27700, :has_z_coordinate => true)
+          proj_mls_ = projection_.parse_wkt('MULTILINESTRING((473600.5 186659.8 10, 473700.5 186659.8 20), EMPTY)')
+          geo_mls_ = RGeo::CoordSys::Proj4.transform(projection_.proj4, proj_mls_, geography_.proj4, geography_)
+          assert_equal(RGeo::Feature::MultiLineString, geo_mls_.geometry_type)
+          assert_equal(2, geo_mls_.num_geometries)
+          assert_equal(true, geo_mls_[1].is_empty?)
+          assert_in_delta(-0.93935985, geo_mls_[0].point_n(0).x, 0.000001)
+          assert_in_delta(51.57401065, geo_mls_[0].point_n(0).y, 0.000001)
+        end
+        
+        
         def test_point_transform_lowlevel
           geography_ = RGeo::Geos.factory(:proj4 => '+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :srid =>4326)
           projection_ = RGeo::Geos.factory(:proj4 => '+proj=tmerc +lat_0=49 +lon_0=-2 +k=0.9996012717 +x_0=400000 +y_0=-100000 +ellps=airy +datum=OSGB36 +units=m +no_defs', :srid => 27700)
@@ -131,6 +196,20 @@ module RGeo
         end
         
         
+        def test_multi_point_transform_2d_to_3d
+          geography_ = RGeo::Geos.factory(:proj4 => '+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :srid => 4326)
+          geography_z_ = RGeo::Geos.factory(:proj4 => '+proj=longlat +ellps=WGS84 +datum=WGS84 +no_defs', :srid => 4326, :has_z_coordinate => true)
+          mp_ = geography_.parse_wkt('MULTIPOINT((1 2), (3 4))')
+          geo_mp_ = RGeo::CoordSys::Proj4.transform(geography_.proj4, mp_, geography_z_.proj4, geography_z_)
+          assert_equal(2, geo_mp_.num_geometries)
+          _assert_close_enough(1.0, geo_mp_[0].x)
+          _assert_close_enough(2.0, geo_mp_[0].y)
+          assert_equal(0.0, geo_mp_[0].z)
+          _assert_close_enough(3.0, geo_mp_[1].x)
+          assert_equal(0.0, geo_mp_[1].z)
+        end
+        
+        
       end
       
     end
@@ -35,6 +35,7 @@
 
 
 require 'test/unit'
+require 'tmpdir'
 require 'rgeo'
 
 
@@ -69,6 +70,67 @@ module RGeo
         end
         
         
+        def _with_data_file(content_)
+          dir_ = ::File.join(::Dir.tmpdir, "rgeo_test_proj4_data_#{::Process.pid}")
+          ::Dir.mkdir(dir_)
+          begin
+            ::File.open("#{dir_}/test", 'w'){ |f_| f_.write(content_) }
+            yield(dir_)
+          ensure
+            ::Dir.glob("#{dir_}/*").each{ |f_| ::File.delete(f_) }
+            ::Dir.rmdir(dir_)
+          end
+        end
+        
+        
+        DATA = "# header\n# First\n<10> +a=1 <>\n# Second\n<2> +a=2\n  +b=3 <>\n<300> +c=4 <>\n"
+        
+        
+        def test_index_lookup
+          _with_data_file(DATA) do |dir_|
+            db_ = ::RGeo::CoordSys::SRSDatabase::Proj4Data.new('test', :dir => dir_, :index => true)
+            assert(::File.file?("#{dir_}/test.rgeoidx"))
+            assert_equal(['10', 'First', '+a=1'], db_._search_index('10'))
+            assert_equal(['2', 'Second', '+a=2 +b=3'], db_._search_index('2'))
+            assert_equal(['300', nil, '+c=4'], db_._search_index('300'))
+            assert_nil(db_._search_index('1'))
+            assert_nil(db_._search_index('3000'))
+            assert_equal('Second', db_.get(2).name)
+          end
+        end
+        
+        
+        def test_index_rebuilt_when_data_changes
+          _with_data_file(DATA) do |dir_|
+            db_ = ::RGeo::CoordSys::SRSDatabase::Proj4Data.new('test', :dir => dir_, :index => "#{dir_}/idx")
+            assert_nil(db_._search_index('42'))
+            ::File.open("#{dir_}/test", 'a'){ |f_| f_.write("# Added\n<42> +d=5 <>\n") }
+            assert_equal(['42', 'Added', '+d=5'], db_._search_index('42'))
+          end
+        end
+        
+        
+        def test_index_rebuilt_when_size_changes_with_same_mtime
+          _with_data_file(DATA) do |dir_|
+            db_ = ::RGeo::CoordSys::SRSDatabase::Proj4Data.new('test', :dir => dir_, :index => "#{dir_}/idx")
+            mtime_ = ::File.mtime("#{dir_}/test")
+            ::File.open("#{dir_}/test", 'w'){ |f_| f_.write("# Only\n<7> +e=6 <>\n" + DATA) }
+            ::File.utime(mtime_, mtime_, "#{dir_}/test")
+            assert_equal(['7', 'Only', '+e=6'], db_._search_index('7'))
+            assert_equal(['300', nil, '+c=4'], db_._search_index('300'))
+          end
+        end
+        
+        
+        def test_preload
+          _with_data_file(DATA) do |dir_|
+            db_ = ::RGeo::CoordSys::SRSDatabase::Proj4Data.new('test', :dir => dir_, :cache => :preload, :authority => 'test')
+            assert_equal('First', db_.get(10).name)
+            assert_equal('300', db_.get(300).authority_code)
+          end
+        end
+        
+        
       end
       
     end
@@ -0,0 +1,134 @@
+# -----------------------------------------------------------------------------
+# 
+# Tests for the SRS database cache
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+
+require 'test/unit'
+require 'tmpdir'
+require 'rgeo'
+
+
+module RGeo
+  module Tests  # :nodoc:
+    module CoordSys  # :nodoc:
+      
+      class TestSRSDatabaseCache < ::Test::Unit::TestCase  # :nodoc:
+        
+        
+        def test_fetch_caches_values
+          cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new
+          calls_ = 0
+          2.times{ assert_equal('a', cache_.fetch([:test, 1]){ calls_ += 1; 'a' }) }
+          assert_nil(cache_.fetch([:test, 2]){ calls_ += 1; nil })
+          assert_nil(cache_.fetch([:test, 2]){ calls_ += 1; 'b' })
+          assert_equal(2, calls_)
+          assert(cache_.include?([:test, 1]))
+        end
+        
+        
+        def test_ttl
+          cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new(:ttl => 0)
+          calls_ = 0
+          2.times{ cache_.fetch([:test, 1]){ calls_ += 1 } }
+          assert_equal(2, calls_)
+          assert(!cache_.include?([:test, 1]))
+        end
+        
+        
+        def test_requests_are_coalesced
+          cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new
+          calls_ = 0
+          threads_ = (0...5).map do
+            ::Thread.new do
+              cache_.fetch([:test, 4326]){ calls_ += 1; sleep(0.1); 'wgs84' }
+            end
+          end
+          assert_equal(['wgs84'] * 5, threads_.map{ |t_| t_.value })
+          assert_equal(1, calls_)
+        end
+        
+        
+        def test_failed_fetch_is_not_cached
+          cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new
+          assert_raise(::RuntimeError){ cache_.fetch([:test, 1]){ raise 'unavailable' } }
+          assert_equal('a', cache_.fetch([:test, 1]){ 'a' })
+        end
+        
+        
+        def test_clear_namespace
+          cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new
+          cache_.fetch([:one, 1]){ 'a' }
+          cache_.fetch([:two, 1]){ 'b' }
+          cache_.clear(:one)
+          assert(!cache_.include?([:one, 1]))
+          assert(cache_.include?([:two, 1]))
+          cache_.clear
+          assert(!cache_.include?([:two, 1]))
+        end
+        
+        
+        def test_backing_file
+          path_ = ::File.join(::Dir.tmpdir, "rgeo_srs_cache_test_#{::Process.pid}")
+          begin
+            cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new(:path => path_)
+            entry_ = ::RGeo::CoordSys::SRSDatabase::Entry.new(3785, :name => 'Mercator', :description => 'test')
+            cache_.fetch([:test, 3785]){ entry_ }
+            cache2_ = ::RGeo::CoordSys::SRSDatabase::Cache.new(:path => path_)
+            assert(cache2_.include?([:test, 3785]))
+            entry2_ = cache2_.fetch([:test, 3785]){ flunk('expected cached entry') }
+            assert_equal('Mercator', entry2_.name)
+            assert_equal('test', entry2_.description)
+          ensure
+            ::File.delete(path_) if ::File.exist?(path_)
+          end
+        end
+        
+        
+        def test_shared_by_databases
+          cache_ = ::RGeo::CoordSys::SRSDatabase::Cache.new
+          entry_ = ::RGeo::CoordSys::SRSDatabase::Entry.new('http://example.com/4326', :name => 'WGS 84')
+          cache_.fetch([:url_reader, 'http://example.com/4326']){ entry_ }
+          db_ = ::RGeo::CoordSys::SRSDatabase::UrlReader.new(:cache => cache_, :keep_alive => true)
+          assert(db_.get('http://example.com/4326').equal?(entry_))
+          db_.clear_cache
+          assert(!cache_.include?([:url_reader, 'http://example.com/4326']))
+        end
+        
+        
+      end
+      
+    end
+  end
+end
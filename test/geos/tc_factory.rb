@@ -50,6 +50,12 @@ module RGeo
         end
         
         
+        def test_factory_is_shared
+          assert(@factory.equal?(::RGeo::Geos.factory(:srid => 4326)))
+          assert(!::RGeo::Geos.factory(:collect_stats => true).equal?(::RGeo::Geos.factory(:collect_stats => true)))
+        end
+        
+        
         def test_srid_preserved_through_factory
           geom_ = @factory.point(-10, 20)
           assert_equal(4326, geom_.srid)
@@ -84,6 +90,83 @@ module RGeo
         end
         
         
+        def test_line_string_from_coordinates
+          geom_ = @factory.line_string_from_coordinates([1, 2, 3.5, 4, 5, 6])
+          assert_equal(::RGeo::Feature::LineString, geom_.geometry_type)
+          assert_equal(3, geom_.num_points)
+          assert_equal(@factory.point(3.5, 4), geom_.point_n(1))
+          assert_equal(geom_, @factory.line_string_from_coordinates([1, 2, 3.5, 4, 5, 6].pack('d*')))
+          assert_nil(@factory.line_string_from_coordinates([1, 2, 3]))
+          assert_nil(@factory.line_string_from_coordinates([1, 2, 'a', 4]))
+        end
+        
+        
+        def test_polygon_from_coordinates
+          geom_ = @factory.polygon_from_coordinates([0, 0, 10, 0, 10, 10, 0, 10], [[1, 1, 2, 1, 2, 2]])
+          assert_equal(::RGeo::Feature::Polygon, geom_.geometry_type)
+          assert_equal(5, geom_.exterior_ring.num_points)
+          assert_equal(1, geom_.num_interior_rings)
+          assert_equal(99.5, geom_.area)
+        end
+        
+        
+        def test_multi_point_from_coordinates_with_z
+          factory_ = ::RGeo::Geos.factory(:has_z_coordinate => true)
+          geom_ = factory_.multi_point_from_coordinates([1, 2, 3, 4, 5, 6].pack('d*'))
+          assert_equal(2, geom_.num_geometries)
+          assert_equal(6, geom_.geometry_n(1).z)
+        end
+        
+        
+        def _square(x_, y_)
+          @factory.polygon(@factory.linear_ring([@factory.point(x_, y_), @factory.point(x_+2, y_),
+            @factory.point(x_+2, y_+2), @factory.point(x_, y_+2)]))
+        end
+        
+        
+        def _components(geom_, dimension_)
+          geom_.select{ |g_| g_.dimension == dimension_ }
+        end
+        
+        
+        def _dimensions(geom_)
+          geom_.map{ |g_| g_.dimension }.sort
+        end
+        
+        
+        def test_union_all
+          geom_ = @factory.union_all([_square(0, 0), _square(1, 1), _square(10, 10)])
+          assert_equal(::RGeo::Feature::MultiPolygon, geom_.geometry_type)
+          assert_equal(2, geom_.num_geometries)
+          assert_in_delta(11, geom_.area, 1e-10)
+          assert_equal(4326, geom_.srid)
+          assert_equal(::RGeo::Feature::Polygon, @factory.union_all([_square(0, 0), _square(1, 1)]).geometry_type)
+          assert(@factory.union_all([]).is_empty?)
+        end
+        
+        
+        def test_unary_union
+          factory_ = ::RGeo::Geos.factory(:srid => 4326, :lenient_multi_polygon_assertions => true)
+          multi_ = factory_.multi_polygon([_square(0, 0), _square(2, 0)])
+          union_ = multi_.unary_union
+          assert_equal(::RGeo::Feature::Polygon, union_.geometry_type)
+          assert_in_delta(8, union_.area, 1e-10)
+          collection_ = @factory.collection([_square(0, 0), @factory.point(1, 1), @factory.point(5, 5)])
+          union_ = collection_.unary_union
+          assert_in_delta(4, union_.area, 1e-10)
+          assert_equal(2, union_.num_geometries)
+          assert_equal([0, 2], _dimensions(union_))
+          assert_equal(@factory.point(5, 5), _components(union_, 0).first)
+          overlapping_ = @factory.collection([_square(0, 0), _square(1, 1),
+            @factory.line(@factory.point(-1, 1), @factory.point(1, 1))])
+          union_ = overlapping_.unary_union
+          assert_in_delta(7, union_.area, 1e-10)
+          assert_equal(2, union_.num_geometries)
+          assert_equal([1, 2], _dimensions(union_))
+          assert_in_delta(1, _components(union_, 1).first.length, 1e-10)
+        end
+        
+        
       end
       
     end
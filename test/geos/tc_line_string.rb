@@ -55,6 +55,17 @@ module RGeo
         include ::RGeo::Tests::Common::LineStringTests
         
         
+        def test_coordinate_access
+          line_ = @factory.line_string([@factory.point(1, 2), @factory.point(3, 4.5)])
+          assert_equal([1.0, 2.0, 3.0, 4.5], line_.flat_coordinates)
+          assert_equal([1.0, 2.0, 3.0, 4.5].pack('d*'), line_.packed_coordinates)
+          coords_ = []
+          assert_equal(line_, line_.each_coordinate{ |x_, y_| coords_ << [x_, y_] })
+          assert_equal([[1.0, 2.0], [3.0, 4.5]], coords_)
+          assert_equal([[1.0, 2.0], [3.0, 4.5]], line_.each_coordinate.to_a)
+        end
+        
+        
       end
       
     end
@@ -65,6 +65,261 @@ module RGeo
         end
         
         
+        def _square(factory_)
+          factory_.polygon(factory_.linear_ring([factory_.point(0, 0),
+            factory_.point(0, 2), factory_.point(2, 2), factory_.point(2, 0)]))
+        end
+        
+        
+        def test_prepare
+          poly_ = _square(::RGeo::Geos.factory(:auto_prepare => :disabled))
+          assert_equal(false, poly_.prepared?)
+          assert_equal(poly_, poly_.prepare!)
+          assert_equal(true, poly_.prepared?)
+          assert(poly_.contains?(poly_.factory.point(1, 1)))
+          assert(!poly_.contains?(poly_.factory.point(3, 1)))
+          assert(poly_.intersects?(poly_.factory.point(2, 1)))
+          assert(!poly_.intersects?(poly_.factory.point(3, 1)))
+        end
+        
+        
+        def test_auto_prepare
+          poly_ = _square(@factory)
+          point_ = @factory.point(1, 1)
+          assert_equal(false, poly_.prepared?)
+          assert(poly_.contains?(point_))
+          assert_equal(false, poly_.prepared?)
+          assert(poly_.contains?(point_))
+          assert_equal(true, poly_.prepared?)
+          assert(!poly_.contains?(@factory.point(3, 1)))
+        end
+        
+        
+        def test_auto_prepare_disabled
+          poly_ = _square(::RGeo::Geos.factory(:auto_prepare => :disabled))
+          point_ = poly_.factory.point(1, 1)
+          3.times{ assert(poly_.contains?(point_)) }
+          assert_equal(false, poly_.prepared?)
+        end
+        
+        
+        def test_dup_is_not_prepared
+          poly_ = _square(@factory).prepare!
+          poly2_ = poly_.dup
+          assert_equal(false, poly2_.prepared?)
+          assert(poly2_.contains?(@factory.point(1, 1)))
+        end
+        
+        
+        def test_buffer_resolution
+          factory_ = ::RGeo::Geos.factory(:buffer_resolution => 2)
+          buffer_ = factory_.point(0, 0).buffer(1)
+          assert_equal(9, buffer_.exterior_ring.num_points)
+        end
+        
+        
+        def test_operations_in_threads
+          square_ = _square(@factory)
+          threads_ = (0...4).map do |i_|
+            ::Thread.new do
+              other_ = @factory.point(i_, i_).buffer(1)
+              (0...10).map do
+                [square_.union(other_), square_.intersection(other_),
+                  square_.difference(other_), square_.relate(other_, 'T********')]
+              end
+            end
+          end
+          threads_.each_with_index do |thread_, i_|
+            thread_.value.each do |results_|
+              assert(results_[0].contains?(@factory.point(0.1, 1.9)))
+              assert_equal(i_ < 3, results_[1].contains?(@factory.point(i_*0.5+0.5, i_*0.5+0.5)))
+              assert_equal(i_ > 0, results_[2].contains?(@factory.point(0.1, 0.1)))
+              assert_equal(i_ < 3, results_[3])
+            end
+          end
+        end
+        
+        
+        def test_geometries_across_factories
+          polys_ = (0...20).map{ |i_| _square(::RGeo::Geos.factory(:srid => i_)) }
+          ::GC.start
+          polys_.each_with_index do |poly_, i_|
+            assert_equal(i_, poly_.srid)
+            assert(poly_.contains?(@factory.point(1, 1)))
+            assert_equal('POLYGON ((0 0, 0 2, 2 2, 2 0, 0 0))', poly_.as_text.gsub(/\.0+\b/, ''))
+          end
+        end
+        
+        
+        def test_batch_predicate
+          square_ = _square(@factory)
+          points_ = [@factory.point(1, 1), @factory.point(3, 1), @factory.point(2, 1), @factory.point(0.5, 1.5)]
+          assert_equal([0, 3], square_.batch_predicate(:contains?, points_))
+          assert_equal([0, 2, 3], square_.batch_predicate(:intersects?, points_))
+          assert_equal([1], square_.batch_predicate(:disjoint?, points_))
+          assert_equal('1001', square_.batch_predicate(:contains?, points_, :bitmap).unpack('b4').first)
+          assert_equal([], square_.batch_predicate(:contains?, []))
+          assert_equal(false, square_.prepared?)
+          assert_raise(::ArgumentError){ square_.batch_predicate(:equals?, points_) }
+        end
+        
+        
+        def test_batch_distance
+          square_ = _square(@factory)
+          distances_ = square_.batch_distance([@factory.point(1, 1), @factory.point(5, 1), @factory.point(5, 6)])
+          assert_equal([0.0, 3.0, 5.0], distances_)
+        end
+        
+        
+        def test_simplify
+          line_ = @factory.line_string([@factory.point(0, 0), @factory.point(1, 0.1),
+            @factory.point(2, -0.1), @factory.point(3, 5), @factory.point(4, 0)])
+          assert_equal(4, line_.simplify(0.5).num_points)
+          assert_equal(5, line_.simplify(0.01).num_points)
+          assert_equal(4, line_.topology_preserving_simplify(0.5).num_points)
+          assert_equal(4326, line_.simplify(0.5).srid)
+        end
+        
+        
+        def test_grid_size
+          factory_ = ::RGeo::Geos.factory(:grid_size => 0.25)
+          assert_equal(0.25, factory_.grid_size)
+          assert_nil(@factory.grid_size)
+          point_ = factory_.point(1.3, -2.9)
+          assert_equal([1.25, -3.0], [point_.x, point_.y])
+          line_ = factory_.line_string_from_coordinates([0.1, 0.2, 0.9, 1.1])
+          assert_equal([0.0, 0.25, 1.0, 1.0], line_.flat_coordinates)
+          assert(factory_ != ::RGeo::Geos.factory)
+          assert(factory_.eql?(::RGeo::Geos.factory(:grid_size => 0.25)))
+        end
+        
+        
+        def test_grid_size_applies_to_parsing_and_casts
+          factory_ = ::RGeo::Geos.factory(:grid_size => 0.25, :wkt_parser => :geos, :wkb_parser => :geos)
+          point_ = factory_.parse_wkt('POINT(1.3 -2.9)')
+          assert_equal([1.25, -3.0], [point_.x, point_.y])
+          point_ = factory_.parse_wkb(@factory.point(1.3, -2.9).as_binary)
+          assert_equal([1.25, -3.0], [point_.x, point_.y])
+          line_ = @factory.line_string([@factory.point(0.1, 0.2), @factory.point(0.9, 1.1)])
+          assert_equal([0.0, 0.25, 1.0, 1.0], ::RGeo::Feature.cast(line_, factory_).flat_coordinates)
+          line2_ = ::RGeo::Feature.cast(line_, factory_, ::RGeo::Feature::Line)
+          assert_equal([0.0, 0.25, 1.0, 1.0], line2_.flat_coordinates)
+          poly_ = ::RGeo::Feature.cast(@factory.polygon(@factory.linear_ring([@factory.point(0.1, 0.1),
+            @factory.point(2.1, 0.1), @factory.point(2.1, 1.9)])), factory_)
+          assert_equal(::RGeo::Feature::Polygon, poly_.geometry_type)
+          assert_equal([0.0, 0.0, 2.0, 0.0, 2.0, 2.0, 0.0, 0.0], poly_.exterior_ring.flat_coordinates)
+        end
+        
+        
+        def test_marshal
+          line_ = @factory.line(@factory.point(1, 2), @factory.point(3, 4))
+          line2_ = ::Marshal.load(::Marshal.dump(line_))
+          assert_equal(::RGeo::Geos::LineImpl, line2_.class)
+          assert(line2_.eql?(line_))
+          assert_equal(4326, line2_.srid)
+          assert(::Marshal.load(::Marshal.dump(@factory.point(1, 2))).equal?(line2_.start_point.factory))
+          empty_ = ::Marshal.load(::Marshal.dump(@factory.collection([])))
+          assert(empty_.is_empty?)
+        end
+        
+        
+        def test_marshal_collection_keeps_classes
+          factory_ = ::RGeo::Geos.factory(:has_z_coordinate => true, :buffer_resolution => 3)
+          coll_ = factory_.collection([factory_.line(factory_.point(0, 0, 1), factory_.point(1, 1, 2)),
+            factory_.point(2, 3, 4), factory_.multi_point([factory_.point(5, 6, 7)])])
+          coll2_ = ::Marshal.load(::Marshal.dump(coll_))
+          assert_equal(factory_, coll2_.factory)
+          assert_equal(3, coll2_.factory.buffer_resolution)
+          assert_equal(::RGeo::Geos::LineImpl, coll2_.geometry_n(0).class)
+          assert_equal(2, coll2_.geometry_n(0).end_point.z)
+          assert_equal(::RGeo::Geos::MultiPointImpl, coll2_.geometry_n(2).class)
+          assert(coll2_.eql?(coll_))
+        end
+        
+        
+        def test_stats
+          assert_nil(@factory.stats)
+          factory_ = ::RGeo::Geos.factory(:collect_stats => true)
+          assert_equal(::RGeo::Geos.factory, factory_)
+          point1_ = factory_.point(1, 1)
+          point2_ = factory_.point(3, 1)
+          factory_.line(point1_, point2_)
+          point1_.union(point2_)
+          point1_.intersects?(::RGeo::Cartesian.simple_factory.point(1, 1))
+          stats_ = factory_.stats
+          assert_equal(1, stats_[:geos_calls])
+          assert(stats_[:geos_time] >= 0.0)
+          assert_equal(1, stats_[:conversions])
+          assert_equal(0, stats_[:clones])
+          assert_equal(5, stats_[:allocations])
+          assert_equal(0, stats_[:callbacks])
+          factory_.reset_stats
+          assert_equal(0, factory_.stats[:allocations])
+        end
+        
+        
+        def test_marshal_keeps_collect_stats
+          factory_ = ::RGeo::Geos.factory(:collect_stats => true)
+          point_ = ::Marshal.load(::Marshal.dump(factory_.point(1, 2)))
+          assert_not_nil(point_.factory.stats)
+        end
+        
+        
+        def test_native_generators_match_wkrep
+          wkt_opts_ = {:tag_format => :wkt12, :square_brackets => true}
+          wkb_opts_ = {:hex_format => true, :little_endian => true}
+          factory_ = ::RGeo::Geos.factory(:has_z_coordinate => true,
+            :wkt_generator => wkt_opts_, :wkb_generator => wkb_opts_)
+          poly_ = factory_.polygon(factory_.linear_ring([factory_.point(0, 0, 1),
+            factory_.point(0, 2.5, 2), factory_.point(2, 2, 3), factory_.point(0, 0, 1)]))
+          geom_ = factory_.collection([poly_, factory_.line(factory_.point(1, 2, 3), factory_.point(4, 5, 6)),
+            factory_.multi_point([factory_.point(-1, 1e-20, 0)]), factory_.line_string([])])
+          assert_equal(::RGeo::WKRep::WKTGenerator.new(wkt_opts_).generate(geom_), geom_.as_text)
+          assert_equal(::RGeo::WKRep::WKBGenerator.new(wkb_opts_).generate(geom_), geom_.as_binary)
+          assert_equal('0101000000000000000000f03f0000000000000040', factory_.point(1, 2, 3).as_binary)
+        end
+        
+        
+        def test_native_wkb_generator_matches_ewkb_and_wkb12
+          [[{:type_format => :ewkb, :emit_ewkb_srid => true, :hex_format => true}, :has_z_coordinate],
+            [{:type_format => :ewkb, :little_endian => true}, :has_m_coordinate],
+            [{:type_format => :wkb12, :hex_format => true}, :has_m_coordinate]].each do |wkb_opts_, coord_|
+            factory_ = ::RGeo::Geos.factory(:srid => 4326, coord_ => true,
+              :wkb_generator => wkb_opts_, :collect_stats => true)
+            geom_ = factory_.collection([factory_.line(factory_.point(1, 2, 3), factory_.point(4, 5, 6)),
+              factory_.multi_point([factory_.point(-1, 1e16, 0.5)])])
+            assert_equal(::RGeo::WKRep::WKBGenerator.new(wkb_opts_).generate(geom_), geom_.as_binary)
+            assert_equal(0, factory_.stats[:callbacks])
+          end
+        end
+        
+        
+        def test_bounding_box_uses_coordinate_bounds
+          factory_ = ::RGeo::Geos.factory(:has_z_coordinate => true)
+          line_ = factory_.line_string([factory_.point(1, 4, 2), factory_.point(3, -1, 5), factory_.point(2, 2, -1)])
+          assert_equal([1.0, 3.0, -1.0, 4.0, -1.0, 5.0], line_._coordinate_bounds)
+          assert_nil(factory_.line_string([])._coordinate_bounds)
+          bbox_ = ::RGeo::Cartesian::BoundingBox.new(factory_).add(line_)
+          assert_equal([1.0, 3.0, -1.0, 4.0, -1.0, 5.0],
+            [bbox_.min_x, bbox_.max_x, bbox_.min_y, bbox_.max_y, bbox_.min_z, bbox_.max_z])
+        end
+        
+        
+        def test_bounding_boxes_for_geometries
+          factory_ = ::RGeo::Geos.factory(:has_z_coordinate => true)
+          geoms_ = [factory_.point(1, 4, 2), factory_.line_string([]),
+            factory_.line_string([factory_.point(1, 4, 2), factory_.point(3, -1, 5)]),
+            ::RGeo::Cartesian.simple_factory.point(7, 8)]
+          bboxes_ = ::RGeo::Cartesian::BoundingBox.for_geometries(factory_, geoms_)
+          geoms_.each_with_index do |geom_, i_|
+            assert_equal(::RGeo::Cartesian::BoundingBox.new(factory_).add(geom_), bboxes_[i_])
+          end
+          assert_equal(true, bboxes_[1].empty?)
+          assert_equal([1.0, 3.0, -1.0, 4.0, 2.0, 5.0],
+            [bboxes_[2].min_x, bboxes_[2].max_x, bboxes_[2].min_y, bboxes_[2].max_y, bboxes_[2].min_z, bboxes_[2].max_z])
+        end
+        
+        
       end
       
     end
@@ -56,6 +56,77 @@ module RGeo
         include ::RGeo::Tests::Common::MultiPolygonTests
         
         
+        def _cell(x_, y_, size_)
+          @factory.polygon(@factory.linear_ring([@factory.point(x_, y_), @factory.point(x_+size_, y_),
+            @factory.point(x_+size_, y_+size_), @factory.point(x_, y_+size_)]))
+        end
+        
+        
+        def test_creation_many_elements
+          cells_ = []
+          10.times{ |i_| 10.times{ |j_| cells_ << _cell(i_*2, j_*2, 1) } }
+          assert_equal(100, @factory.multi_polygon(cells_).num_geometries)
+          checkers_ = []
+          10.times{ |i_| 10.times{ |j_| checkers_ << _cell(i_, j_, 1) if (i_ + j_) % 2 == 0 } }
+          assert_equal(50, @factory.multi_polygon(checkers_.reverse).num_geometries)
+          assert_nil(@factory.multi_polygon(cells_ + [_cell(18.5, 0.5, 1)]))
+          assert_nil(@factory.multi_polygon([_cell(0, 0, 1)] + cells_[1..-1] + [_cell(1, 0, 1)]))
+        end
+        
+        
+        def test_creation_adopting
+          cell1_ = _cell(0, 0, 1)
+          cell2_ = _cell(2, 0, 1)
+          geom_ = @factory.multi_polygon!([cell1_, cell2_])
+          assert_equal(2, geom_.num_geometries)
+          assert(geom_.geometry_n(1).contains?(@factory.point(2.5, 0.5)))
+          assert_equal(false, cell1_.initialized?)
+          assert_equal(false, cell2_.initialized?)
+          assert_nil(@factory.multi_polygon!([cell1_]))
+          other_ = ::RGeo::Geos.factory(:srid => 3857)
+          cell3_ = _cell(0, 0, 1)
+          geom2_ = other_.multi_polygon!([cell3_])
+          assert_equal(3857, geom2_.srid)
+          assert_equal(true, cell3_.initialized?)
+        end
+        
+        
+        def test_creation_adopting_conflict_keeps_elements
+          cell1_ = _cell(0, 0, 2)
+          cell2_ = _cell(1, 1, 2)
+          assert_nil(@factory.multi_polygon!([cell1_, cell2_]))
+          assert_equal(true, cell1_.initialized?)
+          assert_equal(true, cell2_.initialized?)
+          assert_equal(4.0, cell1_.area)
+        end
+        
+        
+        def test_adopted_element_raises
+          cell1_ = _cell(0, 0, 1)
+          cell2_ = _cell(2, 0, 1)
+          geom_ = @factory.multi_polygon!([cell1_, cell2_])
+          assert_equal(2, geom_.num_geometries)
+          assert_raise(::RGeo::Error::InvalidGeometry) do
+            cell1_.area
+          end
+          assert_raise(::RGeo::Error::InvalidGeometry) do
+            cell2_.area
+          end
+          assert_raise(::RGeo::Error::InvalidGeometry) do
+            geom_.geometry_n(0).equals?(cell1_)
+          end
+        end
+        
+        
+        def test_creation_adopting_duplicate_element
+          pt_ = @factory.point(1, 2)
+          geom_ = @factory.multi_point!([pt_, pt_])
+          assert_equal(2, geom_.num_geometries)
+          assert_equal(@factory.point(1, 2), geom_.geometry_n(1))
+          assert_equal(false, pt_.initialized?)
+        end
+        
+        
       end
       
     end
@@ -79,6 +79,15 @@ module RGeo
         end
         
         
+        def test_flat_coordinates_with_hole
+          factory_ = ::RGeo::Geos.factory(:has_z_coordinate => true)
+          poly_ = factory_.polygon_from_coordinates([0, 0, 1, 0, 4, 2, 4, 0, 3, 0, 0, 1],
+            [[1, 1, 0, 1, 2, 0, 2, 1, 0]])
+          assert_equal([0.0, 0.0, 1.0, 0.0, 4.0, 2.0, 4.0, 0.0, 3.0, 0.0, 0.0, 1.0,
+            1.0, 1.0, 0.0, 1.0, 2.0, 0.0, 2.0, 1.0, 0.0, 1.0, 1.0, 0.0], poly_.flat_coordinates)
+        end
+        
+        
       end
       
     end
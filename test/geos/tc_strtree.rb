@@ -0,0 +1,124 @@
+# -----------------------------------------------------------------------------
+# 
+# Tests for the GEOS STRtree
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+require 'test/unit'
+require 'rgeo'
+
+
+module RGeo
+  module Tests  # :nodoc:
+    module Geos  # :nodoc:
+      
+      class TestSTRtree < ::Test::Unit::TestCase  # :nodoc:
+        
+        
+        def setup
+          @factory = ::RGeo::Geos.factory
+          @tree = ::RGeo::Geos::STRtree.new(@factory)
+          10.times do |i_|
+            @tree.insert(@factory.point(i_, i_), i_)
+          end
+        end
+        
+        
+        def test_query_geometry
+          line_ = @factory.line(@factory.point(1.5, 1.5), @factory.point(4.5, 3.5))
+          assert_equal([2, 3], @tree.query(line_).sort)
+          assert_equal([], @tree.query(@factory.point(20, 20)))
+          assert(@tree.built?)
+        end
+        
+        
+        def test_query_bounding_box
+          bbox_ = ::RGeo::Cartesian::BoundingBox.new(@factory)
+          bbox_.add(@factory.point(-1, -1)).add(@factory.point(2, 8))
+          assert_equal([0, 1, 2], @tree.query(bbox_).sort)
+        end
+        
+        
+        def test_query_block
+          items_ = []
+          @tree.query(@factory.point(5, 5)){ |item_| items_ << item_ }
+          assert_equal([5], items_)
+        end
+        
+        
+        def test_default_item_is_geometry
+          tree_ = ::RGeo::Geos::STRtree.new(@factory)
+          point_ = @factory.point(1, 2)
+          tree_.insert(point_)
+          assert_equal([point_], tree_.query(point_))
+        end
+        
+        
+        def test_insert_after_query
+          @tree.query(@factory.point(0, 0))
+          assert_raise(::RGeo::Error::UnsupportedOperation) do
+            @tree.insert(@factory.point(0, 0))
+          end
+        end
+        
+        
+        def test_nearest
+          assert_equal(3, @tree.nearest(@factory.point(3.2, 2.9)))
+          assert_equal(9, @tree.nearest(@factory.point(100, 100)))
+          assert_equal(0, @tree.nearest(@factory.point(-5, -3)))
+          assert_equal(10, @tree.size)
+        end
+        
+        
+        def test_nearest_empty
+          tree_ = ::RGeo::Geos::STRtree.new(@factory)
+          assert_nil(tree_.nearest(@factory.point(0, 0)))
+        end
+        
+        
+        def test_adopted_geometry_stays_indexed
+          tree_ = ::RGeo::Geos::STRtree.new(@factory)
+          point1_ = @factory.point(1, 1)
+          point2_ = @factory.point(5, 5)
+          tree_.insert(point1_, 1)
+          tree_.insert(point2_, 2)
+          @factory.multi_point!([point1_, point2_])
+          assert_equal([1], tree_.query(@factory.point(1, 1)))
+          assert_equal(2, tree_.nearest(@factory.point(4, 4)))
+        end
+        
+        
+      end
+      
+    end
+  end
+end if ::RGeo::Geos.supported? && ::RGeo::Geos::STRtree.supported?
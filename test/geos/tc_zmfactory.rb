@@ -78,6 +78,60 @@ module RGeo
         end
         
         
+        def test_line_string_keeps_m_values
+          line_ = @factory.line_string([@factory.point(1, 2, 3, 4), @factory.point(5, 6, 7, 8)])
+          assert_equal([4.0, 8.0], line_.points.map{ |p_| p_.m })
+          assert_equal(8, line_.point_n(1).m)
+          assert_equal(7, line_.end_point.z)
+          assert_equal([4.0, 8.0], line_.m_geometry.points.map{ |p_| p_.m })
+          assert_equal('LINESTRING (1.0 2.0 3.0 4.0, 5.0 6.0 7.0 8.0)', line_.as_text)
+        end
+        
+        
+        def test_ring_closure_repeats_m
+          ring_ = @factory.linear_ring([@factory.point(0, 0, 0, 1), @factory.point(0, 1, 0, 2),
+            @factory.point(1, 0, 0, 3)])
+          assert_equal([1.0, 2.0, 3.0, 1.0], ring_.points.map{ |p_| p_.m })
+        end
+        
+        
+        def test_polygon_and_collection_m_values
+          outer_ = @factory.linear_ring([@factory.point(0, 0, 0, 1), @factory.point(0, 10, 0, 2),
+            @factory.point(10, 10, 0, 3), @factory.point(10, 0, 0, 4), @factory.point(0, 0, 0, 1)])
+          inner_ = @factory.linear_ring([@factory.point(1, 1, 0, 5), @factory.point(1, 2, 0, 6),
+            @factory.point(2, 2, 0, 7), @factory.point(1, 1, 0, 5)])
+          poly_ = @factory.polygon(outer_, [inner_])
+          assert_equal([1.0, 2.0, 3.0, 4.0, 1.0], poly_.exterior_ring.points.map{ |p_| p_.m })
+          assert_equal([5.0, 6.0, 7.0, 5.0], poly_.interior_ring_n(0).points.map{ |p_| p_.m })
+          coll_ = @factory.collection([@factory.point(5, 5, 5, 9), poly_])
+          assert_equal(9, coll_.geometry_n(0).m)
+          assert_equal([5.0, 6.0, 7.0, 5.0], coll_.geometry_n(1).interior_rings[0].points.map{ |p_| p_.m })
+          assert_equal([9.0, 1.0], coll_.map{ |g_| g_.geometry_type == Feature::Point ? g_.m : g_.exterior_ring.start_point.m })
+          assert(coll_.eql?(@factory.collection([@factory.point(5, 5, 5, 9), poly_])))
+          assert(!coll_.eql?(@factory.collection([@factory.point(5, 5, 5, 8), poly_])))
+        end
+        
+        
+        def test_m_geometry_built_on_demand
+          line_ = @factory.line_string([@factory.point(0, 0, 1, 2), @factory.point(10, 0, 3, 4)])
+          assert(!line_.instance_variable_defined?(:@mgeometry))
+          mline_ = line_.m_geometry
+          assert_equal(@factory.m_factory, mline_.factory)
+          assert_equal([2.0, 4.0], mline_.points.map{ |p_| p_.m })
+          assert(mline_.equal?(line_.m_geometry))
+        end
+        
+        
+        def test_marshal
+          line_ = @factory.line_string([@factory.point(1, 2, 3, 4), @factory.point(5, 6, 7, 8)])
+          line2_ = ::Marshal.load(::Marshal.dump(line_))
+          assert(line2_.eql?(line_))
+          assert_equal(@factory, line2_.factory)
+          assert_equal([4.0, 8.0], line2_.points.map{ |p_| p_.m })
+          assert_equal(7, line2_.end_point.z)
+        end
+        
+        
       end
       
     end
@@ -138,6 +138,14 @@ module RGeo
         end
         
         
+        def test_each_overlapping_pair
+          segs_ = [@short_rising_seg, @long_rising_seg, @parallel_rising_seg, @degenerate_seg]
+          pairs_ = []
+          ::RGeo::Cartesian::Segment.each_overlapping_pair(segs_){ |i_, j_| pairs_ << [i_, j_] }
+          assert_equal([[0, 1], [0, 2], [1, 2], [1, 3], [2, 3]], pairs_.sort)
+        end
+        
+        
       end
       
     end
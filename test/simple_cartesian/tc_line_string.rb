@@ -63,6 +63,33 @@ module RGeo
         undef_method :test_not_equal
         
         
+        def test_length
+          line_ = @factory.line_string([@factory.point(0, 0), @factory.point(3, 4), @factory.point(3, 5)])
+          assert_equal(6.0, line_.length)
+          assert_equal(6.0, line_.length)
+        end
+        
+        
+        def test_simplicity_is_cached
+          line_ = @factory.line_string([@factory.point(0, 0), @factory.point(2, 2), @factory.point(2, 0), @factory.point(0, 2)])
+          assert_equal(false, line_.is_simple?)
+          assert_equal(false, line_.is_simple?)
+          assert_equal(line_.envelope.object_id, line_.envelope.object_id)
+        end
+        
+        
+        def test_large_ring_simplicity
+          points_ = (0...2000).map do |i_|
+            angle_ = ::Math::PI * i_ / 1000
+            @factory.point(::Math.cos(angle_) * 10, ::Math.sin(angle_) * 10)
+          end
+          assert(@factory.linear_ring(points_))
+          points_[1000], points_[1001] = points_[1001], points_[1000]
+          assert_nil(@factory.linear_ring(points_))
+          assert_equal(false, @factory.line_string(points_).is_simple?)
+        end
+        
+        
       end
       
     end
@@ -71,6 +71,30 @@ module RGeo
         end
         
         
+        def test_factory_is_shared
+          assert(@factory.equal?(::RGeo::Cartesian.simple_factory('srid' => 1)))
+          assert(!@factory.equal?(@zfactory))
+          config_ = {:srid => 1, :wkt_generator => {:convert_case => :lower}}
+          factory_ = ::RGeo::Cartesian.simple_factory(config_)
+          config_[:wkt_generator][:convert_case] = :upper
+          assert(factory_.equal?(::RGeo::Cartesian.simple_factory(:srid => 1, :wkt_generator => {:convert_case => :lower})))
+          db_ = ::Object.new
+          assert(!::RGeo::Cartesian.simple_factory(:srs_database => db_).equal?(::RGeo::Cartesian.simple_factory(:srs_database => db_)))
+        end
+        
+        
+        def test_factory_registry_is_bounded
+          limit_ = ::RGeo::Feature::FactoryGenerator::REGISTRY_LIMIT
+          factory_ = ::RGeo::Cartesian.simple_factory(:srid => 100000)
+          limit_.times{ |i_| ::RGeo::Cartesian.simple_factory(:srid => 100001 + i_) }
+          registry_ = ::RGeo::Feature::FactoryGenerator.instance_variable_get(:@registry)
+          assert_equal(limit_, registry_.size)
+          factory2_ = ::RGeo::Cartesian.simple_factory(:srid => 100000)
+          assert(!factory_.equal?(factory2_))
+          assert_equal(factory_, factory2_)
+        end
+        
+        
         undef_method :test_disjoint
         undef_method :test_intersects
         undef_method :test_touches
@@ -55,6 +55,58 @@ module RGeo
         include ::RGeo::Tests::Common::LineStringTests
         
         
+        def test_projection_round_trip
+          line_ = @factory.line_string([@factory.point(-170, 10), @factory.point(20, -45), @factory.point(150, 80)])
+          projection_ = line_.projection
+          assert_equal(3, projection_.num_points)
+          assert_in_delta(-170.0 / 180 * 20037508.342789, projection_.point_n(0).x, 0.001)
+          unprojected_ = @factory.unproject(projection_)
+          line_.points.zip(unprojected_.points) do |p1_, p2_|
+            assert_in_delta(p1_.x, p2_.x, 0.000001)
+            assert_in_delta(p1_.y, p2_.y, 0.000001)
+          end
+        end
+        
+        
+        def test_native_projection_matches_ruby
+          projector_ = ::RGeo::Geographic::SimpleMercatorProjector
+          radius_ = projector_::EQUATORIAL_RADIUS
+          points_ = [@factory.point(-170, 10), @factory.point(20, -45), @factory.point(150, 80)]
+          coords_ = points_.map{ |p_| [p_.x, p_.y] }.flatten
+          expected_ = points_.map{ |p_| proj_ = @factory.project(p_); [proj_.x, proj_.y] }.flatten
+          assert_equal(expected_, projector_._native_project(coords_, 2, radius_).unpack('d*'))
+          unprojected_ = projector_._native_unproject(expected_.pack('d*'), 2, radius_)
+          coords_.zip(unprojected_){ |a_, b_| assert_in_delta(a_, b_, 0.000001) }
+          assert_equal([0.0, 0.0, 5.0], projector_._native_unproject([0, 0, 5], 3, 1))
+        end if ::RGeo::Geographic::SimpleMercatorProjector.respond_to?(:_native_project)
+        
+        
+        def test_projection_keeps_z_in_native_and_ruby_paths
+          factory_ = ::RGeo::Geographic.simple_mercator_factory(:has_z_coordinate => true)
+          line_ = factory_.line_string([factory_.point(-170, 10, 3), factory_.point(20, -45, -4)])
+          native_ = ::RGeo::Geographic::SimpleMercatorProjector.new(factory_, :has_z_coordinate => true)
+          ruby_ = ::RGeo::Geographic::SimpleMercatorProjector.new(factory_, :has_z_coordinate => true)
+          ruby_.instance_variable_set(:@native_dims, nil)
+          [native_, ruby_].each do |projector_|
+            projected_ = projector_.project(line_)
+            assert_equal([3.0, -4.0], projected_.points.map{ |p_| p_.z })
+            assert_equal(-4.0, projector_.project(line_.point_n(1)).z)
+            unprojected_ = projector_.unproject(projected_)
+            line_.points.zip(unprojected_.points) do |p1_, p2_|
+              assert_in_delta(p1_.x, p2_.x, 0.000001)
+              assert_in_delta(p1_.y, p2_.y, 0.000001)
+              assert_equal(p1_.z, p2_.z)
+            end
+            assert_equal(3.0, projector_.unproject(projected_.point_n(0)).z)
+          end
+          native_.project(line_).points.zip(ruby_.project(line_).points) do |p1_, p2_|
+            assert_in_delta(p1_.x, p2_.x, 0.000001)
+            assert_in_delta(p1_.y, p2_.y, 0.000001)
+            assert_equal(p1_.z, p2_.z)
+          end
+        end
+        
+        
       end
       
     end
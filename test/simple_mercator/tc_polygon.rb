@@ -55,6 +55,32 @@ module RGeo
         include ::RGeo::Tests::Common::PolygonTests
         
         
+        def _triangle(factory_)
+          factory_.polygon(factory_.linear_ring([factory_.point(0, 0),
+            factory_.point(0, 10), factory_.point(10, 0), factory_.point(0, 0)]))
+        end
+        
+        
+        def test_eager_projection
+          poly_ = _triangle(@factory)
+          assert(poly_.instance_variable_defined?(:@projection))
+        end
+        
+        
+        def test_lazy_projection
+          factory_ = ::RGeo::Geographic.simple_mercator_factory(:lazy_projection => true)
+          assert_equal(true, factory_.property(:lazy_projection))
+          poly_ = _triangle(factory_)
+          assert(!poly_.instance_variable_defined?(:@projection))
+          assert_equal('POLYGON ((0.0 0.0, 0.0 10.0, 10.0 0.0, 0.0 0.0))', poly_.as_text)
+          assert(!poly_.instance_variable_defined?(:@projection))
+          projection_ = poly_.projection
+          assert_not_nil(projection_)
+          assert(projection_.equal?(poly_.projection))
+          assert_equal(_triangle(@factory).envelope.as_text, poly_.envelope.as_text)
+        end
+        
+        
       end
       
     end
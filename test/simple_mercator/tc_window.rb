@@ -212,6 +212,58 @@ module RGeo
         end
         
         
+        def test_contained_point_indexes
+          window1_ = Geographic::ProjectedWindow.for_corners(@factory.point(-170, 30), @factory.point(-160, 40))
+          window2_ = Geographic::ProjectedWindow.for_corners(@factory.point(170, 30), @factory.point(-170, 40))
+          points_ = [@factory.point(-169, 32), @factory.point(-171, 32), @factory.point(-169, 29),
+            @factory.point(171, 32), @factory.point(169, 32), @factory.point(185, 32)]
+          [window1_, window2_].each do |window_|
+            expected_ = (0...points_.size).select{ |i_| window_.contains_point?(points_[i_]) }
+            assert_equal(expected_, window_.contained_point_indexes(points_))
+          end
+          assert_equal([0], window1_.contained_point_indexes(points_))
+          assert_equal([1, 3, 5], window2_.contained_point_indexes(points_))
+          assert_equal([], window1_.contained_point_indexes([]))
+        end
+        
+        
+        def test_contained_points_from_geometries
+          window1_ = Geographic::ProjectedWindow.for_corners(@factory.point(170, 30), @factory.point(-170, 40))
+          p1_ = @factory.point(-171, 32)
+          p2_ = @factory.point(-160, 32)
+          p3_ = @factory.point(-175, 35)
+          assert_equal([p1_, p3_], window1_.contained_points(@factory.line_string([p1_, p2_, p3_])))
+          assert_equal([p1_, p3_], window1_.contained_points(@factory.multi_point([p1_, p2_, p3_])))
+          line_ = @factory.line_string([p1_, @factory.point(160, 32), @factory.point(175, 35)])
+          assert_equal([0, 2], window1_.contained_point_indexes(line_))
+        end
+        
+        
+        def test_projected_rectangles_across_seam
+          window1_ = Geographic::ProjectedWindow.for_corners(@factory.point(170, 30), @factory.point(-170, 40))
+          rects_ = window1_._projected_rectangles
+          assert_equal(2, rects_.size)
+          limits_ = @factory.projection_limits_window
+          bbox1_ = ::RGeo::Cartesian::BoundingBox.new(rects_[0].factory).add(rects_[0])
+          bbox2_ = ::RGeo::Cartesian::BoundingBox.new(rects_[1].factory).add(rects_[1])
+          assert_in_delta(window1_.x_min, bbox1_.min_x, 0.001)
+          assert_in_delta(limits_.x_max, bbox1_.max_x, 0.001)
+          assert_in_delta(limits_.x_min, bbox2_.min_x, 0.001)
+          assert_in_delta(window1_.x_max, bbox2_.max_x, 0.001)
+        end
+        
+        
+        def test_clip_across_seam
+          window1_ = Geographic::ProjectedWindow.for_corners(@factory.point(170, 30), @factory.point(-170, 40))
+          line_ = @factory.line_string([@factory.point(160, 35), @factory.point(180, 35)])
+          clipped_ = window1_.clip(line_)
+          assert(clipped_.is_a?(::RGeo::Feature::LineString))
+          assert_close_enough(@factory.point(170, 35), clipped_.start_point)
+          assert_close_enough(@factory.point(180, 35), clipped_.end_point)
+          assert(window1_.clip(@factory.point(0, 35)).is_empty?)
+        end if ::RGeo::Geos.supported?
+        
+        
       end
       
     end
@@ -80,6 +80,17 @@ module RGeo
         end
         
         
+        def test_distances_to
+          point1_ = @factory.point(0, 10)
+          points_ = [@factory.point(0, 10), @factory.point(0, 40), @factory.point(30, 10)]
+          distances_ = point1_.distances_to(points_)
+          assert_equal(3, distances_.size)
+          points_.each_with_index do |p_, i_|
+            assert_in_delta(point1_.distance(p_), distances_[i_], 0.0001)
+          end
+        end
+        
+        
         undef_method :test_disjoint
         undef_method :test_intersects
         undef_method :test_touches
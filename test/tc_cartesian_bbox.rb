@@ -0,0 +1,106 @@
+# -----------------------------------------------------------------------------
+# 
+# Tests for Cartesian bounding boxes
+# 
+# -----------------------------------------------------------------------------
+# Copyright 2010 Daniel Azuma
+# 
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 
+# * Redistributions of source code must retain the above copyright notice,
+#   this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+#   this list of conditions and the following disclaimer in the documentation
+#   and/or other materials provided with the distribution.
+# * Neither the name of the copyright holder, nor the names of any other
+#   contributors to this software, may be used to endorse or promote products
+#   derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+# -----------------------------------------------------------------------------
+;
+
+
+require 'test/unit'
+require 'rgeo'
+
+
+module RGeo
+  module Tests  # :nodoc:
+    
+    class TestCartesianBBox < ::Test::Unit::TestCase  # :nodoc:
+      
+      
+      def setup
+        @factory = ::RGeo::Cartesian.preferred_factory
+      end
+      
+      
+      def test_empty_bbox
+        bbox_ = ::RGeo::Cartesian::BoundingBox.new(@factory)
+        assert_equal(true, bbox_.empty?)
+        assert_nil(bbox_.min_x)
+        assert(bbox_.to_geometry.is_empty?)
+      end
+      
+      
+      def test_add_geometries
+        bbox_ = ::RGeo::Cartesian::BoundingBox.new(@factory)
+        bbox_.add(@factory.point(1, 4))
+        bbox_.add(@factory.line(@factory.point(3, -1), @factory.point(2, 2)))
+        assert_equal([1.0, 3.0, -1.0, 4.0], [bbox_.min_x, bbox_.max_x, bbox_.min_y, bbox_.max_y])
+        assert(bbox_.contains?(@factory.point(2, 0)))
+        assert(!bbox_.contains?(@factory.point(4, 0)))
+      end
+      
+      
+      def test_add_coordinates
+        bbox1_ = ::RGeo::Cartesian::BoundingBox.new(@factory)
+        bbox1_.add_coordinates([1, 4, 3, -1, 2, 2])
+        bbox2_ = ::RGeo::Cartesian::BoundingBox.new(@factory)
+        bbox2_.add_coordinates([1, 4, 3, -1, 2, 2].pack('d*'))
+        bbox2_.add_coordinates([])
+        assert_equal([1, 3, -1, 4], [bbox1_.min_x, bbox1_.max_x, bbox1_.min_y, bbox1_.max_y])
+        assert_equal(bbox1_, bbox2_)
+      end
+      
+      
+      def test_add_coordinates_with_z_and_m
+        factory_ = ::RGeo::Cartesian.simple_factory(:has_z_coordinate => true, :has_m_coordinate => true)
+        bbox_ = ::RGeo::Cartesian::BoundingBox.new(factory_, :ignore_m => true)
+        bbox_.add_coordinates([1, 2, 3, 4, 0, 5, -3, 8])
+        assert_equal([0, 1, 2, 5], [bbox_.min_x, bbox_.max_x, bbox_.min_y, bbox_.max_y])
+        assert_equal([-3, 3], [bbox_.min_z, bbox_.max_z])
+        assert_nil(bbox_.min_m)
+      end
+      
+      
+      def test_for_geometries
+        geoms_ = [@factory.point(1, 2), @factory.line_string([]),
+          @factory.polygon(@factory.linear_ring([@factory.point(0, 0),
+            @factory.point(0, 3), @factory.point(5, 1), @factory.point(0, 0)]))]
+        bboxes_ = ::RGeo::Cartesian::BoundingBox.for_geometries(@factory, geoms_)
+        assert_equal(3, bboxes_.size)
+        assert_equal([1, 1, 2, 2], [bboxes_[0].min_x, bboxes_[0].max_x, bboxes_[0].min_y, bboxes_[0].max_y])
+        assert_equal(true, bboxes_[1].empty?)
+        assert_equal([0, 5, 0, 3], [bboxes_[2].min_x, bboxes_[2].max_x, bboxes_[2].min_y, bboxes_[2].max_y])
+      end
+      
+      
+    end
+    
+  end
+end
@@ -45,6 +45,38 @@ module RGeo
       class TestWKBParser < ::Test::Unit::TestCase  # :nodoc:
         
         
+        class PackedCoordsFactory < ::RGeo::Cartesian::Factory  # :nodoc:
+          
+          def initialize(opts_={})
+            super
+            @bulk_calls = 0
+          end
+          
+          attr_reader :bulk_calls
+          
+          def line_string_from_coordinates(coords_)
+            @bulk_calls += 1
+            line_string(_points(coords_))
+          end
+          
+          def polygon_from_coordinates(outer_coords_, inner_coords_)
+            @bulk_calls += 1
+            polygon(linear_ring(_points(outer_coords_)), inner_coords_.map{ |c_| linear_ring(_points(c_)) })
+          end
+          
+          def multi_point_from_coordinates(coords_)
+            @bulk_calls += 1
+            multi_point(_points(coords_))
+          end
+          
+          def _points(coords_)
+            dims_ = property(:has_z_coordinate) ? 3 : 2
+            coords_.unpack('d*').each_slice(dims_).map{ |c_| point(*c_) }
+          end
+          
+        end
+        
+        
         def test_point_2d_xdr_hex
           parser_ = ::RGeo::WKRep::WKBParser.new
           obj_ = parser_.parse('00000000013ff00000000000004000000000000000')
@@ -353,6 +385,66 @@ module RGeo
         end
         
         
+        def test_linestring_truncated_count
+          parser_ = ::RGeo::WKRep::WKBParser.new
+          assert_raise(::RGeo::Error::ParseError) do
+            obj_ = parser_.parse('0000000002ffffffff3ff00000000000004000000000000000')
+          end
+        end
+        
+        
+        def test_default_generator_reuses_factories
+          parser_ = ::RGeo::WKRep::WKBParser.new(nil, :support_ewkb => true)
+          obj1_ = parser_.parse('0020000001000003e83ff00000000000004000000000000000')
+          obj2_ = ::RGeo::WKRep::WKBParser.new(nil, :support_ewkb => true).parse('0020000001000003e840080000000000004010000000000000')
+          obj3_ = parser_.parse('0020000001000003e93ff00000000000004000000000000000')
+          assert_equal(1000, obj1_.srid)
+          assert(obj1_.factory.equal?(obj2_.factory))
+          assert(!obj1_.factory.equal?(obj3_.factory))
+        end
+        
+        
+        def test_memoized_generator
+          calls_ = 0
+          generator_ = ::RGeo::Feature::FactoryGenerator.memoize(::Proc.new{ |c_| calls_ += 1; ::RGeo::Cartesian.simple_factory(c_) })
+          factory1_ = generator_.call(:srid => 4326, :has_z_coordinate => true)
+          factory2_ = generator_.call(:has_z_coordinate => true, :srid => 4326)
+          factory3_ = generator_.call(:srid => 4326)
+          assert(factory1_.equal?(factory2_))
+          assert(!factory1_.equal?(factory3_))
+          assert_equal(2, calls_)
+        end
+        
+        
+        def test_bulk_constructors
+          factory_ = PackedCoordsFactory.new
+          parser_ = ::RGeo::WKRep::WKBParser.new(factory_)
+          obj_ = parser_.parse('000000000200000002' + '3ff0000000000000400000000000000040080000000000004010000000000000')
+          assert_equal(::RGeo::Feature::LineString, obj_.geometry_type)
+          assert_equal(factory_.point(3, 4), obj_.point_n(1))
+          zero_ = '0000000000000000'
+          one_ = '3ff0000000000000'
+          obj_ = parser_.parse('00000000030000000100000004' + zero_ + zero_ + one_ + zero_ + one_ + one_ + zero_ + zero_)
+          assert_equal(::RGeo::Feature::Polygon, obj_.geometry_type)
+          assert_equal(4, obj_.exterior_ring.num_points)
+          assert_equal(factory_.point(1, 1), obj_.exterior_ring.point_n(2))
+          obj_ = parser_.parse('000000000400000002' + '00000000013ff00000000000004000000000000000' +
+            '000000000140080000000000004010000000000000')
+          assert_equal(::RGeo::Feature::MultiPoint, obj_.geometry_type)
+          assert_equal(factory_.point(3, 4), obj_.geometry_n(1))
+          assert_equal(3, factory_.bulk_calls) if parser_.respond_to?(:_parse_native)
+        end
+        
+        
+        def test_bulk_constructors_pad_z
+          factory_ = PackedCoordsFactory.new(:has_z_coordinate => true)
+          parser_ = ::RGeo::WKRep::WKBParser.new(factory_)
+          obj_ = parser_.parse('000000000200000002' + '3ff0000000000000400000000000000040080000000000004010000000000000')
+          assert_equal(3, obj_.point_n(1).x)
+          assert_equal(0, obj_.point_n(1).z)
+        end
+        
+        
       end
       
     end
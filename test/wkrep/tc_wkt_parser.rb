@@ -35,6 +35,7 @@
 
 
 require 'test/unit'
+require 'stringio'
 require 'rgeo'
 
 
@@ -283,6 +284,15 @@ module RGeo
         end
         
         
+        def test_linestring_with_extra_coords_after_first
+          factory_ = ::RGeo::Cartesian.preferred_factory(:has_z_coordinate => true)
+          parser_ = ::RGeo::WKRep::WKTParser.new(factory_)
+          assert_raise(::RGeo::Error::ParseError) do
+            obj_ = parser_.parse('LINESTRING(1 2 3, 4 5 6 7)')
+          end
+        end
+        
+        
         def test_linestring_wkt12_m
           factory_ = ::RGeo::Cartesian.preferred_factory(:has_z_coordinate => true, :has_m_coordinate => true)
           parser_ = ::RGeo::WKRep::WKTParser.new(factory_, :support_wkt12 => true)
@@ -471,6 +481,51 @@ module RGeo
         end
         
         
+        def test_each_geometry
+          factory_ = ::RGeo::Cartesian.preferred_factory
+          parser_ = ::RGeo::WKRep::WKTParser.new(factory_)
+          io_ = ::StringIO.new("POINT(1 2)\nLINESTRING(1 2, 3 4);\n\n POINT EMPTY ;POINT(5 6)")
+          objs_ = parser_.each_geometry(io_).to_a
+          assert_equal(4, objs_.size)
+          assert_equal(::RGeo::Feature::Point, objs_[0].geometry_type)
+          assert_equal(::RGeo::Feature::LineString, objs_[1].geometry_type)
+          assert_equal(3, objs_[1].point_n(1).x)
+          assert_equal(true, objs_[2].is_empty?)
+          assert_equal(6, objs_[3].y)
+        end
+        
+        
+        def test_each_geometry_ewkt_srid
+          parser_ = ::RGeo::WKRep::WKTParser.new(nil, :support_ewkt => true)
+          io_ = ::StringIO.new("SRID=1000;POINT(1 2)\nPOINT(3 4);SRID=1001;POINT(5 6)\n")
+          objs_ = []
+          parser_.each_geometry(io_){ |obj_| objs_ << obj_ }
+          assert_equal([1000, 0, 1001], objs_.map{ |obj_| obj_.srid })
+          assert_equal(5, objs_[2].x)
+        end
+        
+        
+        def test_each_geometry_across_chunks
+          parser_ = ::RGeo::WKRep::WKTParser.new
+          coords_ = (0...20000).map{ |i_| "#{i_} #{i_}" }.join(', ')
+          io_ = ::StringIO.new("POINT(1 2);LINESTRING(#{coords_})\nPOINT(3 4)")
+          objs_ = parser_.each_geometry(io_).to_a
+          assert_equal(3, objs_.size)
+          assert_equal(20000, objs_[1].num_points)
+          assert_equal(19999, objs_[1].point_n(19999).x)
+          assert_equal(3, objs_[2].x)
+        end
+        
+        
+        def test_each_geometry_error
+          parser_ = ::RGeo::WKRep::WKTParser.new
+          io_ = ::StringIO.new("POINT(1 2)\nPOINT(1 2 x)\n")
+          assert_raise(::RGeo::Error::ParseError) do
+            parser_.each_geometry(io_){ }
+          end
+        end
+        
+        
       end
       
     end